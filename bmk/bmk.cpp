@@ -5,15 +5,20 @@
 /// First, some randomly generated int/double numbers have been created and inserted into those three containers, thus increasing linearly nodes' number -in 50 increments- from 50 to 20000. 
 /// Secondly, the average time of retreiving different and growing buckets of elements (numbers) from each container has been measured and finally plotted.
 /// Expectations were to find a better performance for std::unordered_map (as based on hash table) while the other two (std::map and our RBTree) are based on red-black tree implementations, possibly slower. 
+/// Run with --perf to also read hardware counters around each search (see: bmk_perf.hpp): cycles, instructions,
+/// L1d/LLC/dTLB misses and branch misses per lookup are appended to each line, NaN where unavailable.
 
 #include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map> 
 #include <random>
+#include <sstream>
 #include <unordered_map>
 #include <vector>
 #include "../include/RBT.hpp"
+#include "bmk_perf.hpp"
 
 ///\brief function to generate random numbers (overloaded).
 ///\param numbers number of random numbers to be generated.
@@ -46,24 +51,41 @@ std::vector<double> generate_random(const int& numbers, const bool& is_double) {
 ///\param container container to be searched.
 ///\param numbers vector of random numbers to be searched.
 ///\param search_size initial number of elements to be found in the container.
+///\param counters hardware counters, read around the searches.
 ///\return average time in milliseconds.
 template <typename T>
-double measure_time(T& container, const std::vector<double>& numbers, const int& search_size) {
+double measure_time(T& container, const std::vector<double>& numbers, const int& search_size, PerfCounters& counters) {
+  counters.start(); // outside the timed window: the ioctls are not charged to the lookups
   auto start = std::chrono::high_resolution_clock::now();
-  start = std::chrono::system_clock::now();
   for (int i=0; i<search_size; ++i) {
     container.find(numbers[i]);
   }
   auto end = std::chrono::high_resolution_clock::now();
+  counters.stop();
   auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end-start);
   return elapsed.count()/double(search_size);
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+  // hardware counters, on request only
+  bool perf{argc>1 and std::strcmp(argv[1], "--perf")==0};
+  PerfCounters counters{perf};
+  if (perf and !counters.available()) {
+    std::cerr << "hardware counters unavailable (see perf_event_paranoid), timing only" << std::endl;
+    perf = false;
+  }
+
   // output stream and output file
   std::ofstream out;
   out.open("../bmk/bmk_measures_double.txt");
+  out << "elements\tstd::map\tstd::unordered_map\tRBTree";
+  if (perf) {
+    PerfCounters::write_header(out, "std::map");
+    PerfCounters::write_header(out, "std::unordered_map");
+    PerfCounters::write_header(out, "RBTree");
+  }
+  out << std::endl;
 
   // define our experimental subjects (containers)
   std::map<double, double> m;
@@ -90,8 +112,18 @@ int main() {
       um.insert({numbers[j],numbers[j]});
       rbt.insert({numbers[j]});
     }
-    // print the output times
-    out << i << "\t" << measure_time(m, numbers, i) << "\t" << measure_time(um, numbers, i) << "\t" << measure_time(rbt, numbers, i) << std::endl;
+    // print the output times, then the counters per lookup
+    std::ostringstream per_lookup;
+    out << i << "\t" << measure_time(m, numbers, i, counters);
+    counters.write_per_operation(per_lookup, i);
+    out << "\t" << measure_time(um, numbers, i, counters);
+    counters.write_per_operation(per_lookup, i);
+    out << "\t" << measure_time(rbt, numbers, i, counters);
+    counters.write_per_operation(per_lookup, i);
+    if (perf) {
+      out << per_lookup.str();
+    }
+    out << std::endl;
   }
 
   // close output file
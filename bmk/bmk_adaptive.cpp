@@ -0,0 +1,106 @@
+///\file bmk_adaptive.cpp
+///\author mpv
+///\brief Bmk adaptive driver
+/// Small benchmarking experiment on skewed lookups: contains() on 2^20 keys drawn from Zipfian traces of growing
+/// exponent s (0 is uniform), RBTree versus an AdaptiveTree rebuilt from the frequencies of a first trace.
+/// Average depths of the looked up keys, average lookup times in nanoseconds (on a second trace of the same
+/// distribution) and the rebuild time in milliseconds are written to a .txt file.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/Adaptive_tree.hpp"
+
+///\brief function to measure the average time in nanoseconds of an operation repeated count times.
+template <typename Operation>
+double measure(const std::size_t count, Operation operation) {
+  auto start = std::chrono::high_resolution_clock::now();
+  operation();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(count);
+}
+
+
+///\brief function to draw a trace of lookups: key of rank r (in a random order of the keys) with probability ~ 1/(r+1)^s.
+std::vector<int> zipf_trace(const std::vector<int>& ranked, const double s, const std::size_t length, std::mt19937& gen) {
+  std::vector<double> cumulative(ranked.size());
+  double total{0};
+  for (std::size_t rank=0; rank<ranked.size(); ++rank) {
+    total += 1/std::pow(double(rank+1), s);
+    cumulative[rank] = total;
+  }
+  std::uniform_real_distribution<> dis(0, total);
+  std::vector<int> trace(length);
+  for (int& key : trace) {
+    key = ranked[std::min<std::size_t>(std::lower_bound(cumulative.begin(), cumulative.end(), dis(gen))-cumulative.begin(), ranked.size()-1)];
+  }
+  return trace;
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_adaptive.txt");
+  out << "zipf_s\tkeys\tRBTree_avg_depth\tAdaptiveTree_avg_depth\tRBTree_ns\tAdaptiveTree_ns\trebuild_ms" << std::endl;
+
+  const std::size_t keys{1<<20}, length{1<<22};
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(0, 1<<30);
+  RBTree<int> tree;
+  std::vector<int> ranked;
+  while (ranked.size()<keys) {
+    const int key{dis(gen)};
+    if (!tree.contains(key)) {
+      tree.insert(key);
+      ranked.push_back(key);
+    }
+  }
+  std::shuffle(ranked.begin(), ranked.end(), gen); // popular keys are neither the first inserted nor neighbours
+  for (const double& s : {0.0, 0.8, 1.0, 1.2}) {
+    const std::vector<int> training{zipf_trace(ranked, s, length, gen)}, trace{zipf_trace(ranked, s, length, gen)};
+    AdaptiveTree<int> adaptive{std::size_t(1)<<62}; // rebuilt on demand only
+    for (const int& key : ranked) {
+      adaptive.insert(key);
+    }
+    double tree_depth{0};
+    for (std::size_t i=0; i<trace.size(); i+=16) {
+      for (auto node = tree.get_root(); node->data!=trace[i]; tree_depth += 1) {
+        node = trace[i]<node->data ? node->left : node->right;
+      }
+    }
+    adaptive.rebuild(); // balanced layout, from now on the hits are counted
+    for (const int& key : training) {
+      adaptive.contains(key);
+    }
+    double rebuild{measure(1, [&]() { adaptive.rebuild(); })};
+    double adaptive_depth{0};
+    for (std::size_t i=0; i<trace.size(); i+=16) {
+      adaptive_depth += adaptive.depth(trace[i]);
+    }
+    volatile std::size_t sink{0};
+    double tree_time{measure(trace.size(), [&]() {
+      for (const int& key : trace) {
+        sink = sink+tree.contains(key);
+      }
+    })};
+    double adaptive_time{measure(trace.size(), [&]() {
+      for (const int& key : trace) {
+        sink = sink+adaptive.contains(key);
+      }
+    })};
+    const double sampled(trace.size()/16);
+    out << s << "\t" << keys << "\t" << tree_depth/sampled << "\t" << adaptive_depth/sampled << "\t"
+        << tree_time << "\t" << adaptive_time << "\t" << rebuild/1e6 << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
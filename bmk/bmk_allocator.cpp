@@ -0,0 +1,73 @@
+///\file bmk_allocator.cpp
+///\author mpv
+///\brief Bmk allocator driver
+/// Small benchmarking experiment to measure the cost of short-lived "scratch" trees (e.g. one per request):
+/// a tree is filled with random keys, searched and destroyed, many times over. A RBTree using the global
+/// heap (std::allocator) is compared with a pmr::RBTree on a std::pmr::monotonic_buffer_resource whose
+/// buffer is reused by every round. Build and teardown times are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <vector>
+#include "../include/RBT.hpp"
+
+///\brief function to fill, probe and destroy a tree, timing the fill and the teardown separately.
+///\param make callable returning an empty tree.
+///\param keys keys to be inserted (and looked up).
+///\param build accumulated fill time in microseconds.
+///\param teardown accumulated destruction time in microseconds.
+template <typename Make>
+void scratch_round(Make make, const std::vector<int>& keys, double& build, double& teardown) {
+  volatile std::size_t sink{0};
+  auto start = std::chrono::high_resolution_clock::now();
+  {
+    auto rbt{make()};
+    for (const int& key : keys) {
+      rbt.insert(key);
+    }
+    auto filled = std::chrono::high_resolution_clock::now();
+    build += std::chrono::duration_cast<std::chrono::nanoseconds>(filled-start).count()/1000.0;
+    for (const int& key : keys) {
+      sink = sink+rbt.contains(key);
+    }
+    start = std::chrono::high_resolution_clock::now();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  teardown += std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/1000.0;
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_allocator.txt");
+  out << "size\trounds\theap_build_us\theap_teardown_us\tmonotonic_build_us\tmonotonic_teardown_us" << std::endl;
+
+  std::mt19937 gen(42);
+  for (int size=1<<8; size<=1<<16; size<<=2) {
+    std::uniform_int_distribution<> dis(0, 4*size);
+    std::vector<int> keys(size);
+    for (int& key : keys) {
+      key = dis(gen);
+    }
+    const int rounds{(1<<22)/size};
+    std::vector<char> buffer(64*size+4096); // enough for every node: the upstream is never asked
+    double heap_build{0}, heap_teardown{0}, mono_build{0}, mono_teardown{0};
+    for (int round=0; round<rounds; ++round) {
+      scratch_round([]() { return RBTree<int>{}; }, keys, heap_build, heap_teardown);
+      std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+      scratch_round([&arena]() { return pmr::RBTree<int>{&arena}; }, keys, mono_build, mono_teardown);
+    }
+    out << size << "\t" << rounds << "\t" << heap_build/rounds << "\t" << heap_teardown/rounds << "\t"
+        << mono_build/rounds << "\t" << mono_teardown/rounds << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
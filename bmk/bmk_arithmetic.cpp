@@ -0,0 +1,80 @@
+///\file bmk_arithmetic.cpp
+///\author mpv
+///\brief Bmk arithmetic driver
+/// Small benchmarking experiment to measure the arithmetic paths of RBTree (int and double keys, std::less).
+/// The same random keys are searched in a RBTree using std::less (branch free descent, integer compares)
+/// and in a RBTree using an equivalent user comparator (generic descent); then bulk_load (radix sort and
+/// balanced build) is timed against one insert per key. Results are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/RBT.hpp"
+
+///\brief comparator equivalent to std::less, which keeps RBTree on its generic paths.
+template <typename T>
+struct generic_less {
+  bool operator()(const T& a, const T& b) const noexcept {return a<b;}
+};
+
+///\brief function to measure the average time in nanoseconds of a lookup.
+///\param rbt tree to be searched.
+///\param keys keys to be looked up.
+///\return average time in nanoseconds.
+template <typename Tree, typename T>
+double measure_find(const Tree& rbt, const std::vector<T>& keys) {
+  volatile std::size_t sink{0};
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const T& key : keys) {
+    sink = sink+rbt.contains(key);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(keys.size());
+}
+
+///\brief function to run the experiment on one key type.
+template <typename T>
+void experiment(std::ostream& out, const char* type, const int size, std::mt19937& gen) {
+  std::uniform_int_distribution<> dis(-2*size, 2*size);
+  std::vector<T> keys(size), probes(size);
+  for (int i=0; i<size; ++i) {
+    keys[i] = T(dis(gen));
+    probes[i] = T(dis(gen));
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  RBTree<T> fast;
+  fast.bulk_load(keys.begin(), keys.end());
+  auto end = std::chrono::high_resolution_clock::now();
+  double bulk_time{std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0};
+  start = std::chrono::high_resolution_clock::now();
+  RBTree<T, generic_less<T>> generic;
+  for (const T& key : keys) {
+    generic.insert(key);
+  }
+  end = std::chrono::high_resolution_clock::now();
+  double insert_time{std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0};
+  out << type << "\t" << size << "\t" << measure_find(fast, probes) << "\t" << measure_find(generic, probes) << "\t"
+      << bulk_time << "\t" << insert_time << std::endl;
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_arithmetic.txt");
+  out << "type\tsize\tfind_arithmetic_ns\tfind_generic_ns\tbulk_load_ms\tinserts_ms" << std::endl;
+
+  std::mt19937 gen(42);
+  for (int size=1<<16; size<=1<<22; size<<=2) {
+    experiment<int>(out, "int", size, gen);
+    experiment<double>(out, "double", size, gen);
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
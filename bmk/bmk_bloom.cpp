@@ -0,0 +1,72 @@
+///\file bmk_bloom.cpp
+///\author mpv
+///\brief Bmk bloom driver
+/// Small benchmarking experiment on lookups that mostly miss: contains() on a RBTree of 2^20 keys versus a
+/// FilteredTree (the same tree behind a blocked Bloom filter), for a set of hit rates, given on the command line
+/// as fractions (e.g. bmk_bloom.x 0 0.1 0.5), 0 0.25 0.5 0.75 1 by default.
+/// Average lookup times in nanoseconds and the filter's bytes per key are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/Bloom_filter.hpp"
+
+///\brief function to measure the average time in nanoseconds of a lookup.
+template <typename Lookup>
+double measure(const std::vector<int>& probes, Lookup lookup) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const int& probe : probes) {
+    lookup(probe);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(probes.size());
+}
+
+
+int main(int argc, char* argv[]) {
+  std::vector<double> hit_rates{0, 0.25, 0.5, 0.75, 1};
+  if (argc>1) {
+    hit_rates.clear();
+    for (int i=1; i<argc; ++i) {
+      hit_rates.push_back(std::atof(argv[i]));
+    }
+  }
+
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_bloom.txt");
+  out << "keys\thit_rate\tRBTree_ns\tFilteredTree_ns\tfilter_bytes_per_key" << std::endl;
+
+  const int keys{1<<20};
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(0, keys-1);
+  RBTree<int> tree;
+  FilteredTree<int> filtered;
+  for (int i=0; i<keys; ++i) {
+    const int key{2*dis(gen)}; // even keys are stored, odd keys always miss
+    tree.insert(key);
+    filtered.insert(key);
+  }
+  std::bernoulli_distribution hit(0.5);
+  for (const double& rate : hit_rates) {
+    hit = std::bernoulli_distribution(rate);
+    std::vector<int> probes(1<<22);
+    for (int& probe : probes) {
+      probe = hit(gen) ? *tree.lower_bound(2*dis(gen)) : 2*dis(gen)+1; // a stored key, or a miss
+    }
+    volatile std::size_t sink{0};
+    double tree_time{measure(probes, [&](int probe) { sink = sink+tree.contains(probe); })};
+    double filtered_time{measure(probes, [&](int probe) { sink = sink+filtered.contains(probe); })};
+    out << filtered.size() << "\t" << rate << "\t" << tree_time << "\t" << filtered_time << "\t"
+        << double(filtered.filter_memory())/filtered.size() << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
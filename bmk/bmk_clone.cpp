@@ -0,0 +1,63 @@
+///\file bmk_clone.cpp
+///\author mpv
+///\brief Bmk clone driver
+/// Small benchmarking experiment to measure the cost of deep copying a RBTree<int>.
+/// For a growing number of keys, the copy constructor (one block, iterative walk) and parallel_clone
+/// (one block, subtrees copied by the pool's threads) are timed against the copy of a std::set<int>.
+/// Results are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include "../include/RBT_parallel.hpp"
+
+///\brief function to measure the average time in milliseconds to complete a copy.
+///\param copy callable performing the copy and returning the copied container's size or a key.
+///\param repetitions number of copies to be averaged.
+///\return average time in milliseconds.
+template <typename Copy>
+double measure_time(Copy copy, const int& repetitions) {
+  volatile std::size_t sink{0};
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i=0; i<repetitions; ++i) {
+    sink = sink+copy();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end-start);
+  return elapsed.count()/1000.0/repetitions;
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_clone.txt");
+  out << "size\tcopy_ms\tparallel_clone_ms\tstd_set_ms" << std::endl;
+
+  // define the size of the experiment
+  int repetitions{5};
+  std::mt19937 gen(42);
+
+  for (int size=1<<14; size<=1<<22; size<<=2) {
+    RBTree<int> rbt;
+    std::set<int> set;
+    std::uniform_int_distribution<> dis(1, 4*size);
+    for (int i=0; i<size; ++i) {
+      int key{dis(gen)};
+      rbt.insert(key);
+      set.insert(key);
+    }
+    double copy_time{measure_time([&rbt]() { RBTree<int> copied{rbt}; return copied.get_root()->data; }, repetitions)};
+    double clone_time{measure_time([&rbt]() { return parallel_clone(rbt).get_root()->data; }, repetitions)};
+    double set_time{measure_time([&set]() { std::set<int> copied{set}; return copied.size(); }, repetitions)};
+    out << size << "\t" << copy_time << "\t" << clone_time << "\t" << set_time << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
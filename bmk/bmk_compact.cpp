@@ -0,0 +1,93 @@
+///\file bmk_compact.cpp
+///\author mpv
+///\brief Bmk compaction driver
+/// Small benchmarking experiment to measure the effect of compact() on a RBTree scattered by churn.
+/// A RBTree<int> goes through rounds of random insertions and deletions; then a full in-order scan and a batch of
+/// random find() are timed before compaction, after an in-order compaction and after a van Emde Boas compaction,
+/// together with the layout metrics reported by layout_stats(). Results are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/RBT.hpp"
+
+///\brief function to measure the time in milliseconds of a full in-order scan.
+///\param rbt tree to be scanned.
+///\return time in milliseconds.
+double measure_scan(const RBTree<int>& rbt) {
+  volatile long long sink{0};
+  auto start = std::chrono::high_resolution_clock::now();
+  for (auto it=rbt.begin(); it!=rbt.end(); ++it) {
+    sink = sink+*it;
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+}
+
+///\brief function to measure the average time in nanoseconds of a lookup.
+///\param rbt tree to be searched.
+///\param keys keys to be looked up.
+///\return average time in nanoseconds.
+double measure_find(const RBTree<int>& rbt, const std::vector<int>& keys) {
+  volatile std::size_t sink{0};
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const int& key : keys) {
+    sink = sink+rbt.contains(key);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(keys.size());
+}
+
+///\brief function to print a row of measures.
+void report(std::ostream& out, const char* label, const RBTree<int>& rbt, const std::vector<int>& keys) {
+  LayoutStats stats{rbt.layout_stats()};
+  out << label << "\t" << measure_scan(rbt) << "\t" << measure_find(rbt, keys) << "\t" << stats.occupancy << "\t"
+      << stats.adjacent_ratio << "\t" << stats.same_page_ratio << std::endl;
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_compact.txt");
+  out << "layout\tscan_ms\tfind_ns\toccupancy\tadjacent_ratio\tsame_page_ratio" << std::endl;
+
+  // define the size of the experiment
+  int size_experiment{1000000};
+  int rounds{4};
+
+  // churn: random insertions and deletions scatter the nodes
+  RBTree<int> rbt;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(1, 4*size_experiment);
+  for (int r=0; r<rounds; ++r) {
+    for (int i=0; i<size_experiment; ++i) {
+      rbt.insert(dis(gen));
+    }
+    for (int i=0; i<size_experiment/2; ++i) {
+      int key{dis(gen)};
+      if (rbt.contains(key)) {
+        rbt.delete_(key);
+      }
+    }
+  }
+  std::vector<int> keys(size_experiment);
+  for (int& key : keys) {
+    key = dis(gen);
+  }
+
+  // measure before and after each compaction
+  report(out, "churned", rbt, keys);
+  rbt.compact(IN_ORDER);
+  report(out, "in_order", rbt, keys);
+  rbt.compact(VAN_EMDE_BOAS);
+  report(out, "van_emde_boas", rbt, keys);
+
+  // close output file
+  out.close();
+
+  return 0;
+}
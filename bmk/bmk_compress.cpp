@@ -0,0 +1,86 @@
+///\file bmk_compress.cpp
+///\author mpv
+///\brief Bmk compress driver
+/// Small benchmarking experiment on cold integer indexes: a RBTree of 2^20 keys versus its compress() snapshot,
+/// for keys of growing average gap (dense ids, clustered ids, uniform 32-bit and 64-bit values).
+/// Bytes per key, contains() times (half hits) and in-order scan times are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/RBT.hpp"
+
+///\brief function to measure the average time in nanoseconds of an operation repeated count times.
+template <typename Operation>
+double measure(const std::size_t count, Operation operation) {
+  auto start = std::chrono::high_resolution_clock::now();
+  operation();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(count);
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_compress.txt");
+  out << "mean_gap\tkeys\tRBTree_bytes_per_key\tsnapshot_bytes_per_key\tRBTree_contains_ns\tsnapshot_contains_ns"
+      << "\tRBTree_scan_ns\tsnapshot_scan_ns" << std::endl;
+
+  const std::size_t keys{1<<20};
+  std::mt19937_64 gen(42);
+  for (std::uint64_t gap : {std::uint64_t{1}, std::uint64_t{16}, std::uint64_t{1}<<12, std::uint64_t{1}<<44}) {
+    std::uniform_int_distribution<std::uint64_t> step(1, 2*gap-1);
+    std::vector<std::uint64_t> values(keys);
+    std::uint64_t key{0};
+    for (std::uint64_t& value : values) {
+      key += gap==1 ? 1 : step(gen);
+      value = key;
+    }
+    RBTree<std::uint64_t> tree;
+    tree.bulk_load(values.begin(), values.end());
+    CompressedSnapshot<std::uint64_t> snapshot{tree.compress()};
+    const double tree_bytes(tree.layout_stats().slots*sizeof(_Node<std::uint64_t>));
+    std::uniform_int_distribution<std::size_t> pick(0, keys-1);
+    std::vector<std::uint64_t> probes(1<<20);
+    for (std::uint64_t& probe : probes) {
+      probe = values[pick(gen)]+(pick(gen)%2); // a key, or most likely a miss just after it
+    }
+    volatile std::uint64_t sink{0};
+    double tree_contains{measure(probes.size(), [&]() {
+      for (const std::uint64_t& probe : probes) {
+        sink = sink+tree.contains(probe);
+      }
+    })};
+    double snapshot_contains{measure(probes.size(), [&]() {
+      for (const std::uint64_t& probe : probes) {
+        sink = sink+snapshot.contains(probe);
+      }
+    })};
+    double tree_scan{measure(keys, [&]() {
+      std::uint64_t sum{0};
+      for (const std::uint64_t& stored : tree) {
+        sum += stored;
+      }
+      sink = sink+sum;
+    })};
+    double snapshot_scan{measure(keys, [&]() {
+      std::uint64_t sum{0};
+      for (std::uint64_t stored : snapshot) {
+        sum += stored;
+      }
+      sink = sink+sum;
+    })};
+    out << gap << "\t" << keys << "\t" << tree_bytes/keys << "\t" << double(snapshot.memory())/keys << "\t"
+        << tree_contains << "\t" << snapshot_contains << "\t" << tree_scan << "\t" << snapshot_scan << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
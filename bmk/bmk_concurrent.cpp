@@ -0,0 +1,134 @@
+///\file bmk_concurrent.cpp
+///\author mpv
+///\brief Bmk concurrent reads driver
+/// Small benchmarking experiment to measure how the read throughput scales with the number of reader threads,
+/// comparing the lock-free readers of ConcurrentRBTree against a RBTree guarded by a std::shared_mutex.
+/// The tree is first filled with random int keys; then, for a growing number of readers, each reader looks up
+/// random keys for a fixed time window while a single writer keeps inserting and deleting keys (read-mostly workload).
+/// The total number of lookups per second is written, for each number of readers, to a .txt file.
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "../include/RBT_concurrent.hpp"
+
+///\brief a RBTree guarded by a reader/writer lock (baseline).
+struct SharedMutexTree {
+  RBTree<int> tree;
+  mutable std::shared_mutex lock;
+
+  void insert(const int& value) {
+    std::unique_lock<std::shared_mutex> guard{lock};
+    tree.insert(value);
+  }
+
+  void delete_(const int& value) {
+    std::unique_lock<std::shared_mutex> guard{lock};
+    if (tree.contains(value)) {
+      tree.delete_(value);
+    }
+  }
+
+  bool contains(const int& value) const {
+    std::shared_lock<std::shared_mutex> guard{lock};
+    return tree.contains(value);
+  }
+};
+
+///\brief function to run readers against one writer for a fixed time window.
+///\param insert_fn writer's insertion.
+///\param delete_fn writer's deletion.
+///\param make_reader factory returning, for each reader thread, a callable that looks up a key.
+///\param readers number of reader threads.
+///\param key_range keys are drawn uniformly from [0, key_range).
+///\param window duration of the measure.
+///\return lookups per second, summed over all readers.
+template <typename Insert, typename Delete, typename MakeReader>
+double measure_throughput(Insert insert_fn, Delete delete_fn, MakeReader make_reader, const int& readers,
+                          const int& key_range, const std::chrono::milliseconds& window) {
+  std::atomic<bool> start{false}, stop{false};
+  std::atomic<unsigned long long> total{0};
+  std::vector<std::thread> threads;
+  for (int r=0; r<readers; ++r) {
+    threads.emplace_back([&, r]() {
+      auto lookup = make_reader();
+      std::mt19937 gen(r+1);
+      std::uniform_int_distribution<> dis(0, key_range-1);
+      unsigned long long done{0};
+      while (!start.load()) { std::this_thread::yield(); }
+      while (!stop.load(std::memory_order_relaxed)) {
+        lookup(dis(gen));
+        ++done;
+      }
+      total += done;
+    });
+  }
+  std::thread writer([&]() {
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<> dis(0, key_range-1);
+    while (!start.load()) { std::this_thread::yield(); }
+    while (!stop.load(std::memory_order_relaxed)) {
+      insert_fn(dis(gen));
+      delete_fn(dis(gen));
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  });
+  start = true;
+  std::this_thread::sleep_for(window);
+  stop = true;
+  writer.join();
+  for (auto& t : threads) {
+    t.join();
+  }
+  return total.load()/(window.count()/1000.0);
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_concurrent.txt");
+
+  // define the size of the experiment
+  int key_range{200000};
+  std::chrono::milliseconds window{500};
+  int max_readers{2*int(std::max(1u, std::thread::hardware_concurrency()))};
+
+  // define our experimental subjects (containers), half of the keys are present
+  ConcurrentRBTree<int> crbt;
+  SharedMutexTree smt;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(0, key_range-1);
+  for (int i=0; i<key_range/2; ++i) {
+    int key{dis(gen)};
+    crbt.insert(key);
+    smt.insert(key);
+  }
+
+  // grow the number of readers & measure the aggregated read throughput
+  for (int readers=1; readers<=max_readers; readers*=2) {
+    double lock_free{measure_throughput(
+      [&](int k) { crbt.insert(k); }, [&](int k) { crbt.delete_(k); },
+      [&]() { return [r = std::make_shared<ConcurrentRBTree<int>::reader>(crbt.get_reader())](int k) { return r->contains(k); }; },
+      readers, key_range, window)};
+    double locked{measure_throughput(
+      [&](int k) { smt.insert(k); }, [&](int k) { smt.delete_(k); },
+      [&]() { return [&](int k) { return smt.contains(k); }; },
+      readers, key_range, window)};
+    std::cout << readers << " readers: " << lock_free << " vs " << locked << " lookups/s" << std::endl;
+    // print the output throughputs
+    out << readers << "\t" << lock_free << "\t" << locked << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
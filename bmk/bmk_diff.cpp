@@ -0,0 +1,80 @@
+///\file bmk_diff.cpp
+///\author mpv
+///\brief Bmk diff driver
+/// Small benchmarking experiment on replicating an index: a replica holds one version of a tree of 2^20 keys,
+/// the primary a newer one with a growing number of changes. The delta is computed by diff() on trees with
+/// subtree digests (DigestAugmentation) and by the merge walk of plain trees, then applied to the replica;
+/// both are compared with shipping the whole tree (a copy). Times in microseconds are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/RBT_diff.hpp"
+
+///\brief function to measure the time in microseconds of a callable.
+template <typename Operation>
+double measure(Operation operation) {
+  auto start = std::chrono::high_resolution_clock::now();
+  operation();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/1000.0;
+}
+
+
+///\brief function to apply the same changes to a tree: odd keys are added, even keys removed.
+template <typename Tree>
+void change(Tree& tree, const std::vector<int>& changes) {
+  for (const int& key : changes) {
+    if (key%2!=0) {
+      tree.insert(key);
+    } else if (tree.contains(key)) { // a key may be picked twice
+      tree.delete_(key);
+    }
+  }
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_diff.txt");
+  out << "keys\tchanges\tdigest_diff_us\tmerge_diff_us\tapply_delta_us\tcopy_us" << std::endl;
+
+  typedef RBTree<int, std::less<int>, DigestAugmentation<int>> DigestTree;
+  const int keys{1<<20};
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(0, keys-1);
+  DigestTree digest_replica;
+  RBTree<int> plain_replica;
+  for (int i=0; i<keys; ++i) {
+    digest_replica.insert(2*i); // even keys are stored, odd keys are not
+    plain_replica.insert(2*i);
+  }
+  for (int changes=1; changes<=1<<16; changes<<=3) {
+    std::vector<int> picked(changes);
+    for (int& key : picked) {
+      key = 2*dis(gen)+(dis(gen)%2); // a stored key to remove, or a new one to add
+    }
+    DigestTree digest_primary{digest_replica};
+    RBTree<int> plain_primary{plain_replica};
+    change(digest_primary, picked);
+    change(plain_primary, picked);
+    Delta<int> delta;
+    double digest_time{measure([&]() { delta = diff(digest_replica, digest_primary); })};
+    double merge_time{measure([&]() { delta = diff(plain_replica, plain_primary); })};
+    DigestTree applied{digest_replica};
+    double apply_time{measure([&]() { applied.apply_delta(delta); })};
+    double copy_time{measure([&]() { DigestTree shipped{digest_primary}; })};
+    out << keys << "\t" << delta.size() << "\t" << digest_time << "\t" << merge_time << "\t"
+        << apply_time << "\t" << copy_time << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
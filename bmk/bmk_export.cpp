@@ -0,0 +1,67 @@
+///\file bmk_export.cpp
+///\author mpv
+///\brief Bmk export driver
+/// Small benchmarking experiment to measure the time to dump every key of a RBTree<int> to a file.
+/// For a growing number of keys, writing one key per line through std::ofstream and std::endl
+/// (as print_ordered_keys does) is timed against export_keys (big buffered blocks, std::to_chars)
+/// and KeyExporter::export_parallel. Results are written to a .txt file.
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <unistd.h>
+#include "../include/RBT_export.hpp"
+
+///\brief function to measure the time in milliseconds of an export.
+///\param dump callable writing every key to the scratch file.
+///\return time in milliseconds.
+template <typename Dump>
+double measure_time(Dump dump) {
+  auto start = std::chrono::high_resolution_clock::now();
+  dump();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(end-start).count()/1000.0;
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_export.txt");
+  out << "size\tendl_ms\texport_keys_ms\texport_parallel_ms" << std::endl;
+  const char* scratch{"../bmk/bmk_export_scratch.tmp"};
+
+  std::mt19937 gen(42);
+  KeyExporter exporter;
+  for (int size=1<<16; size<=1<<22; size<<=2) {
+    RBTree<int> rbt;
+    std::uniform_int_distribution<> dis(1, 4*size);
+    for (int i=0; i<size; ++i) {
+      rbt.insert(dis(gen));
+    }
+    double endl_time{measure_time([&]() {
+      std::ofstream file{scratch};
+      rbt.visit_inorder([&file](const int& key) { file << key << std::endl; });
+    })};
+    double export_time{measure_time([&]() {
+      int fd{::open(scratch, O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+      exporter.export_keys(rbt, FdSink{fd});
+      ::close(fd);
+    })};
+    double parallel_time{measure_time([&]() {
+      int fd{::open(scratch, O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+      exporter.export_parallel(rbt, FdSink{fd});
+      ::close(fd);
+    })};
+    out << size << "\t" << endl_time << "\t" << export_time << "\t" << parallel_time << std::endl;
+  }
+  std::remove(scratch);
+
+  // close output file
+  out.close();
+
+  return 0;
+}
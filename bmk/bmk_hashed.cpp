@@ -0,0 +1,101 @@
+///\file bmk_hashed.cpp
+///\author mpv
+///\brief Bmk hashed driver
+/// Small benchmarking experiment on point lookups in an ordered index: RBTree, HashedTree (the tree plus a hash
+/// index of its nodes), std::map and std::unordered_map, for a growing number of keys.
+/// Average lookup times in nanoseconds (half hits, half misses) and the heap bytes per key of each container
+/// are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "../include/Hashed_tree.hpp"
+
+std::size_t allocated{0}; ///< bytes requested from the global heap, minus the bytes given back by sized deletes.
+
+void* operator new(std::size_t bytes) {
+  allocated += bytes;
+  if (void* memory = std::malloc(bytes)) {
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {std::free(memory);}
+
+void operator delete(void* memory, std::size_t bytes) noexcept { // the standard allocators free with the size
+  allocated -= bytes;
+  std::free(memory);
+}
+
+
+///\brief function to measure the average time in nanoseconds of a lookup.
+template <typename Lookup>
+double measure(const std::vector<int>& probes, Lookup lookup) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const int& probe : probes) {
+    lookup(probe);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(probes.size());
+}
+
+
+///\brief function to build a container of keys and measure the heap bytes it holds.
+template <typename Container, typename Insert>
+std::size_t build(Container& container, const std::vector<int>& keys, Insert insert) {
+  std::size_t before{allocated};
+  for (const int& key : keys) {
+    insert(container, key);
+  }
+  return allocated-before;
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_hashed.txt");
+  out << "keys\tRBTree_ns\tHashedTree_ns\tstd::map_ns\tstd::unordered_map_ns"
+      << "\tRBTree_bytes_per_key\tHashedTree_bytes_per_key\tstd::map_bytes_per_key\tstd::unordered_map_bytes_per_key" << std::endl;
+
+  std::mt19937 gen(42);
+  for (int size=1<<10; size<=1<<20; size<<=2) {
+    std::uniform_int_distribution<> dis(0, size-1);
+    std::vector<int> keys(size), probes(1<<21);
+    for (int& key : keys) {
+      key = 2*dis(gen); // even keys are stored, odd keys miss
+    }
+    for (int& probe : probes) {
+      probe = 2*dis(gen)+(dis(gen)%2);
+    }
+    RBTree<int> tree;
+    HashedTree<int> hashed;
+    std::map<int, int> map;
+    std::unordered_map<int, int> unordered_map;
+    double tree_bytes(build(tree, keys, [](RBTree<int>& c, int key) { c.insert(key); }));
+    double hashed_bytes(build(hashed, keys, [](HashedTree<int>& c, int key) { c.insert(key); }));
+    double map_bytes(build(map, keys, [](std::map<int, int>& c, int key) { c.emplace(key, key); }));
+    double unordered_bytes(build(unordered_map, keys, [](std::unordered_map<int, int>& c, int key) { c.emplace(key, key); }));
+    const double stored(hashed.size());
+    volatile std::size_t sink{0};
+    double tree_time{measure(probes, [&](int probe) { sink = sink+tree.contains(probe); })};
+    double hashed_time{measure(probes, [&](int probe) { sink = sink+hashed.contains(probe); })};
+    double map_time{measure(probes, [&](int probe) { sink = sink+map.count(probe); })};
+    double unordered_time{measure(probes, [&](int probe) { sink = sink+unordered_map.count(probe); })};
+    out << hashed.size() << "\t" << tree_time << "\t" << hashed_time << "\t" << map_time << "\t" << unordered_time << "\t"
+        << tree_bytes/stored << "\t" << hashed_bytes/stored << "\t" << map_bytes/stored << "\t" << unordered_bytes/stored << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
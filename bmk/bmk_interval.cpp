@@ -0,0 +1,91 @@
+///\file bmk_interval.cpp
+///\author mpv
+///\brief Bmk interval queries driver
+/// Small benchmarking experiment to compare overlap queries on the IntervalTree against a brute-force scan.
+/// Random intervals (short, with random start points) are inserted -in 50 increments- from 500 to 50000 into both
+/// an IntervalTree and a std::vector; then a fixed number of random short query ranges is looked up in both.
+/// The average time in microseconds per query is written, for each number of intervals, to a .txt file.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/Interval_tree.hpp"
+
+///\brief function to measure the average time in microseconds to complete an overlap query.
+///\param query callable counting the intervals overlapping [low, high].
+///\param queries query ranges.
+///\return average time in microseconds.
+template <typename Query>
+double measure_time(Query query, const std::vector<Interval<int>>& queries) {
+  volatile std::size_t sink{0};
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const auto& q : queries) {
+    sink = sink+query(q.low, q.high);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end-start);
+  return elapsed.count()/1000.0/queries.size();
+}
+
+///\brief function to generate random short intervals.
+///\param numbers number of intervals to be generated.
+///\param range start points are drawn from [0, range).
+///\param max_length maximum length of each interval.
+///\return a vector filled with random intervals.
+std::vector<Interval<int>> generate_random(const int& numbers, const int& range, const int& max_length) {
+  std::vector<Interval<int>> v;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> start(0, range);
+  std::uniform_int_distribution<> length(0, max_length);
+  for (int i=0; i<numbers; i++) {
+    int low{start(gen)};
+    v.push_back({low, low+length(gen)});
+  }
+  return v;
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_interval.txt");
+
+  // define the size of the experiment
+  int size_experiment{50000};
+  int size_start{500};
+  int step{500};
+  int range{10000000};
+
+  // generate random intervals and queries
+  std::vector<Interval<int>> intervals{generate_random(size_experiment, range, 1000)};
+  std::vector<Interval<int>> queries{generate_random(1000, range, 1000)};
+
+  // define our experimental subjects (containers)
+  IntervalTree<int> itree;
+  std::vector<Interval<int>> scan;
+
+  // insert intervals into containers & measure time elapsed to query them
+  for (int i=size_start; i<=size_experiment; i+=step) {
+    for (int j=i-step; j<i; ++j) {
+      itree.insert(intervals[j]);
+      scan.push_back(intervals[j]);
+    }
+    double tree_time{measure_time([&](int low, int high) { return itree.overlapping(low, high).size(); }, queries)};
+    double scan_time{measure_time([&](int low, int high) {
+      std::size_t count{0};
+      for (const auto& interval : scan) {
+        count += !(interval.high<low or high<interval.low);
+      }
+      return count;
+    }, queries)};
+    // print the output times
+    out << i << "\t" << tree_time << "\t" << scan_time << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
@@ -0,0 +1,119 @@
+///\file bmk_keyed.cpp
+///\author mpv
+///\brief Bmk keyed driver
+/// Small benchmarking experiment on record indexes: 2^20 orders indexed by their id, as a std::map from the id to
+/// the order (the key stored twice), as a RBTree of orders with a comparator over whole orders (a dummy order
+/// built for every lookup), and as a KeyedRBTree searched by the id alone.
+/// Heap bytes per record and average lookup times in nanoseconds (half hits) are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/Key_of.hpp"
+
+std::size_t allocated{0}; ///< bytes requested from the global heap, minus the bytes given back by sized deletes.
+
+void* operator new(std::size_t bytes) {
+  allocated += bytes;
+  if (void* memory = std::malloc(bytes)) {
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {std::free(memory);}
+
+void operator delete(void* memory, std::size_t bytes) noexcept { // the standard allocators free with the size
+  allocated -= bytes;
+  std::free(memory);
+}
+
+
+///\brief A record indexed by its id.
+struct Order {
+  std::uint64_t id{0};
+  std::string customer;
+  double amount{0};
+  std::uint32_t quantity{0};
+};
+
+///\brief Comparator over whole orders, the way records are indexed without a projection.
+struct OrderLess {
+  bool operator()(const Order& a, const Order& b) const noexcept {return a.id<b.id;}
+};
+
+
+///\brief function to measure the average time in nanoseconds of a lookup.
+template <typename Lookup>
+double measure(const std::vector<std::uint64_t>& probes, Lookup lookup) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const std::uint64_t& probe : probes) {
+    lookup(probe);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(probes.size());
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_keyed.txt");
+  out << "structure\trecords\tbytes_per_record\tlookup_ns" << std::endl;
+
+  const std::size_t records{1<<20};
+  std::mt19937_64 gen(42);
+  std::vector<Order> orders(records);
+  for (std::size_t i=0; i<records; ++i) {
+    orders[i] = Order{2*(gen()>>2), "customer-" + std::to_string(gen()%100000), double(gen()%10000)/100, std::uint32_t(gen()%10)};
+  }
+  std::vector<std::uint64_t> probes(1<<22);
+  for (std::uint64_t& probe : probes) {
+    probe = orders[gen()%records].id+gen()%2; // odd ids always miss
+  }
+  volatile std::size_t sink{0};
+
+  std::size_t before{allocated};
+  std::map<std::uint64_t, Order> map;
+  for (const Order& order : orders) {
+    map.emplace(order.id, order);
+  }
+  double map_bytes(allocated-before);
+  double map_time{measure(probes, [&](std::uint64_t id) { sink = sink+map.count(id); })};
+  out << "std::map\t" << map.size() << "\t" << map_bytes/map.size() << "\t" << map_time << std::endl;
+
+  before = allocated;
+  RBTree<Order, OrderLess> tree;
+  for (const Order& order : orders) {
+    tree.insert(order);
+  }
+  double tree_bytes(allocated-before);
+  double tree_time{measure(probes, [&](std::uint64_t id) {
+    Order dummy;
+    dummy.id = id;
+    sink = sink+tree.contains(dummy);
+  })};
+  out << "RBTree_dummy_record\t" << map.size() << "\t" << tree_bytes/map.size() << "\t" << tree_time << std::endl;
+
+  before = allocated;
+  KeyedRBTree<Order, KeyMember<&Order::id>> keyed;
+  for (const Order& order : orders) {
+    keyed.insert(order);
+  }
+  double keyed_bytes(allocated-before);
+  double keyed_time{measure(probes, [&](std::uint64_t id) { sink = sink+keyed.contains(id); })};
+  out << "KeyedRBTree\t" << map.size() << "\t" << keyed_bytes/map.size() << "\t" << keyed_time << std::endl;
+
+  // close output file
+  out.close();
+
+  return 0;
+}
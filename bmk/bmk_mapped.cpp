@@ -0,0 +1,123 @@
+///\file bmk_mapped.cpp
+///\author mpv
+///\brief Bmk mapped driver
+/// Small benchmarking experiment on restarts: a RBTree of 2^20 keys saved as a binary file of keys and rebuilt
+/// at startup (one insert per key, or bulk_load), versus a MappedRBTree reopened from its file.
+/// Build and restart times in milliseconds, then lookup and insert times in nanoseconds, are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/RBT.hpp"
+#include "../include/RBT_mapped.hpp"
+
+///\brief function to measure the time in nanoseconds of an operation.
+template <typename Operation>
+double measure(Operation operation) {
+  auto start = std::chrono::high_resolution_clock::now();
+  operation();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count();
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_mapped.txt");
+  out << "structure\tbuild_ms\trestart_ms\tlookup_ns\tinsert_ns" << std::endl;
+
+  const std::size_t keys{1<<20};
+  const std::string tree_path{(std::filesystem::temp_directory_path()/"bmk_mapped.rbt").string()};
+  const std::string keys_path{(std::filesystem::temp_directory_path()/"bmk_mapped.keys").string()};
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(0, 1<<30);
+  std::vector<int> values(keys), probes(1<<20), added(1<<16);
+  for (int& value : values) {
+    value = dis(gen);
+  }
+  for (int& probe : probes) {
+    probe = dis(gen)%2 ? values[probe%keys] : dis(gen);
+  }
+  for (int& value : added) {
+    value = dis(gen);
+  }
+  volatile std::size_t sink{0};
+
+  // RBTree: saved as its keys, rebuilt by each restart
+  double tree_build{measure([&]() {
+    RBTree<int> tree;
+    for (const int& value : values) {
+      tree.insert(value);
+    }
+    std::ofstream saved(keys_path, std::ios::binary);
+    tree.visit_inorder([&saved](const int& key) { saved.write(reinterpret_cast<const char*>(&key), sizeof(key)); });
+  })};
+  RBTree<int> inserted, loaded;
+  double insert_restart{measure([&]() {
+    std::ifstream saved(keys_path, std::ios::binary);
+    for (int key; saved.read(reinterpret_cast<char*>(&key), sizeof(key));) {
+      inserted.insert(key);
+    }
+  })};
+  double bulk_restart{measure([&]() {
+    std::ifstream saved(keys_path, std::ios::binary);
+    std::vector<int> stored(std::filesystem::file_size(keys_path)/sizeof(int));
+    saved.read(reinterpret_cast<char*>(stored.data()), stored.size()*sizeof(int));
+    loaded.bulk_load(stored.begin(), stored.end());
+  })};
+  double tree_lookup{measure([&]() {
+    for (const int& probe : probes) {
+      sink = sink+loaded.contains(probe);
+    }
+  })};
+  double tree_insert{measure([&]() {
+    for (const int& value : added) {
+      loaded.insert(value);
+    }
+  })};
+  out << "RBTree_insert\t" << tree_build/1e6 << "\t" << insert_restart/1e6 << "\t-\t-" << std::endl;
+  out << "RBTree_bulk_load\t" << tree_build/1e6 << "\t" << bulk_restart/1e6 << "\t" << tree_lookup/probes.size() << "\t"
+      << tree_insert/added.size() << std::endl;
+
+  // MappedRBTree: the file is the tree
+  MappedRBTree<int>::remove(tree_path);
+  double mapped_build{measure([&]() {
+    MappedRBTree<int> mapped{tree_path};
+    for (const int& value : values) {
+      mapped.insert(value);
+    }
+    mapped.sync();
+  })};
+  std::size_t found{0};
+  double mapped_restart{measure([&]() {
+    MappedRBTree<int> mapped{tree_path};
+    found = mapped.contains(probes.front()); // first lookup included: pages come from the page cache on demand
+  })};
+  MappedRBTree<int> mapped{tree_path};
+  double mapped_lookup{measure([&]() {
+    for (const int& probe : probes) {
+      sink = sink+mapped.contains(probe);
+    }
+  })};
+  double mapped_insert{measure([&]() {
+    for (const int& value : added) {
+      mapped.insert(value);
+    }
+  })};
+  out << "MappedRBTree\t" << mapped_build/1e6 << "\t" << mapped_restart/1e6 << "\t" << mapped_lookup/probes.size() << "\t"
+      << mapped_insert/added.size() << std::endl;
+  sink = sink+found;
+  MappedRBTree<int>::remove(tree_path);
+  std::filesystem::remove(keys_path);
+
+  // close output file
+  out.close();
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+///\file bmk_merge.cpp
+///\author mpv
+///\brief Bmk merge driver
+/// Small benchmarking experiment on partitioned data: 2^20 keys are spread over k RBTree's (one per partition)
+/// and scanned in global order, lazily by merged_view and by copying every key into a vector then sorting it.
+/// Average times per key in nanoseconds, for a growing number of partitions, are written to a .txt file.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/Merged_view.hpp"
+
+///\brief function to measure the average time in nanoseconds per key of a scan.
+template <typename Scan>
+double measure(const std::size_t keys, Scan scan) {
+  auto start = std::chrono::high_resolution_clock::now();
+  scan();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(keys);
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_merge.txt");
+  out << "partitions\tkeys\tmerged_view_ns\tmerged_view_distinct_ns\tcopy_sort_ns" << std::endl;
+
+  const std::size_t keys{1<<20};
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(0, 1<<30);
+  std::vector<int> values(keys);
+  for (int& value : values) {
+    value = dis(gen);
+  }
+  for (std::size_t partitions=1; partitions<=64; partitions<<=1) {
+    std::vector<RBTree<int>> trees(partitions);
+    for (std::size_t i=0; i<keys; ++i) {
+      trees[values[i]%partitions].insert(values[i]); // hash partitioning
+    }
+    std::vector<const RBTree<int>*> parts;
+    for (const RBTree<int>& tree : trees) {
+      parts.push_back(&tree);
+    }
+    volatile long long sink{0};
+    double merged_time{measure(keys, [&]() {
+      long long sum{0};
+      for (int key : MergedView<RBTree<int>>(parts)) {
+        sum += key;
+      }
+      sink = sink+sum;
+    })};
+    double distinct_time{measure(keys, [&]() {
+      long long sum{0};
+      for (int key : MergedView<RBTree<int>>(parts, SKIP_DUPLICATES)) {
+        sum += key;
+      }
+      sink = sink+sum;
+    })};
+    double sorted_time{measure(keys, [&]() {
+      std::vector<int> copied;
+      for (const RBTree<int>& tree : trees) {
+        copied.insert(copied.end(), tree.begin(), tree.end());
+      }
+      std::sort(copied.begin(), copied.end());
+      long long sum{0};
+      for (int key : copied) {
+        sum += key;
+      }
+      sink = sink+sum;
+    })};
+    out << partitions << "\t" << keys << "\t" << merged_time << "\t" << distinct_time << "\t" << sorted_time << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
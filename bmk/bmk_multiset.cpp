@@ -0,0 +1,64 @@
+///\file bmk_multiset.cpp
+///\author mpv
+///\brief Bmk multiset driver
+/// Small benchmarking experiment on a histogram workload: millions of events over a few thousand distinct keys
+/// are counted by a CountedMultiset (one node per distinct key) and by a std::multiset (one node per event).
+/// Insertion and count() times and the number of nodes allocated are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+#include "../include/Counted_multiset.hpp"
+
+///\brief function to measure the average time in nanoseconds of an operation applied to every key.
+///\param keys keys the operation is applied to.
+///\param operation callable invoked as operation(key).
+///\return average time in nanoseconds.
+template <typename Operation>
+double measure(const std::vector<int>& keys, Operation operation) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const int& key : keys) {
+    operation(key);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(keys.size());
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_multiset.txt");
+  out << "events\tdistinct\tcounted_insert_ns\tmultiset_insert_ns\tcounted_count_ns\tmultiset_count_ns\tcounted_nodes\tmultiset_nodes" << std::endl;
+
+  std::mt19937 gen(42);
+  const int distinct{4096};
+  for (int events=1<<16; events<=1<<22; events<<=2) {
+    std::uniform_int_distribution<> dis(0, distinct-1);
+    std::vector<int> keys(events), probes(distinct);
+    for (int& key : keys) {
+      key = dis(gen);
+    }
+    for (int& probe : probes) {
+      probe = dis(gen);
+    }
+    volatile std::size_t sink{0};
+    CountedMultiset<int> counted;
+    std::multiset<int> plain;
+    double counted_insert{measure(keys, [&](int key) { counted.insert(key); })};
+    double plain_insert{measure(keys, [&](int key) { plain.insert(key); })};
+    double counted_count{measure(probes, [&](int key) { sink = sink+counted.count(key); })};
+    double plain_count{measure(probes, [&](int key) { sink = sink+plain.count(key); })}; // linear in the repeats
+    out << events << "\t" << distinct << "\t" << counted_insert << "\t" << plain_insert << "\t" << counted_count << "\t"
+        << plain_count << "\t" << counted.distinct_size() << "\t" << plain.size() << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+///\file bmk_parallel.cpp
+///\author mpv
+///\brief Bmk parallel scans driver
+/// Small benchmarking experiment to measure how a full-tree scan scales with the number of threads.
+/// A RBTree is filled with random int keys; then the sum of all keys is computed with parallel_reduce on pools
+/// of growing size, against the sequential scan through const_iterator (and through parallel_reduce on one thread).
+/// The average time in milliseconds of each scan is written, for each number of threads, to a .txt file.
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <thread>
+#include "../include/RBT_parallel.hpp"
+
+///\brief function to measure the average time in milliseconds to complete a scan.
+///\param scan callable performing the scan and returning its result.
+///\param repetitions number of scans to be averaged.
+///\return average time in milliseconds.
+template <typename Scan>
+double measure_time(Scan scan, const int& repetitions) {
+  volatile long long sink{0};
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i=0; i<repetitions; ++i) {
+    sink = sink+scan();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end-start);
+  return elapsed.count()/1000.0/repetitions;
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_parallel.txt");
+
+  // define the size of the experiment
+  int size_experiment{1000000};
+  int repetitions{5};
+  unsigned int max_threads{2*std::max(1u, std::thread::hardware_concurrency())};
+
+  // fill the tree with random numbers
+  RBTree<long long> rbt;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<long long> dis(0, 100*size_experiment);
+  for (int i=0; i<size_experiment; ++i) {
+    rbt.insert(dis(gen));
+  }
+
+  // sequential baseline through the const_iterator
+  double sequential{measure_time([&]() {
+    long long sum{0};
+    for (auto it=rbt.begin(); it!=rbt.end(); ++it) {
+      sum += *it;
+    }
+    return sum;
+  }, repetitions)};
+
+  // grow the number of threads & measure the parallel scan
+  for (unsigned int threads=1; threads<=max_threads; threads*=2) {
+    ThreadPool pool{threads-1}; // the calling thread works as well
+    double parallel{measure_time([&]() {
+      return parallel_reduce(rbt, 0LL, std::plus<long long>{}, rbt_parallel::identity{}, rbt_parallel::default_grain, pool);
+    }, repetitions)};
+    std::cout << threads << " threads: " << parallel << " ms vs " << sequential << " ms (sequential)" << std::endl;
+    // print the output times
+    out << threads << "\t" << parallel << "\t" << sequential << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
@@ -0,0 +1,194 @@
+///\file bmk_perf.hpp
+///\author mpv
+///\brief Hardware performance counters for the benchmarks (Linux perf_event_open).
+/// PerfCounters reads cycles, instructions, L1d/LLC/dTLB load misses and branch misses of the calling thread
+/// around a measured region (user space only). The counters form two perf groups, {cycles, instructions,
+/// branch misses} and {L1d, LLC, dTLB misses}: each group is enabled, disabled and read by a single call on its
+/// leader and is scheduled on the PMU all at once or not at all, so that the cache group needing three
+/// general-purpose counters cannot keep cycles and instructions from being counted (e.g. with the NMI watchdog
+/// holding a counter). Counters the kernel or the CPU refuses (no PMU in a VM, perf_event_paranoid too strict,
+/// non-Linux build), or a group never scheduled (warned once on stderr), are reported as NaN;
+/// the benchmark itself runs unchanged.
+
+#ifndef BMK_PERF_HPP
+#define BMK_PERF_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+///\brief Groups of hardware counters of the calling thread, opened once and read around each measured region.
+///       The first counter opened in a group leads it; every ioctl and read goes through the leaders.
+class PerfCounters {
+public:
+  static constexpr int events{6}; ///< number of counters.
+  static constexpr int groups{2}; ///< number of perf groups.
+
+  ///\brief Names of the counters, as written in the benchmarks' headers.
+  static const char* name(const int event) noexcept {
+    static const char* names[events]{"cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"};
+    return names[event];
+  }
+
+
+  ///\brief Group of a counter: cycles, instructions and branch misses fit the fixed counters and one more.
+  static int group(const int event) noexcept {
+    static const int group_of[events]{0, 0, 1, 1, 1, 0};
+    return group_of[event];
+  }
+
+
+private:
+  int fds[events];                   ///< one descriptor per counter, -1 if unavailable.
+  int positions[events];             ///< position of each counter in its group's read, -1 if unavailable.
+  int leaders[groups]{-1, -1};       ///< descriptor of each group's leader, -1 if none of its counters is available.
+  int members[groups]{0, 0};         ///< number of counters in each group.
+  bool warned[groups]{false, false}; ///< whether each group has been reported as never scheduled.
+  double values[events];             ///< counts of the last region (NaN if unavailable).
+
+
+#ifdef __linux__
+  ///\brief Encodes a cache event (see: perf_event_open(2), PERF_TYPE_HW_CACHE).
+  static std::uint64_t cache_miss(const std::uint64_t cache) noexcept {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ<<8) | (PERF_COUNT_HW_CACHE_RESULT_MISS<<16);
+  }
+
+  ///\brief Opens one counter on the calling thread and any CPU, as its group's leader (disabled)
+  ///       or as a member following the leader's state.
+  ///\param event Index of the counter (see: name).
+  void open(const int event, const std::uint32_t type, const std::uint64_t config) noexcept {
+    int& leader{leaders[group(event)]};
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = leader<0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING; // to scale multiplexed counts
+    fds[event] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0));
+    if (fds[event]>=0) {
+      leader = leader<0 ? fds[event] : leader;
+      positions[event] = members[group(event)]++;
+    }
+  }
+#endif
+
+
+public:
+  ///\brief Opens the counters.
+  ///\param enabled Whether counters are wanted at all (false leaves every counter unavailable).
+  explicit PerfCounters(const bool enabled=true) noexcept {
+    for (int i=0; i<events; ++i) {
+      fds[i] = -1;
+      positions[i] = -1;
+      values[i] = std::nan("");
+    }
+#ifdef __linux__
+    if (!enabled) {
+      return;
+    }
+    open(0, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    open(1, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    open(2, PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D));
+    open(3, PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL));
+    open(4, PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB));
+    open(5, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#else
+    (void)enabled;
+#endif
+  }
+
+  ///\brief Closes the counters.
+  ~PerfCounters() noexcept {
+#ifdef __linux__
+    for (const int fd : fds) {
+      if (fd>=0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+
+  ///\brief Whether at least one counter could be opened.
+  bool available() const noexcept {return leaders[0]>=0 or leaders[1]>=0;}
+
+
+  ///\brief Resets and starts the groups (call right before the measured region, timestamps inside it).
+  void start() noexcept {
+#ifdef __linux__
+    for (const int leader : leaders) {
+      if (leader>=0) {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+      }
+    }
+#endif
+  }
+
+
+  ///\brief Stops the groups and reads each at once (call right after the measured region).
+  ///       A group which was never scheduled on the PMU leaves its counters NaN, and is warned about once.
+  void stop() noexcept {
+#ifdef __linux__
+    for (const int leader : leaders) {
+      if (leader>=0) {
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      }
+    }
+    for (int g=0; g<groups; ++g) {
+      std::uint64_t read_values[3+events]; // number of counters, time enabled, time running, then the counts
+      const ssize_t expected(sizeof(std::uint64_t)*(3+members[g]));
+      const bool scheduled{leaders[g]>=0 and read(leaders[g], read_values, sizeof(read_values))==expected and read_values[2]>0};
+      if (leaders[g]>=0 and !scheduled and !warned[g]) {
+        std::cerr << "perf group " << g << " never scheduled (too few free PMU counters), its counters are NaN" << std::endl;
+        warned[g] = true;
+      }
+      for (int i=0; i<events; ++i) {
+        if (group(i)==g) {
+          values[i] = scheduled and positions[i]>=0 ? double(read_values[3+positions[i]])*double(read_values[1])/double(read_values[2]) : std::nan("");
+        }
+      }
+    }
+#endif
+  }
+
+
+  ///\brief Getter for a counter of the last region (NaN if unavailable).
+  double value(const int event) const noexcept {return values[event];}
+
+
+  ///\brief Writes the counters of the last region divided by the number of operations, tab separated.
+  ///\param out The output stream.
+  ///\param operations Operations performed in the region.
+  void write_per_operation(std::ostream& out, const double operations) const {
+    for (int i=0; i<events; ++i) {
+      out << "\t" << values[i]/operations;
+    }
+  }
+
+
+  ///\brief Writes the names of the counters of a series, tab separated (e.g. "RBTree_cycles").
+  static void write_header(std::ostream& out, const std::string& series) {
+    for (int i=0; i<events; ++i) {
+      out << "\t" << series << "_" << name(i);
+    }
+  }
+};
+
+
+#endif // BMK_PERF_HPP
@@ -0,0 +1,89 @@
+///\file bmk_priority.cpp
+///\author mpv
+///\brief Bmk priority driver
+/// Small benchmarking experiment on a scheduler workload (the "hold" model): a queue of pending event times is kept
+/// at a constant size while the earliest event is popped and a later one pushed, then the queue is drained.
+/// RBTree's pop_min() unlinks the cached leftmost node, std::set erases begin(), std::priority_queue is a binary heap.
+/// Average hold and drain times per operation are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <set>
+#include <vector>
+#include "../include/RBT.hpp"
+
+///\brief function to measure the average time in nanoseconds of a step repeated many times.
+///\param steps number of repetitions.
+///\param step callable invoked as step(i).
+///\return average time in nanoseconds.
+template <typename Step>
+double measure(const std::size_t steps, Step step) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (std::size_t i=0; i<steps; ++i) {
+    step(i);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(steps);
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_priority.txt");
+  out << "pending\tRBTree_hold_ns\tpriority_queue_hold_ns\tstd::set_hold_ns\tRBTree_drain_ns\tpriority_queue_drain_ns\tstd::set_drain_ns" << std::endl;
+
+  std::mt19937 gen(42);
+  std::exponential_distribution<double> delay(1.0);
+  const std::size_t holds{1<<20};
+  for (std::size_t pending=1<<8; pending<=1<<20; pending<<=2) {
+    std::vector<double> initial(pending), delays(holds);
+    for (double& time : initial) {
+      time = delay(gen)*pending;
+    }
+    for (double& step : delays) {
+      step = delay(gen)*pending; // event times are distinct with overwhelming probability
+    }
+    RBTree<double> tree;
+    std::priority_queue<double, std::vector<double>, std::greater<double>> heap;
+    std::set<double> set;
+    for (const double& time : initial) {
+      tree.insert(time);
+      heap.push(time);
+      set.insert(time);
+    }
+    volatile double sink{0};
+    double tree_hold{measure(holds, [&](std::size_t i) { tree.insert(tree.pop_min()+delays[i]); })};
+    double heap_hold{measure(holds, [&](std::size_t i) {
+      double now{heap.top()};
+      heap.pop();
+      heap.push(now+delays[i]);
+    })};
+    double set_hold{measure(holds, [&](std::size_t i) {
+      double now{*set.begin()};
+      set.erase(set.begin());
+      set.insert(now+delays[i]);
+    })};
+    double tree_drain{measure(pending, [&](std::size_t) { sink = sink+tree.pop_min(); })};
+    double heap_drain{measure(pending, [&](std::size_t) {
+      sink = sink+heap.top();
+      heap.pop();
+    })};
+    double set_drain{measure(pending, [&](std::size_t) {
+      sink = sink+*set.begin();
+      set.erase(set.begin());
+    })};
+    out << pending << "\t" << tree_hold << "\t" << heap_hold << "\t" << set_hold << "\t"
+        << tree_drain << "\t" << heap_drain << "\t" << set_drain << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
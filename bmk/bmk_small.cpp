@@ -0,0 +1,111 @@
+///\file bmk_small.cpp
+///\author mpv
+///\brief Bmk small driver
+/// Small benchmarking experiment on many tiny sets: 2^20 per-user sets of 1 to 15 keys (and a few larger ones),
+/// stored as RBTree's, SmallTree's and std::set's.
+/// Build time, bytes per set (the objects plus their heap), heap allocations per set and lookup time
+/// (a random key in a random set) are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <set>
+#include <vector>
+#include "../include/Small_tree.hpp"
+
+std::size_t allocated{0};   ///< bytes requested from the global heap, minus the bytes given back by sized deletes.
+std::size_t allocations{0}; ///< calls to the global operator new.
+
+void* operator new(std::size_t bytes) {
+  allocated += bytes;
+  ++allocations;
+  if (void* memory = std::malloc(bytes)) {
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {std::free(memory);}
+
+void operator delete(void* memory, std::size_t bytes) noexcept { // the standard allocators free with the size
+  allocated -= bytes;
+  std::free(memory);
+}
+
+
+///\brief function to build one set per user, then measure its memory, allocations and lookups.
+template <typename Set>
+void run(std::ofstream& out, const char* name, const std::vector<std::vector<int>>& users, const std::vector<std::pair<std::size_t, int>>& probes) {
+  const std::size_t bytes_before{allocated}, allocations_before{allocations};
+  std::vector<Set> sets;
+  sets.reserve(users.size());
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const std::vector<int>& keys : users) {
+    sets.emplace_back();
+    for (const int& key : keys) {
+      sets.back().insert(key);
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  const double build(std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count());
+  const double heap(allocated-bytes_before-sets.capacity()*sizeof(Set)), calls(allocations-allocations_before-1);
+  volatile std::size_t sink{0};
+  start = std::chrono::high_resolution_clock::now();
+  for (const auto& [user, key] : probes) {
+    sink = sink+sets[user].count(key);
+  }
+  end = std::chrono::high_resolution_clock::now();
+  const double lookup(std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count());
+  out << name << "\t" << users.size() << "\t" << build/1e6 << "\t" << sizeof(Set)+heap/users.size() << "\t"
+      << calls/users.size() << "\t" << lookup/probes.size() << std::endl;
+}
+
+
+///\brief RBTree with std::set's count(), so that the three containers share run().
+struct RBTreeSet : RBTree<int> {
+  std::size_t count(const int& key) const noexcept {return contains(key);}
+};
+
+///\brief SmallTree with std::set's count() (see: RBTreeSet).
+struct SmallTreeSet : SmallTree<int> {
+  std::size_t count(const int& key) const noexcept {return contains(key);}
+};
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_small.txt");
+  out << "structure\tsets\tbuild_ms\tbytes_per_set\tallocations_per_set\tlookup_ns" << std::endl;
+
+  const std::size_t users{1<<20};
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> keys(0, 1<<20), sizes(1, 15);
+  std::bernoulli_distribution large(0.01);
+  std::vector<std::vector<int>> sets(users);
+  for (std::vector<int>& set : sets) {
+    set.resize(large(gen) ? 64 : sizes(gen)); // 1% of the users outgrow the inline array
+    for (int& key : set) {
+      key = keys(gen);
+    }
+  }
+  std::uniform_int_distribution<std::size_t> user(0, users-1);
+  std::vector<std::pair<std::size_t, int>> probes(1<<22);
+  for (auto& [probed, key] : probes) {
+    probed = user(gen);
+    key = gen()%2 ? sets[probed][gen()%sets[probed].size()] : keys(gen); // a hit, or most likely a miss
+  }
+
+  run<RBTreeSet>(out, "RBTree", sets, probes);
+  run<SmallTreeSet>(out, "SmallTree", sets, probes);
+  run<std::set<int>>(out, "std::set", sets, probes);
+
+  // close output file
+  out.close();
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+///\file bmk_static.cpp
+///\author mpv
+///\brief Bmk static driver
+/// Small benchmarking experiment on a fixed lookup table of 4096 codes: the table is either loaded into a RBTree
+/// at startup or built at compile time as a StaticSet (sorted by the compiler, stored in read-only data).
+/// Startup time, bytes of heap allocated and average lookup time are written to a .txt file.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+#include "../include/RBT.hpp"
+#include "../include/Static_set.hpp"
+
+std::size_t allocated{0}; ///< bytes requested from the global heap.
+
+void* operator new(std::size_t bytes) {
+  allocated += bytes;
+  if (void* memory = std::malloc(bytes)) {
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {std::free(memory);}
+void operator delete(void* memory, std::size_t) noexcept {std::free(memory);}
+
+
+constexpr std::size_t table_size{4096};
+
+///\brief function computing the table at compile time: distinct pseudo-random codes (a full-period LCG modulo 2^32).
+constexpr std::array<std::uint32_t, table_size> make_table() {
+  std::array<std::uint32_t, table_size> table{};
+  std::uint32_t state{12345};
+  for (std::uint32_t& code : table) {
+    state = state*1664525u+1013904223u;
+    code = state;
+  }
+  return table;
+}
+
+constexpr StaticSet<std::uint32_t, table_size> codes{make_table()};
+
+
+///\brief function to measure the average time in nanoseconds of a lookup.
+template <typename Lookup>
+double measure(const std::vector<std::uint32_t>& probes, Lookup lookup) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const std::uint32_t& probe : probes) {
+    lookup(probe);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(probes.size());
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_static.txt");
+  out << "keys\tRBTree_startup_us\tRBTree_heap_bytes\tStaticSet_startup_us\tStaticSet_heap_bytes\tRBTree_lookup_ns\tStaticSet_lookup_ns" << std::endl;
+
+  constexpr std::array<std::uint32_t, table_size> table{make_table()};
+  auto start = std::chrono::high_resolution_clock::now();
+  std::size_t before{allocated};
+  RBTree<std::uint32_t> loaded;
+  for (const std::uint32_t& code : table) {
+    loaded.insert(code);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  std::size_t loaded_bytes{allocated-before};
+  double loaded_startup{std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/1000.0};
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<std::size_t> dis(0, 2*table_size-1);
+  std::vector<std::uint32_t> probes(1<<22);
+  for (std::uint32_t& probe : probes) { // half hits, half misses
+    std::size_t pick{dis(gen)};
+    probe = pick<table_size ? table[pick] : std::uint32_t(gen());
+  }
+  volatile std::size_t sink{0};
+  double loaded_lookup{measure(probes, [&](std::uint32_t probe) { sink = sink+loaded.contains(probe); })};
+  double static_lookup{measure(probes, [&](std::uint32_t probe) { sink = sink+codes.contains(probe); })};
+  out << codes.size() << "\t" << loaded_startup << "\t" << loaded_bytes << "\t" << 0 << "\t" << 0 << "\t"
+      << loaded_lookup << "\t" << static_lookup << std::endl;
+
+  // close output file
+  out.close();
+
+  return 0;
+}
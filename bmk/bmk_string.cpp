@@ -0,0 +1,65 @@
+///\file bmk_string.cpp
+///\author mpv
+///\brief Bmk string driver
+/// Small benchmarking experiment to measure StringTree (inline key prefixes, tails in an arena) against
+/// a RBTree<std::string> on URL-like keys sharing a long common prefix. Lookup times and the bytes
+/// allocated for the keys' characters are written to a .txt file.
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/String_tree.hpp"
+
+///\brief function to measure the average time in nanoseconds of a lookup.
+///\param tree tree to be searched.
+///\param probes strings to be looked up.
+///\return average time in nanoseconds.
+template <typename Tree>
+double measure_find(const Tree& tree, const std::vector<std::string>& probes) {
+  volatile std::size_t sink{0};
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const std::string& probe : probes) {
+    sink = sink+tree.contains(probe);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(probes.size());
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_string.txt");
+  out << "size\tfind_std_string_ns\tfind_string_tree_ns\theap_std_string_bytes\tarena_bytes" << std::endl;
+
+  std::mt19937 gen(42);
+  for (int size=1<<14; size<=1<<20; size<<=2) {
+    std::uniform_int_distribution<> dis(0, 4*size);
+    std::vector<std::string> keys(size), probes(size);
+    for (int i=0; i<size; ++i) {
+      keys[i] = "https://example.com/catalogue/item/" + std::to_string(dis(gen));
+      probes[i] = "https://example.com/catalogue/item/" + std::to_string(dis(gen));
+    }
+    RBTree<std::string> plain;
+    StringTree compact;
+    std::size_t heap_bytes{0};
+    for (const std::string& key : keys) {
+      if (!plain.contains(key)) {
+        plain.insert(key);
+        heap_bytes += key.size()>15 ? key.size()+1 : 0; // beyond libstdc++'s small string buffer
+      }
+      compact.insert(key);
+    }
+    out << size << "\t" << measure_find(plain, probes) << "\t" << measure_find(compact, probes) << "\t"
+        << heap_bytes << "\t" << compact.arena_capacity() << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
@@ -3,7 +3,8 @@ import matplotlib.pyplot as plt
 
 # read the data file and load it into a pandas dataframe
 data = pd.read_csv('bmk_measures_double.txt', sep ='\t')
-data.columns = ['#elements', 'std::map', 'std::unordered_map', 'RedBlackTree']
+series = ['std::map', 'std::unordered_map', 'RBTree']
+labels = ['map', 'unordered_map', 'RBTree']
 
 # plot the three data series
 fig = plt.figure(figsize=(15, 10))
@@ -11,11 +12,24 @@ plt.title('Benchmarking comparison (double)')
 plt.xlabel('# elements to be found')
 plt.ylabel('time (μs)')
 ax = plt.subplot(111)
-ax.plot(data['#elements'], data['std::map'], label = 'map')
-ax.plot(data['#elements'], data['std::unordered_map'], label = 'unordered_map')
-ax.plot(data['#elements'], data['RedBlackTree'], label = 'RBTree')
+for name, label in zip(series, labels):
+    ax.plot(data['elements'], data[name], label = label)
 ax.legend()
 
+# hardware counters per lookup, present if bmk.x was run with --perf (NaN columns are skipped)
+counters = ['cycles', 'instructions', 'l1d_misses', 'llc_misses', 'dtlb_misses', 'branch_misses']
+if series[0] + '_' + counters[0] in data.columns:
+    fig_counters, axes = plt.subplots(2, 3, figsize=(18, 10))
+    fig_counters.suptitle('Hardware counters per lookup (double)')
+    for counter, ax_counter in zip(counters, axes.flat):
+        ax_counter.set_title(counter)
+        ax_counter.set_xlabel('# elements to be found')
+        for name, label in zip(series, labels):
+            column = data[name + '_' + counter]
+            if column.notna().any():
+                ax_counter.plot(data['elements'], column, label = label)
+        ax_counter.legend()
+
 
 if __name__ == '__main__':
-    plt.show()
\ No newline at end of file
+    plt.show()
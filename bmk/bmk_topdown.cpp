@@ -0,0 +1,75 @@
+///\file bmk_topdown.cpp
+///\author mpv
+///\brief Bmk topdown driver
+/// Small benchmarking experiment to compare the parent-pointer-free TopDownRBTree (single-pass top-down
+/// insert and delete) with RBTree (parent pointers, bottom-up fix-ups). The same random keys are inserted,
+/// looked up and deleted in both trees; average times per operation and the bytes of node memory are
+/// written to a .txt file.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/RBT.hpp"
+#include "../include/RBT_topdown.hpp"
+
+///\brief function to measure the average time in nanoseconds of an operation applied to every key.
+///\param keys keys the operation is applied to.
+///\param operation callable invoked as operation(key).
+///\return average time in nanoseconds.
+template <typename Operation>
+double measure(const std::vector<int>& keys, Operation operation) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const int& key : keys) {
+    operation(key);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end-start).count()/double(keys.size());
+}
+
+
+int main() {
+  // output stream and output file
+  std::ofstream out;
+  out.open("../bmk/bmk_measures_topdown.txt");
+  out << "size\tengine\tinsert_ns\tfind_ns\tdelete_ns\tnode_bytes\tmemory_bytes" << std::endl;
+
+  std::mt19937 gen(42);
+  for (int size=1<<12; size<=1<<20; size<<=2) {
+    std::uniform_int_distribution<> dis(1, 1<<30);
+    std::vector<int> keys(size), probes(size);
+    for (int i=0; i<size; ++i) {
+      keys[i] = dis(gen);
+      probes[i] = dis(gen);
+    }
+    std::vector<int> victims{keys}; // every stored key once, in random order
+    std::sort(victims.begin(), victims.end());
+    victims.erase(std::unique(victims.begin(), victims.end()), victims.end());
+    std::shuffle(victims.begin(), victims.end(), gen);
+    volatile std::size_t sink{0};
+
+    RBTree<int> bottom_up;
+    double insert_time{measure(keys, [&](int key) { bottom_up.insert(key); })};
+    double find_time{measure(probes, [&](int key) { sink = sink+bottom_up.contains(key); })};
+    LayoutStats stats{bottom_up.layout_stats()};
+    double delete_time{measure(victims, [&](int key) { bottom_up.delete_(key); })};
+    out << size << "\tbottom_up\t" << insert_time << "\t" << find_time << "\t" << delete_time << "\t"
+        << sizeof(_Node<int>) << "\t" << stats.slots*sizeof(_Node<int>) << std::endl;
+
+    TopDownRBTree<int> top_down;
+    insert_time = measure(keys, [&](int key) { top_down.insert(key); });
+    find_time = measure(probes, [&](int key) { sink = sink+top_down.contains(key); });
+    std::size_t memory{top_down.memory()};
+    delete_time = measure(victims, [&](int key) { top_down.delete_(key); });
+    out << size << "\ttop_down\t" << insert_time << "\t" << find_time << "\t" << delete_time << "\t"
+        << TopDownRBTree<int>::node_size << "\t" << memory << std::endl;
+  }
+
+  // close output file
+  out.close();
+
+  return 0;
+}
@@ -0,0 +1,241 @@
+///\file Adaptive_tree.hpp
+///\author mpv
+///\brief header file with AdaptiveTree, a RBTree whose lookups go through a layout rebuilt from their own frequencies.
+
+#ifndef ADAPTIVE_TREE_HPP
+#define ADAPTIVE_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "RBT.hpp"
+
+
+///\brief AdaptiveTree keeps its keys in a RBTree, for updates and ordered operations, and answers contains/find
+///       through a read-only search tree laid out from the sampled access frequencies: every hit counts one access
+///       to its key, and rebuild() places the keys by weight (Mehlhorn's bisection: each subtree holds at most
+///       half of its parent's weight), so that hot keys sit near the root, in the first cache lines of the array.
+///       Each key weighs its count plus the average count (rounded up): the layout is at most ceil(log2(n))+1 levels
+///       deep, below the Red-Black bound of 2*log2(n+1), while a key of frequency p lies about log2(1/p)+1 levels deep.
+///       Counts are halved at each rebuild, so that the layout follows a drifting distribution.
+///       An insertion or deletion sends lookups back to the RBTree, uncounted, until the next rebuild, done on demand
+///       or once the lookups since the previous one exceed both the period and the number of keys (amortized O(1)).
+///\param T type of the keys.
+///\param CMP relational function to compare keys (default std::less<T>).
+template <class T, class CMP=std::less<T>>
+class AdaptiveTree {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef RBTree<T, CMP> Tree;                                      ///< type of the ordered core.
+  typedef decltype(std::declval<const Tree&>().get_root()) NodePtr; ///< type of pointer to tree's node.
+
+
+  ///\brief Node of the adapted layout: key, children as indices in the layout (0 for none, as the root can't be
+  ///       a child), and the key's rank in order, which indexes its access count.
+  struct _AdaptedNode {
+    T key;                ///< the key.
+    std::uint32_t left;   ///< index of the left child, 0 if none.
+    std::uint32_t right;  ///< index of the right child, 0 if none.
+    std::uint32_t rank;   ///< position of the key in order.
+  };
+
+
+private:
+  Tree tree;                                ///< the keys, in order.
+  std::vector<_AdaptedNode> layout;         ///< the adapted search tree, in pre-order (root first).
+  std::vector<std::uint32_t> counts;        ///< accesses of each key of the layout since the last rebuild, by rank.
+  std::size_t lookups{0};                   ///< lookups since the last rebuild.
+  std::size_t period;                       ///< lookups between two automatic rebuilds, at least.
+  bool adapted{false};                      ///< whether the layout holds the current keys.
+
+
+  ///\brief A recursive helper function to lay out the keys of ranks [low, high) by weight (see: rebuild).
+  ///\param sorted The keys, in order.
+  ///\param prefix Prefix sums of the keys' weights (prefix[i] is the weight of the keys of rank below i).
+  ///\return Index of the subtree's root in the layout, 0 for an empty range.
+  std::uint32_t build(const std::vector<T>& sorted, const std::vector<std::uint64_t>& prefix,
+                      const std::size_t low, const std::size_t high) {
+    if (low==high) {
+      return 0;
+    }
+    const std::uint64_t middle{prefix[low]+(prefix[high]-prefix[low]+1)/2};
+    const std::size_t root(std::lower_bound(prefix.begin()+low+1, prefix.begin()+high+1, middle)-prefix.begin()-1); // first key reaching half the weight
+    const std::uint32_t index(layout.size());
+    layout.push_back(_AdaptedNode{sorted[root], 0, 0, std::uint32_t(root)});
+    const std::uint32_t left{build(sorted, prefix, low, root)};
+    const std::uint32_t right{build(sorted, prefix, root+1, high)};
+    layout[index].left = left;
+    layout[index].right = right;
+    return index;
+  }
+
+
+  ///\brief Helper function to find the layout's node of a key, and count the access.
+  ///\return Pointer to the node, nullptr if the key is not stored.
+  const _AdaptedNode* search(const T& value) noexcept {
+    std::uint32_t index{0};
+    for (;;) {
+      const _AdaptedNode& node{layout[index]};
+      if (tree.comparator(value, node.key)) {
+        index = node.left;
+      } else if (tree.comparator(node.key, value)) {
+        index = node.right;
+      } else {
+        ++counts[node.rank];
+        return &node;
+      }
+      if (index==0) {
+        return nullptr;
+      }
+    }
+  }
+
+
+  ///\brief Helper function to count a lookup, and rebuild once enough of them paid for it.
+  void sample() {
+    if (++lookups>=period and lookups>=tree.size()) {
+      rebuild();
+    }
+  }
+
+
+public:
+  ///\brief AdaptiveTree's constructor.
+  ///\param rebuild_period Lookups between two automatic rebuilds, at least (and at least one per key).
+  ///\param cmp A custom comparison function for keys (defaulted to std::less).
+  explicit AdaptiveTree(const std::size_t rebuild_period=1<<16, CMP cmp=CMP{}): period{rebuild_period} {tree.comparator = cmp;}
+
+
+  ///\brief Function to insert a new key in the tree; lookups use the tree until the next rebuild.
+  ///\param value The value you are going to insert.
+  void insert(const T& value) {
+    if (tree.insert(value)) {
+      adapted = false;
+    }
+  }
+
+
+  ///\brief Function to delete a key from the tree; lookups use the tree until the next rebuild.
+  ///\param value The value you are going to delete.
+  void delete_(const T& value) {
+    if (tree.delete_(value)) { // a missing value is reported by the tree
+      adapted = false;
+    }
+  }
+
+
+  ///\brief Function to test whether a key is stored; a hit on the adapted layout counts as an access.
+  ///       Not const: it samples the frequencies and may rebuild the layout.
+  bool contains(const T& value) {
+    sample();
+    return adapted ? search(value)!=nullptr : tree.contains(value);
+  }
+
+
+  ///\brief Function to find a value (see: contains).
+  ///\return The stored key if present, the key of the tree's NIL otherwise (as RBTree::find).
+  const T& find(const T& value) {
+    sample();
+    if (!adapted) {
+      return tree.find(value);
+    }
+    const _AdaptedNode* node{search(value)};
+    return node!=nullptr ? node->key : tree.get_nil()->data;
+  }
+
+
+  ///\brief Function to lay out the keys by their access counts, in O(n): counts of the keys still stored
+  ///       are carried over (halved), new keys start from zero.
+  void rebuild();
+
+
+  ///\brief Function to compute the depth of a key in the structure lookups go through (root at depth 0).
+  ///\return The depth, or the depth of the leaf where the search ended if the key is not stored.
+  std::size_t depth(const T& value) const noexcept;
+
+
+  ///\brief Whether lookups go through the adapted layout (false after an update, until the next rebuild).
+  bool is_adapted() const noexcept {return adapted;}
+
+  ///\brief Getter for the number of keys.
+  std::size_t size() const noexcept {return tree.size();}
+
+  ///\brief Getter for the memory taken by the layout and its counts, in bytes (the cost over a bare RBTree).
+  std::size_t layout_memory() const noexcept {
+    return layout.capacity()*sizeof(_AdaptedNode)+counts.capacity()*sizeof(std::uint32_t);
+  }
+
+  ///\brief Function to access the underlying RBTree (e.g. for ordered scans).
+  ///\return Const reference to the tree.
+  const Tree& get_tree() const noexcept {return tree;}
+
+};
+
+// --------------------------------IMPLEMENTATION------------------------------------------
+
+template <class T, class CMP>
+void AdaptiveTree<T, CMP>::rebuild() {
+  std::vector<std::pair<T, std::uint32_t>> previous(layout.size()); // the old keys in order, with their counts
+  for (const _AdaptedNode& node : layout) {
+    previous[node.rank] = {node.key, counts[node.rank]};
+  }
+  std::vector<T> sorted;
+  sorted.reserve(tree.size());
+  std::vector<std::uint32_t> carried;
+  carried.reserve(tree.size());
+  std::uint64_t total{0};
+  auto old = previous.begin();
+  tree.visit_inorder([&](const T& key) { // merge the tree's keys with the old ones
+    for (; old!=previous.end() and tree.comparator(old->first, key); ++old) {}
+    const bool kept{old!=previous.end() and !tree.comparator(key, old->first)};
+    sorted.push_back(key);
+    carried.push_back(kept ? old->second : 0);
+    total += carried.back();
+  });
+  const std::uint64_t floor{std::max<std::uint64_t>(1, (total+tree.size()-1)/std::max<std::size_t>(tree.size(), 1))}; // every key weighs at least the average
+  std::vector<std::uint64_t> prefix(sorted.size()+1, 0);
+  for (std::size_t i{0}; i<sorted.size(); ++i) {
+    prefix[i+1] = prefix[i]+carried[i]+floor;
+  }
+  layout.clear();
+  layout.reserve(sorted.size());
+  build(sorted, prefix, 0, sorted.size());
+  counts.assign(sorted.size(), 0);
+  for (std::size_t i{0}; i<sorted.size(); ++i) {
+    counts[i] = carried[i]>>1; // the past weighs half as much at every rebuild
+  }
+  lookups = 0;
+  adapted = !layout.empty();
+}
+
+
+template <class T, class CMP>
+std::size_t AdaptiveTree<T, CMP>::depth(const T& value) const noexcept {
+  std::size_t levels{0};
+  if (adapted) {
+    for (std::uint32_t index{0};; ++levels) {
+      const _AdaptedNode& node{layout[index]};
+      index = tree.comparator(value, node.key) ? node.left : (tree.comparator(node.key, value) ? node.right : 0);
+      if (index==0) {
+        return levels;
+      }
+    }
+  }
+  for (NodePtr node{tree.get_root()}; node!=tree.get_nil() and node!=nullptr; ++levels) {
+    if (!tree.comparator(value, node->data) and !tree.comparator(node->data, value)) {
+      return levels;
+    }
+    node = tree.comparator(value, node->data) ? node->left : node->right;
+    if (node==tree.get_nil()) {
+      return levels;
+    }
+  }
+  return levels;
+}
+
+
+#endif // ADAPTIVE_TREE_HPP
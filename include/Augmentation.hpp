@@ -0,0 +1,118 @@
+///\file Augmentation.hpp
+///\author mpv
+///\brief header file with RBTree's augmentation policies (monoids aggregated over subtrees).
+
+#ifndef AUGMENTATION_HPP
+#define AUGMENTATION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+
+///\brief Default policy: nodes carry no aggregate, the tree pays nothing for it.
+struct NoAugmentation {
+  typedef void value_type; ///< no aggregate at all.
+};
+
+
+///\brief An augmentation policy is a monoid over a node's key and its children's aggregates:
+///       value_type is the aggregate, identity() its neutral element (the aggregate of NIL),
+///       lift(key) the aggregate of a single key and combine(a, b) an associative operation,
+///       where a holds smaller keys than b. The aggregate of a node is
+///       combine(combine(left's aggregate, lift(key)), right's aggregate).
+///\param T type of the tree nodes' keys.
+template <class T>
+struct SumAugmentation {
+  typedef T value_type; ///< sum of the keys.
+  static value_type identity() noexcept {return value_type{};}
+  static value_type lift(const T& key) noexcept {return key;}
+  static value_type combine(const value_type& a, const value_type& b) noexcept {return a+b;}
+};
+
+
+///\brief Counts the keys, making order statistics and range counts O(log n) (see: SumAugmentation).
+template <class T>
+struct CountAugmentation {
+  typedef std::size_t value_type; ///< number of keys.
+  static value_type identity() noexcept {return 0;}
+  static value_type lift(const T&) noexcept {return 1;}
+  static value_type combine(const value_type& a, const value_type& b) noexcept {return a+b;}
+};
+
+
+///\brief Minimum of the keys (see: SumAugmentation). The identity is the largest representable T.
+template <class T>
+struct MinAugmentation {
+  typedef T value_type; ///< smallest key.
+  static value_type identity() noexcept {return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();}
+  static value_type lift(const T& key) noexcept {return key;}
+  static value_type combine(const value_type& a, const value_type& b) noexcept {return std::min(a, b);}
+};
+
+
+///\brief Maximum of the keys (see: SumAugmentation). The identity is the smallest representable T.
+template <class T>
+struct MaxAugmentation {
+  typedef T value_type; ///< largest key.
+  static value_type identity() noexcept {return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();}
+  static value_type lift(const T& key) noexcept {return key;}
+  static value_type combine(const value_type& a, const value_type& b) noexcept {return std::max(a, b);}
+};
+
+
+///\brief Order-independent digest of a set of keys (see: DigestAugmentation).
+struct KeyDigest {
+  std::uint64_t hash{0}; ///< sum, modulo 2^64, of the keys' mixed hashes.
+  std::size_t count{0};  ///< number of keys.
+  bool operator==(const KeyDigest& other) const noexcept {return hash==other.hash and count==other.count;}
+  bool operator!=(const KeyDigest& other) const noexcept {return !(*this==other);}
+};
+
+
+///\brief Digest of the keys of every subtree, so that diff() skips the key ranges two trees agree on (see: RBT_diff.hpp).
+///       Equal digests mean equal key sets, but for a hash collision (about 2^-64 per compared range).
+///\param HASH hash function of the keys (default std::hash<T>), mixed since it is often the identity.
+template <class T, class HASH=std::hash<T>>
+struct DigestAugmentation {
+  typedef KeyDigest value_type; ///< digest of the keys.
+  static value_type identity() noexcept {return KeyDigest{};}
+  static value_type lift(const T& key) noexcept {
+    std::uint64_t mixed{std::uint64_t(HASH{}(key))+0x9e3779b97f4a7c15ull}; // splitmix64 finalizer
+    mixed = (mixed^(mixed>>30))*0xbf58476d1ce4e5b9ull;
+    mixed = (mixed^(mixed>>27))*0x94d049bb133111ebull;
+    return KeyDigest{mixed^(mixed>>31), 1};
+  }
+  static value_type combine(const value_type& a, const value_type& b) noexcept {return KeyDigest{a.hash+b.hash, a.count+b.count};}
+};
+
+
+///\brief Storage of the aggregate inside a RBTree's node (base class of _Node).
+///\param T type of the tree nodes' keys.
+///\param AUG augmentation policy.
+template <class T, class AUG>
+class _Augment {
+public:
+  typename AUG::value_type aggregate; ///< aggregate of the subtree rooted in the node.
+
+  ///\brief Default constructor: empty subtree (used by NIL).
+  _Augment() noexcept: aggregate{AUG::identity()} {}
+
+  ///\brief Constructor for a node holding a single key.
+  ///\param key key of the node.
+  explicit _Augment(const T& key) noexcept: aggregate{AUG::lift(key)} {}
+};
+
+
+///\brief Storage of the aggregate, specialized to an empty base when the tree is not augmented.
+template <class T>
+class _Augment<T, NoAugmentation> {
+public:
+  _Augment() noexcept {}
+  explicit _Augment(const T&) noexcept {}
+};
+
+
+#endif // AUGMENTATION_HPP
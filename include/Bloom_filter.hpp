@@ -0,0 +1,198 @@
+///\file Bloom_filter.hpp
+///\author mpv
+///\brief header file with a blocked Bloom filter and FilteredTree, a RBTree answering definite misses without a search.
+
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "RBT.hpp"
+
+
+///\brief Split block Bloom filter: each key sets one bit in each of the 8 words of a single 32-byte block,
+///       so that adding or testing a key touches one cache line whatever the number of keys.
+///       With 16 bits per key the false positive rate is about 0.5%. Keys cannot be removed (see: FilteredTree).
+///\param T type of the keys.
+///\param HASH hash function of the keys (default std::hash<T>), mixed since it is often the identity.
+template <class T, class HASH=std::hash<T>>
+class BlockedBloomFilter {
+
+  ///\brief One block: 8 words of 32 bits, aligned to stay within a cache line.
+  struct alignas(32) _Block {
+    std::uint32_t words[8]{};
+  };
+
+
+private:
+  std::vector<_Block> blocks; ///< the bits, at least one block.
+  HASH hasher;                ///< hash function of the keys.
+
+
+  ///\brief Helper function to hash a key to 64 well mixed bits (splitmix64 finalizer).
+  std::uint64_t hash(const T& key) const noexcept {
+    std::uint64_t mixed{std::uint64_t(hasher(key))+0x9e3779b97f4a7c15ull};
+    mixed = (mixed^(mixed>>30))*0xbf58476d1ce4e5b9ull;
+    mixed = (mixed^(mixed>>27))*0x94d049bb133111ebull;
+    return mixed^(mixed>>31);
+  }
+
+
+  ///\brief Helper function to pick the block of a hash: the high 32 bits scaled to the number of blocks.
+  std::size_t block_of(const std::uint64_t hashed) const noexcept {
+    return std::size_t(((hashed>>32)*blocks.size())>>32);
+  }
+
+
+  ///\brief Helper function to compute the bit set in word i by a hash (odd multipliers, one per word).
+  static std::uint32_t bit(const std::uint32_t low, const int i) noexcept {
+    static constexpr std::uint32_t salts[8]{0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+                                            0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+    return std::uint32_t{1}<<((low*salts[i])>>27);
+  }
+
+
+public:
+  static constexpr std::size_t bits_per_key{16}; ///< sizing of the filter (see: reset).
+
+
+  ///\brief BlockedBloomFilter's constructor.
+  ///\param keys Number of keys the filter is sized for.
+  explicit BlockedBloomFilter(const std::size_t keys=0) {reset(keys);}
+
+
+  ///\brief Function to empty the filter and size it for a number of keys.
+  void reset(const std::size_t keys) {
+    blocks.assign(keys*bits_per_key/256+1, _Block{});
+  }
+
+
+  ///\brief Function to add a key, in O(1).
+  void add(const T& key) noexcept {
+    const std::uint64_t hashed{hash(key)};
+    _Block& block{blocks[block_of(hashed)]};
+    for (int i{0}; i<8; ++i) {
+      block.words[i] |= bit(std::uint32_t(hashed), i);
+    }
+  }
+
+
+  ///\brief Function to test a key, in O(1).
+  ///\return Bool false if the key was never added, true if it may have been.
+  bool may_contain(const T& key) const noexcept {
+    const std::uint64_t hashed{hash(key)};
+    const _Block& block{blocks[block_of(hashed)]};
+    bool present{true};
+    for (int i{0}; i<8; ++i) { // no early exit: the 8 tests are independent, and cheaper than a mispredicted branch
+      present &= (block.words[i] & bit(std::uint32_t(hashed), i))!=0;
+    }
+    return present;
+  }
+
+
+  ///\brief Getter for the number of keys the filter is sized for.
+  std::size_t capacity() const noexcept {return blocks.size()*256/bits_per_key;}
+
+  ///\brief Getter for the memory taken by the bits, in bytes.
+  std::size_t memory() const noexcept {return blocks.size()*sizeof(_Block);}
+
+};
+
+
+///\brief FilteredTree is a RBTree with a blocked Bloom filter in front of it, kept up to date by insert and delete_:
+///       a value the filter has never seen is reported missing in O(1), without walking the tree's height.
+///       Deleted keys stay in the filter until it is rebuilt from the tree, which happens when the stale keys
+///       reach half of the live ones, or when the keys outgrow the filter (then resized for twice as many).
+///\param T type of the keys.
+///\param CMP relational function to compare keys (default std::less<T>).
+///\param HASH hash function of the keys, consistent with CMP's equivalence (default std::hash<T>).
+template <class T, class CMP=std::less<T>, class HASH=std::hash<T>>
+class FilteredTree {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef RBTree<T, CMP> Tree;                   ///< type of the tree.
+  typedef BlockedBloomFilter<T, HASH> Filter;    ///< type of the filter.
+
+
+private:
+  Tree tree;                 ///< the keys.
+  Filter filter;             ///< every live key, plus the stale ones deleted since the last rebuild.
+  std::size_t stale{0};      ///< keys deleted from the tree but still in the filter.
+
+
+  ///\brief Helper function to refill the filter from the tree, sized for twice the keys, in O(n).
+  void rebuild() {
+    filter.reset(2*tree.size());
+    tree.visit_inorder([this](const T& key) { filter.add(key); });
+    stale = 0;
+  }
+
+
+public:
+  ///\brief FilteredTree's constructor.
+  ///\param cmp A custom comparison function for keys (defaulted to std::less).
+  explicit FilteredTree(CMP cmp=CMP{}) {tree.comparator = cmp;}
+
+
+  ///\brief Function to insert a new key (the tree's insertion tells whether it was stored already).
+  ///\param value The value you are going to insert.
+  void insert(const T& value) {
+    if (!tree.insert(value)) {
+      return; // already stored
+    }
+    if (tree.size()+stale>filter.capacity()) { // too full: the false positive rate would climb
+      rebuild();
+    } else {
+      filter.add(value);
+    }
+  }
+
+
+  ///\brief Function to delete a key: a definite miss of the filter costs no search.
+  ///\param value The value you are going to delete.
+  void delete_(const T& value) {
+    if (!filter.may_contain(value)) {
+      if constexpr (_is_printable<T>::value) { // records need no operator<<
+        std::cout << "Value " << value << " not found" << std::endl;
+      }
+      return;
+    }
+    if (!tree.delete_(value)) { // a false positive, reported by the tree
+      return;
+    }
+    if (++stale>tree.size()/2 and stale>=64) { // many bits set for nothing: purge them
+      rebuild();
+    }
+  }
+
+
+  ///\brief Function to test whether the tree contains a value: O(1) when the filter rules it out.
+  bool contains(const T& value) const noexcept {
+    return filter.may_contain(value) and tree.contains(value);
+  }
+
+
+  ///\brief Function to find a value (see: RBTree::find).
+  ///\return The stored key if present, the key of the tree's NIL otherwise.
+  const T& find(const T& value) const noexcept {
+    return filter.may_contain(value) ? tree.find(value) : tree.get_nil()->data;
+  }
+
+
+  ///\brief Getter for the number of keys.
+  std::size_t size() const noexcept {return tree.size();}
+
+  ///\brief Getter for the memory taken by the filter, in bytes (the cost over a bare RBTree).
+  std::size_t filter_memory() const noexcept {return filter.memory();}
+
+  ///\brief Function to access the underlying RBTree (e.g. to iterate over the keys).
+  ///\return Const reference to the tree.
+  const Tree& get_tree() const noexcept {return tree;}
+
+};
+
+
+#endif // BLOOM_FILTER_HPP
@@ -0,0 +1,197 @@
+///\file Counted_multiset.hpp
+///\author mpv
+///\brief header file with a multiset built on RBTree's balancing core, one node per distinct key with its count.
+
+#ifndef COUNTED_MULTISET_HPP
+#define COUNTED_MULTISET_HPP
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <type_traits>
+#include "RBT.hpp"
+
+
+///\brief Distinct key of a CountedMultiset, with its number of occurrences.
+template <class T>
+struct Counted {
+  T key;                 ///< the key (compared).
+  std::size_t count{0};  ///< occurrences of the key (not compared).
+};
+
+
+///\brief Prints a counted key as key(xcount) (used by RBTree's print functions).
+template <class T>
+std::ostream& operator<<(std::ostream& os, const Counted<T>& counted) {
+  return os << counted.key << "(x" << counted.count << ")";
+}
+
+
+///\brief Orders counted keys by key only, so that a count can change without moving its node.
+template <class T, class CMP>
+struct CountedOrder {
+  CMP comparator; ///< comparison of the keys.
+  bool operator()(const Counted<T>& a, const Counted<T>& b) const noexcept {return comparator(a.key, b.key);}
+};
+
+
+///\brief Augmentation policy summing the occurrences of every subtree (see: Augmentation.hpp).
+template <class T>
+struct OccurrenceAugmentation {
+  typedef std::size_t value_type; ///< occurrences in the subtree, duplicates included.
+  static value_type identity() noexcept {return 0;}
+  static value_type lift(const Counted<T>& counted) noexcept {return counted.count;}
+  static value_type combine(const value_type& a, const value_type& b) noexcept {return a+b;}
+};
+
+
+///\brief CountedMultiset stores a multiset in a RBTree holding one node per distinct key, with its count:
+///       memory grows with the distinct keys only, however many times each one repeats.
+///       Nodes also carry the occurrences of their subtree, so that rank queries count duplicates in O(log n).
+///\param T type of the keys.
+///\param CMP relational function to compare keys (default std::less<T>).
+template <class T, class CMP=std::less<T>>
+class CountedMultiset {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef Counted<T> counted_type;                                                ///< type of the stored nodes' keys.
+  typedef RBTree<counted_type, CountedOrder<T, CMP>, OccurrenceAugmentation<T>> Tree; ///< type of the balancing core.
+
+
+private:
+  Tree tree;                ///< distinct keys with their counts, ordered by key.
+  std::size_t distinct{0};  ///< number of nodes.
+
+
+  ///\brief Invokes a visitor returning void or bool (see: for_each).
+  ///\return Bool false if f asks to stop the visit.
+  template <class F, class... Args>
+  static bool call_visitor(F& f, const Args&... args) {
+    if constexpr (std::is_same<decltype(f(args...)), bool>::value) {
+      return f(args...);
+    } else {
+      f(args...);
+      return true;
+    }
+  }
+
+
+public:
+  ///\brief CountedMultiset's constructor.
+  ///\param cmp A custom comparison function for keys (defaulted to std::less).
+  explicit CountedMultiset(CMP cmp=CMP{}) {tree.comparator = CountedOrder<T, CMP>{cmp};}
+
+
+  ///\brief Function to add occurrences of a key, in O(log n).
+  ///\param key The key you are going to insert.
+  ///\param n Occurrences added (default 1).
+  void insert(const T& key, const std::size_t n=1) {
+    if (n==0) {
+      return;
+    }
+    if (!tree.modify(counted_type{key}, [n](counted_type& counted) { counted.count += n; })) {
+      tree.insert(counted_type{key, n});
+      ++distinct;
+    }
+  }
+
+
+  ///\brief Function to remove one occurrence of a key, in O(log n).
+  ///\param key The key you are going to remove.
+  ///\return Bool true if the key was present.
+  bool erase_one(const T& key) noexcept {
+    bool last{false};
+    if (!tree.modify(counted_type{key}, [&last](counted_type& counted) { last = --counted.count==0; })) {
+      return false;
+    }
+    if (last) { // no occurrence left: the node goes away
+      tree.delete_(counted_type{key});
+      --distinct;
+    }
+    return true;
+  }
+
+
+  ///\brief Function to remove every occurrence of a key, in O(log n).
+  ///\param key The key you are going to remove.
+  ///\return The number of occurrences removed.
+  std::size_t erase_all(const T& key) noexcept {
+    std::size_t removed{count(key)};
+    if (removed>0) {
+      tree.delete_(counted_type{key});
+      --distinct;
+    }
+    return removed;
+  }
+
+
+  ///\brief Function to count the occurrences of a key, in O(log n).
+  ///\param key The key to be counted.
+  ///\return The occurrences of key, 0 if absent.
+  std::size_t count(const T& key) const noexcept {
+    const counted_type probe{key};
+    return tree.contains(probe) ? tree.find(probe).count : 0;
+  }
+
+
+  ///\brief Function to test whether a key occurs at least once.
+  bool contains(const T& key) const noexcept {return tree.contains(counted_type{key});}
+
+
+  ///\brief Function to count the occurrences of the keys smaller than key (duplicates included), in O(log n).
+  ///\param key The key whose rank is computed (it need not be stored).
+  ///\return The position the first occurrence of key has, or would have, in the expanded sorted sequence.
+  std::size_t rank(const T& key) const noexcept {
+    std::size_t smaller{0};
+    auto node{tree.get_root()};
+    while (node!=tree.get_nil() and node!=nullptr) {
+      if (tree.comparator.comparator(node->data.key, key)) { // node and its left subtree are smaller
+        smaller += node->left->aggregate+node->data.count;
+        node = node->right;
+      } else {
+        node = node->left;
+      }
+    }
+    return smaller;
+  }
+
+
+  ///\brief Function to visit the keys in order, each one as many times as it occurs.
+  ///\param f Callable invoked as f(key); returning false stops the visit.
+  ///\return Bool false if the visit has been stopped by f.
+  template <class F>
+  bool for_each(F f) const {
+    return tree.visit_inorder([&f](const counted_type& counted) {
+      for (std::size_t i{0}; i<counted.count; ++i) {
+        if (!call_visitor(f, counted.key)) {
+          return false;
+        }
+      }
+      return true;
+    });
+  }
+
+
+  ///\brief Function to visit the distinct keys in order, once each, with their counts.
+  ///\param f Callable invoked as f(key, count); returning false stops the visit.
+  ///\return Bool false if the visit has been stopped by f.
+  template <class F>
+  bool for_each_distinct(F f) const {
+    return tree.visit_inorder([&f](const counted_type& counted) { return call_visitor(f, counted.key, counted.count); });
+  }
+
+
+  ///\brief Getter for the number of occurrences stored (duplicates included), in O(1).
+  std::size_t size() const noexcept {return tree.aggregate();}
+
+  ///\brief Getter for the number of distinct keys (nodes).
+  std::size_t distinct_size() const noexcept {return distinct;}
+
+  ///\brief Function to access the underlying RBTree (e.g. to print it).
+  ///\return Const reference to the balancing core.
+  const Tree& get_tree() const noexcept {return tree;}
+
+};
+
+
+#endif // COUNTED_MULTISET_HPP
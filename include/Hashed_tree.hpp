@@ -0,0 +1,271 @@
+///\file Hashed_tree.hpp
+///\author mpv
+///\brief header file with HashedTree, a RBTree paired with an open-addressing hash index from keys to nodes.
+
+#ifndef HASHED_TREE_HPP
+#define HASHED_TREE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "RBT.hpp"
+
+
+///\brief HashedTree keeps its keys in a RBTree, for ordered operations, and indexes the tree's nodes in a hash table,
+///       for point lookups in O(1) on average. The table uses linear probing over a power-of-two number of slots,
+///       each holding a node pointer and the key's full hash, so that a probe only reads the node on a hash match;
+///       it grows at 3/4 load and deletes by backward shifting (no tombstones).
+///       insert and delete_ update both structures; compact and bulk_load, which relocate the nodes, re-index them.
+///\param T type of the keys.
+///\param CMP relational function to compare keys (default std::less<T>).
+///\param HASH hash function of the keys, consistent with CMP's equivalence (default std::hash<T>).
+template <class T, class CMP=std::less<T>, class HASH=std::hash<T>>
+class HashedTree {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef RBTree<T, CMP> Tree;                                      ///< type of the ordered core.
+  typedef decltype(std::declval<const Tree&>().get_root()) NodePtr; ///< type of pointer to tree's node.
+
+
+  ///\brief Slot of the hash index, empty when node is nullptr.
+  struct _Slot {
+    NodePtr node{nullptr};   ///< node holding the key.
+    std::uint64_t hash{0};   ///< full hash of the key, compared before the key itself.
+  };
+
+
+private:
+  Tree tree;                ///< the keys, in order.
+  std::vector<_Slot> slots; ///< the hash index, a power of two of slots.
+  std::size_t keys{0};      ///< number of keys.
+  HASH hasher;              ///< hash function of the keys.
+
+
+  ///\brief Helper function to hash a key to 64 well mixed bits (splitmix64 finalizer).
+  std::uint64_t hash(const T& key) const noexcept {
+    std::uint64_t mixed{std::uint64_t(hasher(key))+0x9e3779b97f4a7c15ull};
+    mixed = (mixed^(mixed>>30))*0xbf58476d1ce4e5b9ull;
+    mixed = (mixed^(mixed>>27))*0x94d049bb133111ebull;
+    return mixed^(mixed>>31);
+  }
+
+
+  ///\brief Helper function to find the slot of a key, or the empty slot ending its probe sequence.
+  std::size_t probe(const T& value, const std::uint64_t hashed) const noexcept {
+    const std::size_t mask{slots.size()-1};
+    std::size_t slot{std::size_t(hashed)&mask};
+    while (slots[slot].node!=nullptr and (slots[slot].hash!=hashed or !equivalent(slots[slot].node->data, value))) {
+      slot = (slot+1)&mask;
+    }
+    return slot;
+  }
+
+
+  ///\brief Helper function to test whether two keys are equivalent for the tree's comparator.
+  bool equivalent(const T& a, const T& b) const noexcept {return !tree.comparator(a, b) and !tree.comparator(b, a);}
+
+
+  ///\brief Helper function to index a node whose key is not indexed yet (no resize).
+  void place(const NodePtr& node) noexcept {
+    const std::uint64_t hashed{hash(node->data)};
+    const std::size_t mask{slots.size()-1};
+    std::size_t slot{std::size_t(hashed)&mask};
+    while (slots[slot].node!=nullptr) {
+      slot = (slot+1)&mask;
+    }
+    slots[slot] = _Slot{node, hashed};
+  }
+
+
+  ///\brief Helper function to empty a slot, shifting back the following entries of the cluster that may move.
+  void erase_slot(std::size_t slot) noexcept {
+    const std::size_t mask{slots.size()-1};
+    for (std::size_t next{(slot+1)&mask}; slots[next].node!=nullptr; next = (next+1)&mask) {
+      const std::size_t home{std::size_t(slots[next].hash)&mask};
+      if (((next-home)&mask)>=((next-slot)&mask)) { // the hole lies on next's probe path: fill it
+        slots[slot] = slots[next];
+        slot = next;
+      }
+    }
+    slots[slot] = _Slot{};
+  }
+
+
+  ///\brief Helper function to find the node of a stored key by a tree search (the index does not know it yet).
+  NodePtr node_of(const T& value) const noexcept {
+    NodePtr node{tree.get_root()};
+    while (tree.comparator(value, node->data) or tree.comparator(node->data, value)) {
+      node = tree.comparator(value, node->data) ? node->left : node->right;
+    }
+    return node;
+  }
+
+
+  ///\brief Helper function to rebuild the index from the tree's nodes, e.g. after they moved, in O(n).
+  ///\param capacity Number of slots, a power of two above 4/3 of the keys.
+  void reindex(const std::size_t capacity) {
+    slots.assign(capacity, _Slot{});
+    std::vector<NodePtr> stack;
+    if (keys>0) {
+      stack.push_back(tree.get_root());
+    }
+    while (!stack.empty()) {
+      NodePtr node{stack.back()};
+      stack.pop_back();
+      place(node);
+      for (const NodePtr& child : {node->left, node->right}) {
+        if (child!=tree.get_nil() and child!=nullptr) {
+          stack.push_back(child);
+        }
+      }
+    }
+  }
+
+
+  ///\brief Helper function to compute the number of slots fitting a number of keys at most 3/4 load.
+  static std::size_t capacity_for(const std::size_t count) noexcept {
+    std::size_t capacity{16};
+    while (count*4>capacity*3) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+
+public:
+  ///\brief HashedTree's constructor.
+  ///\param cmp A custom comparison function for keys (defaulted to std::less).
+  explicit HashedTree(CMP cmp=CMP{}): slots(16) {tree.comparator = cmp;}
+
+
+  ///\brief Copy constructor: the tree is deep copied, then its own nodes are indexed (the source's slots
+  ///       point to the source's nodes).
+  HashedTree(const HashedTree& other): tree{other.tree}, keys{other.keys}, hasher{other.hasher} {
+    reindex(capacity_for(keys));
+  }
+
+
+  ///\brief Copy assignment (copy and swap).
+  HashedTree& operator=(const HashedTree& other) {
+    if (this!=&other) {
+      HashedTree copied{other};
+      swap(copied);
+    }
+    return *this;
+  }
+
+
+  ///\brief Move constructor: the nodes change owner together with their index; the moved tree is left empty,
+  ///       without slots until its next insertion (nothing is allocated).
+  HashedTree(HashedTree&& other) noexcept: tree{std::move(other.tree)}, slots{std::move(other.slots)}, keys{other.keys}, hasher{other.hasher} {
+    other.slots.clear();
+    other.keys = 0;
+  }
+
+
+  ///\brief Move assignment (see: swap).
+  HashedTree& operator=(HashedTree&& other) noexcept {
+    if (this!=&other) {
+      swap(other);
+    }
+    return *this;
+  }
+
+
+  ///\brief Function to exchange the content of two trees, indexes included (the nodes do not move).
+  void swap(HashedTree& other) noexcept {
+    using std::swap;
+    swap(tree, other.tree);
+    swap(slots, other.slots);
+    swap(keys, other.keys);
+    swap(hasher, other.hasher);
+  }
+
+
+  ///\brief Function to insert a new key in both the tree and the index.
+  ///\param value The value you are going to insert.
+  void insert(const T& value) {
+    if (contains(value)) {
+      return;
+    }
+    if (slots.empty()) { // moved-from
+      slots.assign(16, _Slot{});
+    }
+    tree.insert(value);
+    if (++keys*4>slots.size()*3) { // too full: probe sequences would lengthen
+      reindex(slots.size()*2);
+    } else {
+      place(node_of(value));
+    }
+  }
+
+
+  ///\brief Function to delete a key from both the tree and the index.
+  ///\param value The value you are going to delete.
+  void delete_(const T& value) {
+    const std::size_t slot{keys>0 ? probe(value, hash(value)) : 0};
+    if (keys==0 or slots[slot].node==nullptr) {
+      if constexpr (_is_printable<T>::value) { // records need no operator<<
+        std::cout << "Value " << value << " not found" << std::endl;
+      }
+      return;
+    }
+    erase_slot(slot);
+    tree.delete_(value); // deletion relinks nodes, it never moves a key to another node: the index stays valid
+    --keys;
+  }
+
+
+  ///\brief Function to test whether a key is stored, in O(1) on average (through the index).
+  bool contains(const T& value) const noexcept {
+    return keys>0 and slots[probe(value, hash(value))].node!=nullptr; // a moved-from tree has no slot
+  }
+
+
+  ///\brief Function to find a value, in O(1) on average (through the index).
+  ///\return The stored key if present, the key of the tree's NIL otherwise (as RBTree::find).
+  const T& find(const T& value) const noexcept {
+    const NodePtr node{keys>0 ? slots[probe(value, hash(value))].node : nullptr};
+    return node!=nullptr ? node->data : tree.get_nil()->data;
+  }
+
+
+  ///\brief Function to find the first key not smaller than value, in O(log n) (through the tree).
+  typename Tree::const_iterator lower_bound(const T& value) const noexcept {return tree.lower_bound(value);}
+
+
+  ///\brief Function to insert many keys at once (see: RBTree::bulk_load); the relocated nodes are re-indexed.
+  template <class InputIt>
+  void bulk_load(InputIt first, InputIt last) {
+    tree.bulk_load(first, last);
+    keys = 0;
+    tree.visit_inorder([this](const T&) { ++keys; });
+    reindex(capacity_for(keys));
+  }
+
+
+  ///\brief Function to relocate the tree's nodes (see: RBTree::compact); the index follows them.
+  ///\param layout The order of the nodes in memory.
+  void compact(const Layout layout=IN_ORDER) {
+    tree.compact(layout);
+    reindex(capacity_for(keys));
+  }
+
+
+  ///\brief Getter for the number of keys.
+  std::size_t size() const noexcept {return keys;}
+
+  ///\brief Getter for the memory taken by the index, in bytes (the cost over a bare RBTree).
+  std::size_t index_memory() const noexcept {return slots.size()*sizeof(_Slot);}
+
+  ///\brief Function to access the underlying RBTree (e.g. for ordered scans).
+  ///\return Const reference to the tree.
+  const Tree& get_tree() const noexcept {return tree;}
+
+};
+
+
+#endif // HASHED_TREE_HPP
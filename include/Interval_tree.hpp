@@ -0,0 +1,161 @@
+///\file Interval_tree.hpp
+///\author mpv
+///\brief header file with an interval tree built on RBTree's balancing core (max-end augmentation).
+
+#ifndef INTERVAL_TREE_HPP
+#define INTERVAL_TREE_HPP
+
+#include <iostream>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "RBT.hpp"
+
+
+///\brief Closed interval [low, high] of points of type P.
+template <class P>
+struct Interval {
+  P low;  ///< start point (key of the interval tree).
+  P high; ///< end point, not smaller than low.
+
+  bool operator==(const Interval& other) const noexcept {return low==other.low and high==other.high;}
+  bool operator!=(const Interval& other) const noexcept {return !(*this==other);}
+};
+
+
+///\brief Prints an interval as [low, high] (used by RBTree's print functions).
+template <class P>
+std::ostream& operator<<(std::ostream& os, const Interval<P>& interval) {
+  return os << "[" << interval.low << ", " << interval.high << "]";
+}
+
+
+///\brief Orders intervals by start point, then by end point (so that equal starts can coexist).
+template <class P>
+struct IntervalOrder {
+  bool operator()(const Interval<P>& a, const Interval<P>& b) const noexcept {
+    return a.low<b.low or (!(b.low<a.low) and a.high<b.high);
+  }
+};
+
+
+///\brief Augmentation policy keeping the maximum end point of every subtree (see: Augmentation.hpp).
+template <class P>
+struct MaxEndAugmentation {
+  typedef P value_type; ///< largest end point in the subtree.
+  static value_type identity() noexcept {return std::numeric_limits<P>::has_infinity ? -std::numeric_limits<P>::infinity() : std::numeric_limits<P>::lowest();}
+  static value_type lift(const Interval<P>& interval) noexcept {return interval.high;}
+  static value_type combine(const value_type& a, const value_type& b) noexcept {return a<b ? b : a;}
+};
+
+
+///\brief IntervalTree stores closed intervals in a RBTree keyed by start point, whose nodes also carry
+///       the maximum end point of their subtree. A subtree whose maximum end lies before a query, or whose
+///       root starts after it, is skipped entirely: overlap and stabbing queries reporting k intervals cost
+///       O(min(n, (k+1) log n)), each reported interval costing a descent at most (as CLRS, 14.3). The bound is
+///       reached, e.g., by k long intervals spread among many short ones; O(log n + k) would need a centered
+///       interval tree.
+///\param P type of the intervals' points.
+template <class P>
+class IntervalTree {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef Interval<P> interval_type;                                           ///< type of the stored intervals.
+  typedef RBTree<interval_type, IntervalOrder<P>, MaxEndAugmentation<P>> Tree; ///< type of the balancing core.
+  typedef decltype(std::declval<const Tree&>().get_root()) NodePtr;            ///< type of pointer to tree's node.
+
+
+private:
+  Tree tree; ///< intervals, ordered by (low, high), each node knowing its subtree's max end.
+
+
+  ///\brief A recursive helper function to visit the intervals overlapping [low, high] (see: for_each_overlap).
+  ///\param node The starting node for exploring the tree, typically its root.
+  ///\param low The start of the query range.
+  ///\param high The end of the query range.
+  ///\param f Callable invoked as f(interval) on each overlapping interval, in start order.
+  template <class F>
+  void recursive_overlap(const NodePtr& node, const P& low, const P& high, F& f) const {
+    if (node==tree.get_nil() or node->aggregate<low) { // every interval of the subtree ends before low
+      return;
+    }
+    recursive_overlap(node->left, low, high, f);
+    if (high<node->data.low) { // node and its right subtree start after high
+      return;
+    }
+    if (!(node->data.high<low)) {
+      f(node->data);
+    }
+    recursive_overlap(node->right, low, high, f);
+  }
+
+
+public:
+  ///\brief Function to insert a new interval (identical intervals are stored once).
+  ///\param interval The interval you are going to insert, with low <= high.
+  void insert(const interval_type& interval) noexcept {
+    tree.insert(interval);
+  }
+
+
+  ///\brief Function to delete an interval.
+  ///\param interval The interval you are going to delete.
+  void delete_(const interval_type& interval) noexcept {
+    tree.delete_(interval);
+  }
+
+
+  ///\brief Function to test whether the tree contains an interval.
+  ///\param interval The interval to be checked.
+  ///\return Bool true if the very same interval is stored.
+  bool contains(const interval_type& interval) const noexcept {
+    return tree.contains(interval);
+  }
+
+
+  ///\brief Function to visit every stored interval overlapping [low, high], in O(min(n, (k+1) log n)) for k of them.
+  ///\param low The start of the query range.
+  ///\param high The end of the query range.
+  ///\param f Callable invoked as f(interval), following the intervals' start order.
+  template <class F>
+  void for_each_overlap(const P& low, const P& high, F f) const {
+    recursive_overlap(tree.get_root(), low, high, f);
+  }
+
+
+  ///\brief Function to collect the stored intervals overlapping [low, high] (see: for_each_overlap).
+  ///\param low The start of the query range.
+  ///\param high The end of the query range.
+  ///\return The overlapping intervals, in start order.
+  std::vector<interval_type> overlapping(const P& low, const P& high) const {
+    std::vector<interval_type> result;
+    for_each_overlap(low, high, [&result](const interval_type& interval) { result.push_back(interval); });
+    return result;
+  }
+
+
+  ///\brief Function to collect the stored intervals containing a point (stabbing query).
+  ///\param point The point to be stabbed.
+  ///\return The intervals containing point, in start order.
+  std::vector<interval_type> stabbing(const P& point) const {
+    return overlapping(point, point);
+  }
+
+
+  ///\brief Function to get the largest end point among the stored intervals, in O(1).
+  ///\return The maximum end point (lowest P if the tree is empty).
+  P max_end() const noexcept {
+    return tree.aggregate();
+  }
+
+
+  ///\brief Function to access the underlying RBTree (e.g. to iterate or print it).
+  ///\return Const reference to the balancing core.
+  const Tree& get_tree() const noexcept {
+    return tree;
+  }
+
+};
+
+
+#endif // INTERVAL_TREE_HPP
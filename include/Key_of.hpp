@@ -0,0 +1,63 @@
+///\file Key_of.hpp
+///\author mpv
+///\brief header file with key projections, to keep records in a RBTree ordered by one of their fields.
+
+#ifndef KEY_OF_HPP
+#define KEY_OF_HPP
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include "RBT.hpp"
+
+
+///\brief Projection reading a data member of a record, e.g. KeyMember<&Account::id>.
+///       Only records have the member: other types are left to the comparator as they are (see: KeyCompare).
+///\param Member Pointer to the data member holding the key.
+template <auto Member>
+struct KeyMember {
+  template <class Record>
+  constexpr auto operator()(const Record& record) const noexcept -> decltype((record.*Member)) {return record.*Member;}
+};
+
+
+///\brief Comparator of records on a projected key: both sides go through KEYOF when it applies to them,
+///       otherwise they are taken as keys already. It is transparent, so that a RBTree using it offers
+///       contains(key), find(key), lower_bound(key) and delete_(key) without building a record.
+///\param KEYOF Projection from a record to its key (e.g. KeyMember), default constructible or set through RBTree::comparator.
+///\param CMP relational function to compare keys (default std::less<>).
+template <class KEYOF, class CMP=std::less<>>
+struct KeyCompare {
+  typedef void is_transparent; ///< heterogeneous lookups are allowed (see: RBTree::contains).
+
+  KEYOF key_of; ///< the projection.
+  CMP less;     ///< order of the keys.
+
+
+  ///\brief Comparison of two records, a record and a key, or a key and a record.
+  template <class A, class B>
+  bool operator()(const A& a, const B& b) const {return less(project(a), project(b));}
+
+
+private:
+  ///\brief Helper function to get the key of a record, or a key itself, without copying it (for a member).
+  template <class X>
+  decltype(auto) project(const X& x) const {
+    if constexpr (std::is_invocable<const KEYOF&, const X&>::value) {
+      return key_of(x);
+    } else {
+      return (x);
+    }
+  }
+};
+
+
+///\brief RBTree of records ordered by the key KEYOF projects them to, searched by that key alone.
+///\param T type of the records.
+///\param KEYOF Projection from a record to its key (e.g. KeyMember<&T::id>).
+///\param CMP relational function to compare keys (default std::less<>).
+template <class T, class KEYOF, class CMP=std::less<>, class AUG=NoAugmentation, class ALLOC=std::allocator<T>>
+using KeyedRBTree = RBTree<T, KeyCompare<KEYOF, CMP>, AUG, ALLOC>;
+
+
+#endif // KEY_OF_HPP
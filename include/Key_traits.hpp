@@ -0,0 +1,120 @@
+///\file Key_traits.hpp
+///\author mpv
+///\brief header file with the compile-time helpers of RBTree's arithmetic keys (order-preserving encoding, radix sort).
+
+#ifndef KEY_TRAITS_HPP
+#define KEY_TRAITS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+
+///\brief Order-preserving encoding of an arithmetic key into an unsigned integer of the same size:
+///       a<b (std::less) implies encode(a)<encode(b), so keys can be compared and radix-sorted as integers.
+///       Signed integers get their sign bit flipped; floating-point keys are read as bits, negative ones
+///       having every bit flipped and positive ones the sign bit only (-0.0 is encoded as +0.0).
+///\param T type of the keys.
+template <class T>
+struct _OrderedKey {
+  static constexpr bool floating{std::is_floating_point<T>::value}; ///< whether keys are read as bits.
+
+  ///\brief Whether T has an encoding: integers but bool, float and double.
+  static constexpr bool supported{(std::is_integral<T>::value and !std::is_same<T, bool>::value)
+                                  or (floating and (sizeof(T)==4 or sizeof(T)==8))};
+
+  ///\brief T if it is an integer, a placeholder otherwise (so that unsupported types still compile).
+  typedef typename std::conditional<std::is_integral<T>::value and !std::is_same<T, bool>::value, T, int>::type integer_type;
+
+  ///\brief Type of the encoded keys.
+  typedef typename std::conditional<floating, std::conditional<sizeof(T)==4, std::uint32_t, std::uint64_t>,
+                                    std::make_unsigned<integer_type>>::type::type bits_type;
+
+  static constexpr unsigned int top{8*sizeof(bits_type)-1};          ///< position of the most significant bit.
+  static constexpr bits_type sign_bit{bits_type(bits_type{1}<<top)}; ///< most significant bit.
+
+
+  ///\brief Encodes a key (branch free).
+  static bits_type encode(const T& key) noexcept {
+    if constexpr (floating) {
+      T canonical{key+T{0}}; // -0.0 becomes +0.0, equivalent for std::less
+      bits_type bits;
+      std::memcpy(&bits, &canonical, sizeof(T));
+      bits_type mask{bits_type(bits_type(0-(bits>>top)) | sign_bit)}; // all ones if negative
+      return bits ^ mask;
+    } else if constexpr (std::is_signed<T>::value) {
+      return bits_type(static_cast<bits_type>(key) ^ sign_bit);
+    } else {
+      return key;
+    }
+  }
+
+
+  ///\brief Decodes a key (see: encode).
+  static T decode(const bits_type& bits) noexcept {
+    if constexpr (floating) {
+      bits_type mask{bits_type(bits_type((bits>>top)-1) | sign_bit)}; // all ones if it was negative
+      bits_type raw{bits_type(bits ^ mask)};
+      T key;
+      std::memcpy(&key, &raw, sizeof(T));
+      return key;
+    } else {
+      return static_cast<T>(bits_type(bits ^ (std::is_signed<T>::value ? sign_bit : bits_type{0})));
+    }
+  }
+
+
+  ///\brief Key as compared during a search: integers as they are, floating-point keys encoded.
+  static auto compared(const T& key) noexcept {
+    if constexpr (floating) {
+      return encode(key);
+    } else {
+      return key;
+    }
+  }
+};
+
+
+///\brief Whether a RBTree can take the arithmetic paths: keys with an encoding, ordered by std::less.
+template <class T, class CMP>
+constexpr bool _arithmetic_keys{_OrderedKey<T>::supported and std::is_same<CMP, std::less<T>>::value};
+
+
+///\brief Function to sort arithmetic keys by LSD radix sort on their encoding, one byte per pass.
+///       Passes whose byte is the same for every key are skipped. O(n) for a fixed key size.
+///\param keys The keys to be sorted following std::less.
+template <class T>
+void _radix_sort(std::vector<T>& keys) {
+  typedef _OrderedKey<T> Key;
+  typedef typename Key::bits_type bits_type;
+  if (keys.size()<256) { // not worth the counting passes
+    std::sort(keys.begin(), keys.end(), [](const T& a, const T& b) { return Key::encode(a)<Key::encode(b); });
+    return;
+  }
+  std::vector<bits_type> codes(keys.size()), sorted(keys.size());
+  std::transform(keys.begin(), keys.end(), codes.begin(), Key::encode);
+  for (unsigned int shift{0}; shift<8*sizeof(bits_type); shift += 8) {
+    std::size_t count[257]{};
+    for (const bits_type& code : codes) {
+      ++count[((code>>shift) & 0xFF)+1];
+    }
+    if (*std::max_element(count+1, count+257)==codes.size()) { // same byte everywhere
+      continue;
+    }
+    for (unsigned int digit{1}; digit<257; ++digit) {
+      count[digit] += count[digit-1]; // count[d] becomes the first position of digit d
+    }
+    for (const bits_type& code : codes) {
+      sorted[count[(code>>shift) & 0xFF]++] = code;
+    }
+    codes.swap(sorted);
+  }
+  std::transform(codes.begin(), codes.end(), keys.begin(), Key::decode);
+}
+
+
+#endif // KEY_TRAITS_HPP
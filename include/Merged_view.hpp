@@ -0,0 +1,219 @@
+///\file Merged_view.hpp
+///\author mpv
+///\brief header file with MergedView, a lazy sorted stream over the keys of several RBTree's (k-way merge).
+
+#ifndef MERGED_VIEW_HPP
+#define MERGED_VIEW_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "RBT.hpp"
+
+
+enum Duplicates { KEEP_DUPLICATES=0, SKIP_DUPLICATES=1 }; ///< enumerated type, keys found in several trees (see: MergedView).
+
+
+///\brief MergedView walks the keys of k trees as one sorted sequence, without copying them: it keeps one
+///       const_iterator per tree in a binary min-heap and pops the smallest, in O(log k) per key.
+///       Memory is allocated once, when the view is built; stepping allocates nothing.
+///       The view is single-pass (an input range): its iterators share the view's cursors,
+///       so begin() continues where the last walk stopped; lower_bound() starts a new walk.
+///       The trees must outlive the view and must not be modified meanwhile.
+///\param Tree type of the merged trees, a RBTree.
+template <class Tree>
+class MergedView {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef typename Tree::const_iterator tree_iterator; ///< cursor within one tree.
+  typedef typename std::iterator_traits<tree_iterator>::value_type T; ///< type of the keys.
+
+
+  ///\brief Position reached in one of the trees.
+  struct _Cursor {
+    const Tree* tree;       ///< the tree walked.
+    tree_iterator current;  ///< next key of the tree.
+  };
+
+
+private:
+  std::vector<_Cursor> cursors;   ///< one per tree.
+  std::vector<std::size_t> heap;  ///< indices of the cursors not at their end, ordered by their next key.
+  Duplicates duplicates;          ///< whether equivalent keys of different trees are all visited.
+
+
+  ///\brief Helper function to tell whether cursor a's key comes after cursor b's (ties broken by tree order).
+  bool after(const std::size_t a, const std::size_t b) const noexcept {
+    const auto& comparator{cursors[a].tree->comparator};
+    if (comparator(*cursors[b].current, *cursors[a].current)) {
+      return true;
+    }
+    return !comparator(*cursors[a].current, *cursors[b].current) and a>b; // stable: earlier trees first
+  }
+
+
+  ///\brief Helper function to move the heap's slot down to its place (see: advance).
+  void sift_down(std::size_t slot) noexcept {
+    for (std::size_t child{2*slot+1}; child<heap.size(); child = 2*slot+1) {
+      if (child+1<heap.size() and after(heap[child], heap[child+1])) {
+        ++child;
+      }
+      if (!after(heap[slot], heap[child])) {
+        return;
+      }
+      std::swap(heap[slot], heap[child]);
+      slot = child;
+    }
+  }
+
+
+  ///\brief Helper function to move the top cursor one key forward and restore the heap.
+  void step_top() noexcept {
+    _Cursor& top{cursors[heap.front()]};
+    if (++top.current==top.tree->end()) { // this tree is exhausted
+      heap.front() = heap.back();
+      heap.pop_back();
+    }
+    if (!heap.empty()) {
+      sift_down(0);
+    }
+  }
+
+
+  ///\brief Helper function to rebuild the heap from the cursors' positions.
+  void heapify() noexcept {
+    heap.clear();
+    for (std::size_t i{0}; i<cursors.size(); ++i) {
+      if (cursors[i].current!=cursors[i].tree->end()) {
+        heap.push_back(i); // capacity reserved at construction: no allocation
+      }
+    }
+    for (std::size_t slot{heap.size()/2}; slot>0; --slot) {
+      sift_down(slot-1);
+    }
+  }
+
+
+public:
+  class const_iterator;
+
+
+  ///\brief MergedView's constructor, on any number of trees known at run time.
+  ///\param trees The trees merged, all with the same order.
+  ///\param duplicates Whether a key stored in several trees is visited once per tree or only once.
+  explicit MergedView(const std::vector<const Tree*>& trees, const Duplicates duplicates=KEEP_DUPLICATES): duplicates{duplicates} {
+    cursors.reserve(trees.size());
+    heap.reserve(trees.size());
+    for (const Tree* tree : trees) {
+      cursors.push_back(_Cursor{tree, tree->begin()});
+    }
+    heapify();
+  }
+
+
+  ///\brief Function to (re)start the walk at the first key not smaller than value, in O(k log n).
+  ///\return Iterator to that key, end() if no tree holds one.
+  const_iterator lower_bound(const T& value) noexcept {
+    for (_Cursor& cursor : cursors) {
+      cursor.current = cursor.tree->lower_bound(value);
+    }
+    heapify();
+    return begin();
+  }
+
+
+  ///\brief Function to test whether every key has been visited.
+  bool done() const noexcept {return heap.empty();}
+
+
+  ///\brief Getter for the smallest key not visited yet (the view must not be done).
+  const T& front() const noexcept {return *cursors[heap.front()].current;}
+
+
+  ///\brief Function to move past the smallest key (past all its equivalents with SKIP_DUPLICATES), in O(log k).
+  void advance() noexcept {
+    const T& visited{front()}; // the node stays in its tree: the reference outlives the step
+    step_top();
+    if (duplicates==SKIP_DUPLICATES) {
+      while (!heap.empty() and !cursors[heap.front()].tree->comparator(visited, front())) {
+        step_top();
+      }
+    }
+  }
+
+
+  ///\brief Function to get an iterator to the smallest key not visited yet.
+  const_iterator begin() noexcept {return const_iterator(done() ? nullptr : this);}
+
+  ///\brief Function to get the end of the walk.
+  const_iterator end() noexcept {return const_iterator(nullptr);}
+
+};
+
+
+///\brief MergedView's input iterator: a handle on the view, which stepping advances.
+template <class Tree>
+class MergedView<Tree>::const_iterator {
+
+private:
+  MergedView* view; ///< the view walked, nullptr at the end.
+
+public:
+  typedef std::input_iterator_tag iterator_category; ///< iterator traits, for the standard algorithms.
+  typedef T value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const T* pointer;
+  typedef const T& reference;
+
+
+  ///\brief MergedView's iterator constructor.
+  ///\param walked The view, nullptr for the end.
+  explicit const_iterator(MergedView* walked) noexcept: view{walked} {}
+
+  const T& operator*() const noexcept {return view->front();}
+  const T* operator->() const noexcept {return &view->front();}
+
+
+  ///\brief Prefix increment: the view moves to its next key.
+  const_iterator& operator++() noexcept {
+    view->advance();
+    if (view->done()) {
+      view = nullptr;
+    }
+    return *this;
+  }
+
+
+  ///\brief Postfix increment (single pass: the returned iterator shares the view, it is only good for comparisons).
+  const_iterator operator++(int) noexcept {
+    const_iterator retval{*this};
+    ++(*this);
+    return retval;
+  }
+
+  bool operator==(const const_iterator& other) const noexcept {return view==other.view;}
+  bool operator!=(const const_iterator& other) const noexcept {return view!=other.view;}
+
+};
+
+
+///\brief Function to merge a fixed set of trees, e.g. for (int key : merged_view(a, b, c)).
+///\param first The first tree, the others follow (all of the same type).
+///\return The view over every key of the trees, duplicates included.
+template <class Tree, class... Trees>
+MergedView<Tree> merged_view(const Tree& first, const Trees&... rest) {
+  return MergedView<Tree>(std::vector<const Tree*>{&first, &rest...}, KEEP_DUPLICATES);
+}
+
+
+///\brief Function to merge a fixed set of trees, visiting a key stored in several of them once.
+///\param duplicates Whether equivalent keys of different trees are all visited.
+///\param first The first tree, the others follow (all of the same type).
+template <class Tree, class... Trees>
+MergedView<Tree> merged_view(const Duplicates duplicates, const Tree& first, const Trees&... rest) {
+  return MergedView<Tree>(std::vector<const Tree*>{&first, &rest...}, duplicates);
+}
+
+
+#endif // MERGED_VIEW_HPP
@@ -5,14 +5,17 @@
 #ifndef NODE_HPP
 #define NODE_HPP
 
+#include <utility>
+#include "Augmentation.hpp"
 
 enum Color { BLACK=0, RED=1 }; ///< enumerated type, colors' declaration.
 
 
 ///\brief RBTree's single node, each node bears a key and a color (red or black).
 ///       Each node has a parent and two children (left and right).
-template <class T> 
-class _Node {
+///       Augmented trees also store the aggregate of the node's subtree (see: Augmentation.hpp).
+template <class T, class AUG=NoAugmentation> 
+class _Node : public _Augment<T, AUG> {
 public:
 
   T data;                      ///< templated key of the node.
@@ -21,17 +24,17 @@ public:
 
 
   ///\brief Default Constructor of a RBTree's node.
-  ///
-  _Node() noexcept {}
+  ///       Members are value-initialized, so that the NIL sentinel is always BLACK and childless.
+  _Node() noexcept: _Augment<T, AUG>{}, data{}, color{BLACK}, left{nullptr}, right{nullptr}, parent{nullptr} {}
 
 
   ///\brief Constructor of a new node given a key and (optionally) color and parent. 
-  ///\param key key which will be inserted into the node.
+  ///\param key key which will be copied into the node (taken by reference: a record is copied once).
   ///\param clr color of the node (default set to BLACK).
   ///\param parent pointer to the parent node (default set to nullptr).
   /// Initializer List initializes the data members of a class,
   /// default color is BLACK, default parent is empty [overloaded].
-  _Node(T key, Color clr=BLACK, _Node *parent=nullptr) noexcept: data{key}, color{clr}, left{nullptr}, right{nullptr}, parent{parent} {}
+  _Node(const T& key, Color clr=BLACK, _Node *parent=nullptr) noexcept: _Augment<T, AUG>{key}, data{key}, color{clr}, left{nullptr}, right{nullptr}, parent{parent} {}
 
 
   ///\brief Destructor of a RBTree's node.
@@ -42,13 +45,13 @@ public:
   ///\brief Copy constructor for RBTree's single node.
 	///\param node The RBTree's node which will be copied to another node.
 	///\return A copy of RBTree' node, by means of a call to the constructor.
-  _Node(const _Node &node) noexcept: data{node.data}, color{node.color}, left{node.left}, right{node.right}, parent{node.parent} {}
+  _Node(const _Node &node) noexcept: _Augment<T, AUG>{node}, data{node.data}, color{node.color}, left{node.left}, right{node.right}, parent{node.parent} {}
 
 
   ///\brief Move constructor for RBTree's single node.
 	///\param rbt The rvalue reference to a RBTree's node which will be moved to another new node.
   ///\return The moved RBTree.
-  _Node(_Node &&node) noexcept: data{std::move(node.data)}, color{std::move(node.color)}, left{std::move(node.left)}, right{std::move(node.right)}, parent{std::move(node.parent)} {}
+  _Node(_Node &&node) noexcept: _Augment<T, AUG>{std::move(node)}, data{std::move(node.data)}, color{std::move(node.color)}, left{std::move(node.left)}, right{std::move(node.right)}, parent{std::move(node.parent)} {}
 
 
   ///\brief Starting from a node, follows recursively the path towards the leftmost element. 
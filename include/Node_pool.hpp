@@ -0,0 +1,221 @@
+///\file Node_pool.hpp
+///\author mpv
+///\brief header file with the implementation of the pool (slab allocator) owning RBTree's nodes.
+
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+///\brief RBTree's node pool: nodes are carved out of chunks instead of being allocated one by one,
+///       freed nodes are kept in a free list and reused by the following allocations.
+///       Chunks start small (a tree of a few keys owns a few slots) and double up to max_chunk.
+///       The pool keeps its high-water mark: chunks are given back when the last node is destroyed,
+///       when the pool is released, or when it is replaced (see: RBTree::compact), not as the tree shrinks.
+///       Chunks (and the NIL sentinel) come from the allocator, whose pointer type must be Node*.
+///\param Node type of the nodes handed out.
+///\param Alloc allocator of Node (default std::allocator<Node>).
+template <class Node, class Alloc=std::allocator<Node>>
+class _NodePool {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef std::allocator_traits<Alloc> Traits; ///< interface to the allocator.
+
+public:
+  ///\brief A contiguous block of node slots.
+  struct Chunk {
+    Node* slots;          ///< first slot of the block.
+    std::size_t capacity; ///< number of slots in the block.
+  };
+
+  static constexpr std::size_t first_chunk{4};                ///< slots of the first chunk.
+  static constexpr std::size_t max_chunk{std::size_t{1}<<16}; ///< chunks grow geometrically up to this size.
+
+
+private:
+  Alloc alloc;               ///< source of the chunks.
+  std::vector<Chunk> chunks; ///< every block owned by the pool (the last one is being carved).
+  std::size_t carved{0};     ///< slots of the last chunk already handed out at least once.
+  void* free_list{nullptr};  ///< singly linked list of freed slots (the link is stored in the slot).
+  std::size_t live{0};       ///< nodes currently constructed.
+  std::size_t reserved{0};   ///< total number of slots over all chunks.
+
+
+  ///\brief Allocates a new chunk, twice as big as the previous one (up to max_chunk).
+  void grow() {
+    std::size_t capacity{chunks.empty() ? first_chunk : std::min(2*chunks.back().capacity, max_chunk)};
+    chunks.push_back({Traits::allocate(alloc, capacity), capacity});
+    reserved += capacity;
+    carved = 0;
+  }
+
+
+public:
+  ///\brief Constructor: no chunk is allocated until the first node.
+  ///\param allocator The allocator of the chunks (defaulted to a value-initialized one).
+  explicit _NodePool(const Alloc& allocator=Alloc{}) noexcept: alloc{allocator} {}
+
+
+  ///\brief Destructor: gives the chunks back (nodes still alive are not destroyed, see: RBTree's destructor).
+  ~_NodePool() noexcept {release();}
+
+
+  _NodePool(const _NodePool&) = delete;
+  _NodePool& operator=(const _NodePool&) = delete;
+
+
+  ///\brief Move constructor: the chunks change owner, the moved pool is left empty.
+  ///       The allocator is copied, so that the moved pool can still allocate.
+  _NodePool(_NodePool&& other) noexcept: alloc{other.alloc} {swap_content(other);}
+
+
+  ///\brief Move assignment: the chunks change owner, the previous ones are given back.
+  ///       The allocators must be equal (the pools of one tree, see: RBTree::commit_compaction).
+  _NodePool& operator=(_NodePool&& other) noexcept {
+    if (this!=&other) {
+      release();
+      swap_content(other);
+    }
+    return *this;
+  }
+
+
+  ///\brief Constructs a node in a free slot.
+  ///\param args Arguments forwarded to the node's constructor.
+  ///\return Pointer to the new node.
+  template <class... Args>
+  Node* create(Args&&... args) {
+    void* slot;
+    if (free_list!=nullptr) { // reuse the most recently freed slot
+      slot = free_list;
+      free_list = *static_cast<void**>(slot);
+    } else {
+      if (chunks.empty() or carved==chunks.back().capacity) {
+        grow();
+      }
+      slot = chunks.back().slots+carved++;
+    }
+    Node* node;
+    try {
+      node = new (slot) Node(std::forward<Args>(args)...);
+    } catch (...) { // e.g. the key's copy threw: the slot goes to the free list
+      *static_cast<void**>(slot) = free_list;
+      free_list = slot;
+      throw;
+    }
+    ++live;
+    return node;
+  }
+
+
+  ///\brief Destroys a node and puts its slot in the free list; the last node gives every chunk back
+  ///       (unless they are no more than a first chunk, kept for the next insertions).
+  ///\param node The node to be destroyed, created by this pool.
+  void destroy(Node* node) noexcept {
+    node->~Node();
+    *reinterpret_cast<void**>(node) = free_list;
+    free_list = node;
+    if (--live==0 and reserved>first_chunk) {
+      release();
+    }
+  }
+
+
+  ///\brief Gives every chunk back, without destroying the nodes still alive.
+  void release() noexcept {
+    for (const Chunk& chunk : chunks) {
+      Traits::deallocate(alloc, chunk.slots, chunk.capacity);
+    }
+    chunks.clear();
+    carved = 0;
+    free_list = nullptr;
+    live = 0;
+    reserved = 0;
+  }
+
+
+  ///\brief Allocates a single chunk of exactly capacity slots, to be filled in order (see: create).
+  ///       Used to lay out a known number of nodes contiguously; the pool must be empty.
+  ///\param capacity Number of slots.
+  void reserve_exact(const std::size_t capacity) {
+    if (capacity==0) {
+      return;
+    }
+    chunks.push_back({Traits::allocate(alloc, capacity), capacity});
+    reserved += capacity;
+    carved = 0;
+  }
+
+
+  ///\brief Allocates a single chunk of exactly capacity slots, handed out all at once.
+  ///       The caller constructs a node in every slot (e.g. from several threads, see: parallel_clone).
+  ///\param capacity Number of slots.
+  ///\return The first slot of the chunk.
+  Node* allocate_block(const std::size_t capacity) {
+    reserve_exact(capacity);
+    if (capacity==0) {
+      return nullptr;
+    }
+    carved = capacity;
+    live += capacity;
+    return chunks.back().slots;
+  }
+
+
+  ///\brief Allocates and constructs a node outside the chunks (a tree's NIL sentinel).
+  ///\return Pointer to a default-constructed node, to be given back with destroy_sentinel.
+  Node* create_sentinel() {
+    Node* slot{Traits::allocate(alloc, 1)};
+    return new (slot) Node;
+  }
+
+
+  ///\brief Destroys and deallocates a node made by create_sentinel.
+  void destroy_sentinel(Node* node) noexcept {
+    node->~Node();
+    Traits::deallocate(alloc, node, 1);
+  }
+
+
+  ///\brief Swaps the nodes of two pools in O(1), but not their allocators (which must be equal,
+  ///       or swapped as well, see: swap_allocator).
+  ///\param other The pool to be swapped with.
+  void swap_content(_NodePool& other) noexcept {
+    std::swap(chunks, other.chunks);
+    std::swap(carved, other.carved);
+    std::swap(free_list, other.free_list);
+    std::swap(live, other.live);
+    std::swap(reserved, other.reserved);
+  }
+
+
+  ///\brief Swaps the allocators of two pools (allocators propagating on swap, copy or move assignment).
+  void swap_allocator(_NodePool& other) noexcept {
+    using std::swap;
+    swap(alloc, other.alloc);
+  }
+
+
+  ///\brief Getter for the allocator.
+  const Alloc& get_allocator() const noexcept {return alloc;}
+
+
+  ///\brief Getter for the number of nodes alive.
+  std::size_t size() const noexcept {return live;}
+
+  ///\brief Getter for the number of slots owned (alive, freed or never used).
+  std::size_t capacity() const noexcept {return reserved;}
+
+  ///\brief Getter for the owned chunks.
+  const std::vector<Chunk>& get_chunks() const noexcept {return chunks;}
+
+};
+
+
+#endif // NODE_POOL_HPP
@@ -5,40 +5,169 @@
 #ifndef RBT_HPP
 #define RBT_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Key_traits.hpp"
 #include "Node.hpp"
+#include "Node_pool.hpp"
+
+
+template <class T, class CMP> class ConcurrentRBTree;
+namespace rbt_parallel { template <class Tree> struct _Cloner; }
+namespace rbt_diff { template <class Tree> struct _Differ; }
+template <class T> class CompressedSnapshot;
+
+
+///\brief Whether values of type T can be written to a std::ostream (see: RBTree::delete_).
+template <class T, class=void>
+struct _is_printable : std::false_type {};
+
+template <class T>
+struct _is_printable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>> : std::true_type {};
+
+
+enum Layout { IN_ORDER=0, VAN_EMDE_BOAS=1 }; ///< enumerated type, node orders available to compact().
+
+
+///\brief Fragmentation and locality metrics of a RBTree's nodes (see: RBTree::layout_stats).
+///       Low occupancy means many freed slots; a span or mean gap much larger than one node,
+///       or a low same-page ratio, mean that walks jump across memory: time to compact().
+struct LayoutStats {
+  std::size_t nodes{0};       ///< number of keys stored.
+  std::size_t slots{0};       ///< node slots owned by the tree (alive, freed or never used).
+  std::size_t chunks{0};      ///< memory blocks the slots are spread on.
+  double occupancy{1};        ///< nodes/slots, 1 means no freed or unused slot.
+  double span{1};             ///< bytes from the lowest to the highest node over the bytes of the nodes, 1 is dense.
+  double mean_gap{0};         ///< average distance in bytes between in-order consecutive nodes.
+  double adjacent_ratio{1};   ///< fraction of in-order consecutive nodes lying next to each other.
+  double same_page_ratio{1};  ///< fraction of parent-child links staying within a 4KiB page.
+};
+
+
+///\brief Keys added and removed between two versions of a RBTree, each in ascending order (see: diff, RBTree::apply_delta).
+template <class T>
+struct Delta {
+  std::vector<T> added;   ///< keys of the newer version only.
+  std::vector<T> removed; ///< keys of the older version only.
+  bool empty() const noexcept {return added.empty() and removed.empty();}
+  std::size_t size() const noexcept {return added.size()+removed.size();}
+};
 
 
 ///\brief RBTree is a templated class which implements R. Bayer's Red Black Tree (1972).
 ///\param T type of the tree nodes' keys.
 ///\param CMP relational function to compare nodes' keys (default std::less<T>).
-template <class T, class CMP=std::less<T>> 
+///\param AUG augmentation policy, a monoid aggregated over every subtree (default NoAugmentation).
+///\param ALLOC allocator, rebound to the nodes, whose pointer type must be a raw pointer (default std::allocator<T>).
+template <class T, class CMP=std::less<T>, class AUG=NoAugmentation, class ALLOC=std::allocator<T>> 
 class RBTree {
 
   ///   Aliasing existing types with typedef-names for clarity.
-  typedef T node_type;           ///< type of the tree nodes' keys.
-  typedef _Node<node_type> Node; ///< type of templated tree's node.
+  typedef T node_type;                ///< type of the tree nodes' keys.
+  typedef _Node<node_type, AUG> Node; ///< type of templated tree's node.
   typedef Node *NodePtr;         ///< type of pointer to templated tree's node.
+  typedef typename std::allocator_traits<ALLOC>::template rebind_alloc<Node> NodeAllocator; ///< allocator of the nodes.
+  typedef std::allocator_traits<NodeAllocator> NodeTraits; ///< propagation rules of the allocator.
+
+  friend class ConcurrentRBTree<T, CMP>; ///< concurrent wrapper, traverses and unlinks nodes directly.
+  template <class Tree> friend struct rbt_parallel::_Cloner; ///< parallel clone, builds nodes in place.
+  template <class Tree> friend struct rbt_diff::_Differ; ///< diff, compares subtree digests.
+
+  static constexpr bool augmented{!std::is_same<AUG, NoAugmentation>::value}; ///< whether nodes carry aggregates.
+  static constexpr bool arithmetic{_arithmetic_keys<T, CMP>}; ///< whether keys take the arithmetic paths (see: Key_traits.hpp).
+  static constexpr bool trivial_nodes{std::is_trivially_destructible<T>::value
+                                      and std::is_trivially_destructible<_Augment<T, AUG>>::value}; ///< whether nodes can be freed unvisited.
 
 
 private:
+  _NodePool<Node, NodeAllocator> pool; ///< owner of every node but NIL (and of the allocator)
   NodePtr root; ///< root of the RBTree (always black)
   NodePtr NIL; ///< empty (leaf) node of the RBTree (always black)
+  NodePtr leftmost; ///< node of the smallest key, NIL if the tree is empty (see: min, pop_min)
+  NodePtr rightmost; ///< node of the largest key, NIL if the tree is empty (see: max, pop_max)
+  std::size_t modifications{0}; ///< number of insertions/deletions/modifications so far (see: commit_compaction)
+  static inline Node empty_nil{}; ///< NIL of the trees which never needed one of their own (empty), only ever read
 
 
-  ///\brief A recursive helper function to create a deep copy of a RBTree.
-  ///\param copied The starting node for exploring the RBTree, typically its root.
-  ///\param new_parent Supplied parent node in case needed (at start is nullptr).
-  ///\param other_rbt The starting node for exploring another (empty) RBTree, typically its root.
-  ///\return A deep copy of the original RBTree provided.
-  void copy(NodePtr& copied, NodePtr new_parent, NodePtr other_rbt);
+  ///\brief Helper function to give an empty tree a NIL of its own before the first node links to it
+  ///       (nodes write to NIL during a deletion, the shared empty_nil must stay untouched).
+  void own_nil() {
+    if (NIL==&empty_nil) {
+      root = leftmost = rightmost = NIL = pool.create_sentinel();
+    }
+  }
 
 
-  ///\brief A recursive helper function to print RBTree's keys (see: print_ordered_keys).
-  ///\param root The starting node for exploring the RBTree, typically its root.
-  ///\param choice A const integer to explicit which type of traversal you want.
-  ///\return Prints the ordered keys of RBTree following the type of traversal chosen.
-  void recursive_ordering(const NodePtr& root, const int choice) const;
+  ///\brief An iterative helper function to create a deep copy of a subtree, in pre-order.
+  ///       The source and the copy are walked together through their parent links: no recursion, no stack.
+  ///\param source The root of the subtree to be copied.
+  ///\param source_nil The NIL sentinel of the source tree.
+  ///\param parent Parent of the copied root (nullptr when copying a whole tree).
+  ///\param make Callable returning a new node copied from its argument (key, color and aggregate).
+  ///\return The root of the copy, whose leaves point to this tree's NIL.
+  template <class Make>
+  NodePtr copy(const NodePtr& source, const NodePtr& source_nil, NodePtr parent, Make make) const;
+
+
+  ///\brief Helper function to destroy every node of a subtree, giving the slots back to the pool.
+  ///       The walk follows the parent links and unlinks each destroyed node, so it allocates nothing.
+  ///\param node The root of the subtree.
+  void destroy_subtree(NodePtr node) noexcept;
+
+
+  ///\brief Helper function to free every node and give the chunks back to the allocator.
+  ///       Nodes whose destruction does nothing are not visited: the chunks are released at once.
+  void release_nodes() noexcept;
+
+
+  ///\brief Helper function to exchange nodes, NIL and comparator with a tree, keeping the allocators.
+  ///       The allocators must be equal (see: swap).
+  ///\param rbt The RBTree to be exchanged with.
+  void exchange(RBTree& rbt) noexcept;
+
+
+  ///\brief A recursive helper function to list a subtree's nodes in van Emde Boas order (see: compact).
+  ///       The top half of the levels is laid out first, then each bottom subtree, recursively.
+  ///\param node The root of the subtree.
+  ///\param height Number of levels to be laid out.
+  ///\param order Output vector, the nodes are appended to it.
+  void veb_order(const NodePtr& node, const unsigned int height, std::vector<NodePtr>& order) const;
+
+
+  ///\brief A recursive helper function to collect the nodes at a given depth, from left to right (see: veb_order).
+  ///\param node The root of the subtree.
+  ///\param depth Depth of the nodes to be collected, relative to node.
+  ///\param nodes Output vector, the nodes are appended to it.
+  void collect_at_depth(const NodePtr& node, const unsigned int depth, std::vector<NodePtr>& nodes) const;
+
+
+  ///\brief Helper function to invoke a visitor's callback on a key (see: visit_inorder).
+  ///\param f Callable taking the key, or the key and its depth, and returning void or bool.
+  ///\return Bool false if f asks to stop the visit.
+  template <class F>
+  static bool call_visitor(F& f, const T& key, const unsigned int depth);
+
+
+  ///\brief An iterative helper function to walk a subtree depth-first (see: visit_inorder).
+  ///       The walk follows the parent links: the node it comes from tells whether it arrives from above,
+  ///       from the left or from the right child, so it needs no recursion, no stack and no allocation.
+  ///\param choice Position of the visit: 1='in-order', 2='pre-order', 3='post-order' (as print_ordered_keys).
+  ///\param start The root of the subtree.
+  ///\param max_depth Deepest level visited, relative to start (which is at depth 0).
+  ///\param f Callable invoked as f(key, depth), returning false to stop the walk.
+  ///\return Bool false if the walk has been stopped by f.
+  template <unsigned int choice, class F>
+  bool walk(const NodePtr& start, const unsigned int max_depth, F&& f) const;
 
 
   ///\brief A recursive helper function to find a RBTree's node given its key (see: contains).
@@ -48,6 +177,39 @@ private:
   NodePtr recursive_search(const NodePtr& root, const T& value) const;
 
 
+  ///\brief Helper function to find the node of a key of another type than T (see: the heterogeneous contains).
+  ///\param key A value the comparator compares with T's.
+  ///\return The node whose key is equivalent to key, or NIL if there is none.
+  template <class K>
+  NodePtr search_key(const K& key) const noexcept;
+
+
+  ///\brief Branch free descent for arithmetic keys (see: recursive_search).
+  ///       The child is selected by a conditional move instead of a jump, floating-point keys are compared
+  ///       through their integer encoding, and the walk always reaches a leaf, remembering the last node
+  ///       not smaller than value: its key is checked for equality once, at the end.
+  ///\param node The starting node for exploring the RBTree, typically its root.
+  ///\param value The value of the key you are searching within the RBTree.
+  ///\param last Set to the last node visited (the parent of value's position), nullptr if there was none.
+  ///\return The node holding value, or NIL if value is not present.
+  NodePtr branchless_search(NodePtr node, const T& value, NodePtr& last) const noexcept;
+
+
+  ///\brief A recursive helper function to build a perfectly balanced subtree from sorted keys (see: bulk_load).
+  ///       Nodes are constructed in place at the slot of their key's index, so the block ends up in order;
+  ///       only the nodes at depth red_depth (the incomplete last level) are red.
+  ///\param slots Block of nodes, one per key.
+  ///\param keys Sorted keys, without duplicates.
+  ///\param low First key of the subtree.
+  ///\param high Past the last key of the subtree.
+  ///\param parent Parent of the subtree's root.
+  ///\param depth Depth of the subtree's root.
+  ///\param red_depth Depth of the red nodes.
+  ///\return The root of the subtree.
+  NodePtr build_balanced(Node* slots, const std::vector<T>& keys, const std::size_t low, const std::size_t high,
+                         NodePtr parent, const unsigned int depth, const unsigned int red_depth) noexcept;
+
+
   ///\brief A recursive helper function to print the RBTree's structure (see: print_tree).
   ///\param root The starting node for exploring the RBTree, typically its root.
   ///\param indentation Specifies the degree of indentation for tree's branches.
@@ -63,6 +225,34 @@ private:
   void node_replacement(const NodePtr& replaced, const NodePtr& replacer) noexcept;
   
 
+  ///\brief Private utility function to recompute a node's aggregate from its key and its children (augmented trees).
+  ///\param node The node whose aggregate is refreshed.
+  void update_aggregate(const NodePtr& node) noexcept;
+
+
+  ///\brief Private utility function to recompute the aggregates from a node up to the root (augmented trees).
+  ///\param node The lowest node whose subtree has changed.
+  void refresh_upwards(NodePtr node) noexcept;
+
+
+  ///\brief Helper function to find the cached extremes again, after a bulk change of the nodes.
+  void refresh_extremes() noexcept;
+
+
+  ///\brief Private utility function to aggregate the keys not smaller than a bound within a subtree.
+  ///\param node The root of the subtree.
+  ///\param lower The lower bound (included).
+  ///\return The aggregate of the keys in [lower, +inf) of the subtree.
+  typename AUG::value_type aggregate_from(NodePtr node, const T& lower) const noexcept;
+
+
+  ///\brief Private utility function to aggregate the keys smaller than a bound within a subtree.
+  ///\param node The root of the subtree.
+  ///\param upper The upper bound (excluded).
+  ///\return The aggregate of the keys in (-inf, upper) of the subtree.
+  typename AUG::value_type aggregate_until(NodePtr node, const T& upper) const noexcept;
+
+
   ///\brief Private utility function to help rebalance RBTree's after insertion/deletion.
   ///\param node The node which constitutes the pivot point for the rotation.
   ///\param to_right Direction of desired rotation: 0=left (child up), 1=right (child down).
@@ -85,8 +275,15 @@ private:
   ///\brief Private helper function to rebalance RBTree's after key deletion (see: delete).
   ///\param node The starting node for visiting the RBTree, typically its root.
   ///\param value The value you are going to delete.
-  ///\return Rebalanced RBTree's compliant with 5 rules, after implementing the deletion.
-  void delete_adjustment(const NodePtr& node, const T& value) noexcept;
+  ///\return The unlinked node (still allocated, owned by the caller) or NIL if value is not found.
+  ///       The RBTree left behind is rebalanced and compliant with 5 rules.
+  NodePtr delete_adjustment(const NodePtr& node, const T& value) noexcept;
+
+
+  ///\brief Private helper function to unlink a node from the tree and rebalance it (see: delete_adjustment).
+  ///       The cached extremes move to the in-order neighbour if node was one of them.
+  ///\param node_A The node to be unlinked (still allocated afterwards, owned by the caller).
+  void unlink(NodePtr node_A) noexcept;
 
 
 public:
@@ -97,70 +294,184 @@ public:
   class const_iterator;
 
 
+  ///\brief Nodes of a RBTree relocated into one contiguous block, ready to replace the tree's ones
+  ///       (see: prepare_compaction, commit_compaction).
+  class CompactedLayout {
+    friend class RBTree;
+    _NodePool<Node, NodeAllocator> pool; ///< single chunk holding the relocated nodes, in layout order.
+    NodePtr root{nullptr};        ///< relocated root.
+    NodePtr nil{nullptr};         ///< NIL of the tree the layout was prepared on, which its leaves point to.
+    std::size_t modifications{0}; ///< tree's modifications when the layout was prepared.
+
+    ///\brief Constructor, allocating from the tree's allocator (see: prepare_compaction).
+    explicit CompactedLayout(const NodeAllocator& alloc) noexcept: pool{alloc} {}
+
+  public:
+    CompactedLayout() noexcept {}
+
+    ///\brief Move constructor: the relocated nodes change owner.
+    CompactedLayout(CompactedLayout&& other) noexcept: pool{std::move(other.pool)}, root{other.root}, nil{other.nil}, modifications{other.modifications} {
+      other.root = nullptr;
+    }
+
+    ///\brief Destructor: a layout which has not been committed destroys its nodes.
+    ~CompactedLayout() noexcept {
+      if (root!=nullptr) {
+        Node* slots{pool.get_chunks().front().slots};
+        for (std::size_t i{0}, n{pool.size()}; i<n; ++i) {
+          pool.destroy(slots+i);
+        }
+      }
+    }
+  };
+
+
   ///\brief RBTree's constructor.
-  ///       Default constructor for the RBTree class.
-  RBTree() noexcept {root = NIL = new Node;}
+  ///       Default constructor for the RBTree class, allocating nothing (see: own_nil).
+  RBTree() noexcept: RBTree(ALLOC{}) {}
+
+
+  ///\brief RBTree's constructor with an allocator (e.g. a std::pmr::polymorphic_allocator, see: pmr::RBTree).
+  ///       NIL is allocated by the first insertion, the empty tree allocates nothing.
+  ///\param alloc The allocator of the nodes (NIL included).
+  explicit RBTree(const ALLOC& alloc) noexcept: pool{NodeAllocator(alloc)} {root = leftmost = rightmost = NIL = &empty_nil;}
 
 
 	///\brief Constructor for RBTree given the root node.
 	///\param value The value to be inserted into the RBTree's root node.
 	///\param cmp A custom comparison function for tree nodes (defaulted to std::less).
-	RBTree(T value, CMP cmp=CMP{}): root{new Node{value}}, NIL{new Node}, comparator{cmp} {}
+	///\param alloc The allocator of the nodes (defaulted to a value-initialized one).
+	RBTree(T value, CMP cmp=CMP{}, const ALLOC& alloc=ALLOC{}): pool{NodeAllocator(alloc)}, root{pool.create(value)}, NIL{pool.create_sentinel()}, leftmost{root}, rightmost{root}, comparator{cmp} {}
 
 
   ///\brief RBTree's destructor.
-  ///       Overloaded destructor for the RBTree class.
-  ~RBTree() noexcept  {delete NIL;}
+  ///       Overloaded destructor for the RBTree class: nodes are destroyed and their chunks released.
+  ~RBTree() noexcept  {
+    release_nodes();
+    if (NIL!=&empty_nil) {
+      pool.destroy_sentinel(NIL);
+    }
+  }
 
 
   ///\brief Copy constructor for RBTree.
+  ///       Every node is allocated in one block sized up front and copied iteratively (see: copy).
+  ///       The allocator is the one select_on_container_copy_construction picks (the default resource for pmr).
 	///\param rbt The RBTree which will be copied to another new tree.
 	///\return A 'deep copy' of RBTree, by means of a call to the constructor.
-  RBTree(const RBTree& rbt) noexcept {
-    copy(root, nullptr, rbt.root);  // deep copy
-    //root = new Node (*rbt.root);  // shallow copy
+  RBTree(const RBTree& rbt): RBTree(rbt, NodeTraits::select_on_container_copy_construction(rbt.pool.get_allocator())) {}
+
+
+  ///\brief Copy constructor for RBTree, with the allocator of the copy.
+	///\param rbt The RBTree which will be copied to another new tree.
+  ///\param alloc The allocator of the copy's nodes.
+  RBTree(const RBTree& rbt, const ALLOC& alloc): RBTree(alloc) {
+    comparator = rbt.comparator;
+    if (rbt.root==rbt.NIL) {
+      return;
+    }
+    own_nil();
+    pool.reserve_exact(rbt.pool.size());
+    root = copy(rbt.root, rbt.NIL, nullptr, [this](const Node& node) { return pool.create(node); });
+    refresh_extremes();
   }
 
 
-  ///\brief Copy assignment for RBTree.
+  ///\brief Copy assignment for RBTree (copy and swap: the tree is left untouched if the copy fails).
+  ///       The allocator is taken from rbt only if it propagates on copy assignment.
 	///\param rbt A const lvalue reference to RBTree that will be copied to an existing tree.
 	///\return The copy of the RBTree.
-  RBTree& operator=(const RBTree& rbt) noexcept {
+  RBTree& operator=(const RBTree& rbt) {
     if (this!=&rbt) {
-      if (root!=nullptr) {
-        //clear_tree(rbt.root);
+      RBTree copied{rbt, NodeTraits::propagate_on_container_copy_assignment::value ? rbt.get_allocator() : get_allocator()};
+      exchange(copied);
+      if constexpr (NodeTraits::propagate_on_container_copy_assignment::value) {
+        pool.swap_allocator(copied.pool); // the copy's nodes come with their allocator, the previous ones leave with theirs
       }
-      copy(root, nullptr, rbt.root);
     }
     return *this;
   }
 
 
-  ///\brief Move constructor for RBTree.
+  ///\brief Move constructor for RBTree, in O(1), allocating nothing.
+  ///       Nodes, NIL and comparator change owner; the moved tree is left empty, on the shared empty NIL
+  ///       (see: own_nil), with a copy of its allocator.
 	///\param rbt The rvalue reference to the RBTree which will be moved to another new tree.
   ///\return The moved RBTree.
-	RBTree(RBTree&& rbt) noexcept: root{std::move(rbt.root)} {}
+	RBTree(RBTree&& rbt) noexcept: pool{std::move(rbt.pool)}, root{rbt.root}, NIL{rbt.NIL}, leftmost{rbt.leftmost}, rightmost{rbt.rightmost}, modifications{rbt.modifications}, comparator{rbt.comparator} {
+    rbt.root = rbt.leftmost = rbt.rightmost = rbt.NIL = &empty_nil;
+    ++rbt.modifications; // layouts prepared for the moved tree are stale
+  }
+
+
+  ///\brief Move constructor for RBTree, with the allocator of the new tree.
+  ///       In O(1) if the allocators are equal, otherwise the keys are copied into nodes from alloc.
+	///\param rbt The rvalue reference to the RBTree which will be moved to another new tree.
+  ///\param alloc The allocator of the new tree's nodes.
+  RBTree(RBTree&& rbt, const ALLOC& alloc): RBTree(alloc) {
+    if (pool.get_allocator()==rbt.pool.get_allocator()) {
+      exchange(rbt);
+    } else {
+      RBTree copied{rbt, alloc};
+      exchange(copied);
+    }
+  }
 
 
-  ///\brief Move assignment for RBTree.
+  ///\brief Move assignment for RBTree, in O(1) if the allocator propagates on move assignment
+  ///       or the allocators are equal (the previous nodes are handed to rbt, which frees them when destroyed).
+  ///       A propagating allocator frees the previous nodes first and leaves rbt this tree's NIL and allocator,
+  ///       so that nothing is allocated. Otherwise nodes cannot change allocator: the keys are copied into nodes
+  ///       from this tree's allocator.
 	///\param rbt The rvalue reference to RBTree that will be moved to an existing tree.
   ///\return The moved RBTree.
-	RBTree& operator=(RBTree&& rbt) noexcept {
-    if (this!=&rbt) {
-      if (root!=nullptr) {
-      //clear_tree(rbt.root);
-      }
-      root = std::move(rbt.root);
-    } 
+	RBTree& operator=(RBTree&& rbt) noexcept(NodeTraits::propagate_on_container_move_assignment::value
+                                           or NodeTraits::is_always_equal::value) {
+    if (this==&rbt) {
+      return *this;
+    }
+    if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+      release_nodes(); // previous nodes are freed with the previous allocator, NIL is kept
+      root = leftmost = rightmost = NIL;
+      exchange(rbt);
+      pool.swap_allocator(rbt.pool); // each NIL stays with the allocator that made it
+    } else if (NodeTraits::is_always_equal::value or pool.get_allocator()==rbt.pool.get_allocator()) {
+      exchange(rbt);
+    } else {
+      RBTree copied{rbt, get_allocator()};
+      exchange(copied);
+    }
     return *this;
   }
 
 
+  ///\brief Function to exchange the content of two RBTrees in O(1): nodes, NIL and comparator.
+  ///       Allocators are exchanged only if they propagate on swap, otherwise they must be equal.
+  ///\param rbt The RBTree to be swapped with.
+  void swap(RBTree& rbt) noexcept;
+
+
+  ///\brief Function to get a copy of the allocator.
+  ///\return The allocator, rebound to the keys' type.
+  ALLOC get_allocator() const noexcept {return ALLOC(pool.get_allocator());}
+
+
+  ///\brief Non-member swap, found by argument dependent lookup (see: swap).
+  friend void swap(RBTree& a, RBTree& b) noexcept {
+    a.swap(b);
+  }
+
+
   ///\brief Function to get the root of the RBTree.
 	///\return A pointer to RBTree's root.
   NodePtr get_root() const;
 
 
+  ///\brief Function to get the NIL sentinel of the RBTree (every leaf's child points to it).
+	///\return A pointer to RBTree's NIL node.
+  NodePtr get_nil() const noexcept;
+
+
   ///\brief Function to get the RBTree's height.
 	///\param root The starting node for exploring the RBTree, typically its root.
 	///\return The total height of the RBTree, as an integer levels count.
@@ -181,8 +492,32 @@ public:
 
   ///\brief Function to insert a new value in the tree.
 	///\param value The value you are going to insert.
-	///\return A RBTree which includes an additional node with the value inserted.
-  void insert(const T& value) noexcept;
+	///\return Bool true if a node has been added, false if an equivalent key was already stored.
+  bool insert(const T& value) noexcept;
+
+
+  ///\brief Function to insert many keys at once: they are sorted, merged with the keys already stored
+  ///       and a balanced tree is built in O(n), its nodes laid out in order in one block (see: compact).
+  ///       Arithmetic keys ordered by std::less are radix sorted, any other key is sorted by the comparator.
+  ///       Iterators and node pointers are invalidated.
+  ///\param first Beginning of the range of keys to be inserted.
+  ///\param last End of the range of keys to be inserted.
+  template <class InputIt>
+  void bulk_load(InputIt first, InputIt last);
+
+
+  ///\brief Function to apply the changes between two versions of a tree (see: diff in RBT_diff.hpp).
+  ///       Removed keys are deleted one by one; added keys are inserted one by one when they are few,
+  ///       or merged by bulk_load when a rebuild is cheaper (iterators and node pointers are then invalidated).
+  ///\param delta The keys to be removed and added (keys already absent, or already present, are skipped).
+  void apply_delta(const Delta<T>& delta);
+
+
+  ///\brief Function to build a read-only, block-compressed copy of the keys, for integer keys ordered by std::less
+  ///       (see: RBT_compressed.hpp): a cold index keeps answering contains, lower_bound and in-order walks
+  ///       in a few bits per key instead of a node each.
+  ///\return The snapshot, independent of the tree afterwards.
+  CompressedSnapshot<T> compress() const;
 
 
   ///\brief Function to test whether the tree contains a value (see: recursive_search).
@@ -197,30 +532,114 @@ public:
   const T& find(const T& value) const noexcept;
   
 
+  ///\brief Function to find the first key not smaller than value, in O(log n).
+	///\param value The value searched (it need not be stored).
+	///\return RBTree's const_iterator to the key, end() if every key is smaller.
+  RBTree<T, CMP, AUG, ALLOC>::const_iterator lower_bound(const T& value) const noexcept;
+
+
   ///\brief Function to delete a value from the tree.
 	///\param value The value you are going to delete.
-	///\return A RBTree without the node which contained the value inserted.
-  void delete_(const T& value) noexcept;
+	///\return Bool true if a node has been removed, false if value was not stored.
+  bool delete_(const T& value) noexcept;
+
+
+  ///\brief Heterogeneous lookups, for comparators declaring is_transparent (e.g. std::less<>, or a KeyCompare
+  ///       comparing records on one of their fields, see: Key_of.hpp): key is compared with the stored keys
+  ///       as it is, no T is built to search it (as std::set's heterogeneous lookup).
+  ///\param key A value the comparator compares with T's (e.g. the field of a record).
+  ///\return Bool true if a key equivalent to key is stored.
+  template <class K, class C=CMP, class=typename C::is_transparent>
+  bool contains(const K& key) const noexcept {return search_key(key)!=NIL;}
+
+
+  ///\brief Heterogeneous find (see: the heterogeneous contains).
+  ///\return The stored key equivalent to key if present, the key of NIL otherwise.
+  template <class K, class C=CMP, class=typename C::is_transparent>
+  const T& find(const K& key) const noexcept {return search_key(key)->data;}
+
+
+  ///\brief Heterogeneous lower_bound (see: the heterogeneous contains).
+  ///\return RBTree's const_iterator to the first key not smaller than key, end() if every key is smaller.
+  template <class K, class C=CMP, class=typename C::is_transparent>
+  const_iterator lower_bound(const K& key) const noexcept;
+
+
+  ///\brief Heterogeneous delete_ (see: the heterogeneous contains).
+  ///\param key A value equivalent to the key you are going to delete.
+  ///\return Bool true if a node has been removed.
+  template <class K, class C=CMP, class=typename C::is_transparent>
+  bool delete_(const K& key) noexcept;
+
+
+  ///\brief Function to modify in place the stored key equivalent to value (e.g. a payload the comparator ignores).
+  ///       f must not change the key's order; the aggregates of the node's ancestors are refreshed.
+  ///\param value The value whose stored key is modified.
+  ///\param f Callable invoked as f(T&) on the stored key.
+  ///\return Bool true if the value was found (and f invoked).
+  template <class F>
+  bool modify(const T& value, F f);
+
+
+  ///\brief Function to test whether the tree stores no key, in O(1).
+  bool empty() const noexcept {return root==NIL;}
+
+
+  ///\brief Getter for the number of keys, in O(1) (the nodes alive in the pool).
+  std::size_t size() const noexcept {return pool.size();}
+
+
+  ///\brief Getter for the smallest key, in O(1) (the leftmost node is cached).
+  ///\return Const reference to the smallest key (the tree must not be empty).
+  const T& min() const noexcept {return leftmost->data;}
+
+
+  ///\brief Getter for the largest key, in O(1) (the rightmost node is cached).
+  ///\return Const reference to the largest key (the tree must not be empty).
+  const T& max() const noexcept {return rightmost->data;}
+
+
+  ///\brief Function to remove the smallest key without searching it: the cached node is unlinked directly,
+  ///       so the tree works as a double-ended priority queue (amortized O(1) rotations, O(log n) worst case).
+  ///\return The smallest key, moved out of the tree (the tree must not be empty).
+  T pop_min();
+
+
+  ///\brief Function to remove the largest key without searching it (see: pop_min).
+  ///\return The largest key, moved out of the tree (the tree must not be empty).
+  T pop_max();
 
 
   ///\brief Function to start a forward iteration on the binary search tree.
 	///\return RBTree's const_iterator to the in-order first element of the tree.
-  RBTree<T, CMP>::const_iterator begin() const noexcept;
+  RBTree<T, CMP, AUG, ALLOC>::const_iterator begin() const noexcept;
 
 
   ///\brief Function to end a forward iteration on the binary search tree.
-	///\return RBTree's const_iterator to nullptr (located after RBTree's last element).
-  RBTree<T, CMP>::const_iterator end() const noexcept;
+	///\return RBTree's const_iterator to nullptr (located after RBTree's last element, which --end() reaches).
+  RBTree<T, CMP, AUG, ALLOC>::const_iterator end() const noexcept;
 
 
   ///\brief Function to start a backwards iteration on the binary search tree.
 	///\return RBTree's const_iterator to the in-order last element of the tree.
-  RBTree<T, CMP>::const_iterator rbegin() const noexcept;
+  RBTree<T, CMP, AUG, ALLOC>::const_iterator rbegin() const noexcept;
 
 
   ///\brief Function to end a backwards iteration on the binary search tree.
 	///\return RBTree's const_iterator to nullptr (located before RBTree's first element).
-  RBTree<T, CMP>::const_iterator rend() const noexcept;
+  RBTree<T, CMP, AUG, ALLOC>::const_iterator rend() const noexcept;
+
+
+  ///\brief Function to aggregate every key of an augmented RBTree.
+  ///\return The aggregate of the whole tree, in O(1).
+  typename AUG::value_type aggregate() const noexcept;
+
+
+  ///\brief Function to aggregate the keys within a range of an augmented RBTree.
+  ///\param lower The lower bound of the range (included).
+  ///\param upper The upper bound of the range (excluded).
+  ///\return The aggregate of the keys in [lower, upper), in O(log n).
+  typename AUG::value_type aggregate(const T& lower, const T& upper) const noexcept;
 
 
   ///\brief A function to discover the successor of the current node.
@@ -235,7 +654,38 @@ public:
   NodePtr get_predecessor(NodePtr node) const noexcept;
 
 
-  ///\brief A wrapper function to print RBT's keys (see: recursive_ordering).
+  ///\brief Function to visit the keys in-order (left-root-right), without recursion, allocation nor I/O.
+  ///\param f Callable invoked as f(key) or f(key, depth), the root being at depth 0; returning false stops the visit.
+  ///\return Bool false if the visit has been stopped by f.
+  template <class F>
+  bool visit_inorder(F f) const;
+
+
+  ///\brief Function to visit the keys in pre-order (root-left-right), see: visit_inorder.
+  ///       Inserting the keys in this order into an unbalanced binary search tree rebuilds the very same shape.
+  template <class F>
+  bool visit_preorder(F f) const;
+
+
+  ///\brief Function to visit the keys in post-order (left-right-root), see: visit_inorder.
+  template <class F>
+  bool visit_postorder(F f) const;
+
+
+  ///\brief Function to visit the keys level by level, each level from left to right (see: visit_inorder).
+  ///       Levels are reached by depth-bounded walks instead of a queue: no allocation,
+  ///       O(n) for balanced shapes and O(n log n) at worst.
+  template <class F>
+  bool visit_levelorder(F f) const;
+
+
+  ///\brief Function to visit in pre-order the keys at most max_depth levels below the root (see: visit_inorder).
+  ///\param max_depth Deepest level visited (0 visits the root only).
+  template <class F>
+  bool visit_bounded(const unsigned int max_depth, F f) const;
+
+
+  ///\brief A wrapper function to print RBT's keys (see: visit_inorder).
   ///\param choice The type of traversal: 1='in-order', 2='pre-order', 3='post-order'.
 	///\return A call to recursive_ordering which prints the keys.
   void print_ordered_keys(const unsigned int choice) const noexcept;
@@ -247,72 +697,320 @@ public:
 
 
   ///\brief Utility function to clear the whole RBTree.
+	///\param node The root of the tree (a non-root node detaches and frees its subtree only, unbalancing the tree).
 	///\return An empty tree.
   void clear_tree(NodePtr node) noexcept;
 
+
+  ///\brief Function to relocate every node into one contiguous block, in a cache-friendly order.
+  ///       Parent/child links are repointed; iterators and node pointers are invalidated.
+  ///\param layout IN_ORDER (best for scans) or VAN_EMDE_BOAS (best for lookups).
+  void compact(const Layout layout=IN_ORDER);
+
+
+  ///\brief Function to copy every node into one contiguous block, without touching the tree.
+  ///       Only reads the tree, so it can run on a background thread while other threads keep reading
+  ///       (see: compact_in_background); the result is installed by commit_compaction.
+  ///\param layout IN_ORDER (best for scans) or VAN_EMDE_BOAS (best for lookups).
+  ///\return The relocated nodes.
+  CompactedLayout prepare_compaction(const Layout layout=IN_ORDER) const;
+
+
+  ///\brief Function to run prepare_compaction on a background thread.
+  ///       The tree must not be modified (nor destroyed) until the future is ready.
+  ///\param layout IN_ORDER (best for scans) or VAN_EMDE_BOAS (best for lookups).
+  ///\return A future to the relocated nodes, to be passed to commit_compaction.
+  std::future<CompactedLayout> compact_in_background(const Layout layout=IN_ORDER) const;
+
+
+  ///\brief Function to swap the tree's nodes with a prepared layout, freeing the old ones.
+  ///\param prepared The relocated nodes (see: prepare_compaction).
+  ///\return Bool false (and prepared is discarded) if the tree has been modified since the preparation,
+  ///        or if the layout was prepared on another tree.
+  bool commit_compaction(CompactedLayout&& prepared) noexcept;
+
+
+  ///\brief Function to measure how fragmented and scattered the nodes are (see: LayoutStats).
+  ///\return The layout metrics, in O(n).
+  LayoutStats layout_stats() const;
+
 };
 // --------------------------------IMPLEMENTATION------------------------------------------
 
 // private methods
 
-template <class T, class CMP>
-void RBTree<T, CMP>::copy(NodePtr& copied, NodePtr new_parent, NodePtr other_rbt) {
-  if (other_rbt==nullptr) {
-    copied = nullptr;
+template <class T, class CMP, class AUG, class ALLOC>
+template <class Make>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::copy(const NodePtr& source, const NodePtr& source_nil,
+                                                                              NodePtr parent, Make make) const {
+  auto is_leaf = [&source_nil](const NodePtr& node) { return node==source_nil or node==nullptr; };
+  if (is_leaf(source)) {
+    return NIL;
+  }
+  NodePtr copied{make(*source)}; // copies key, color and aggregate, links are set below
+  copied->parent = parent;
+  copied->left = copied->right = NIL;
+  NodePtr from{source}, to{copied};
+  for (;;) {
+    if (!is_leaf(from->left) and to->left==NIL) { // left subtree not copied yet
+      to->left = make(*from->left);
+      to->left->parent = to;
+      from = from->left;
+      to = to->left;
+    } else if (!is_leaf(from->right) and to->right==NIL) { // then the right one
+      to->right = make(*from->right);
+      to->right->parent = to;
+      from = from->right;
+      to = to->right;
+    } else if (from==source) {
+      return copied;
+    } else { // subtree done, back to the parent
+      from = from->parent;
+      to = to->parent;
+      continue;
+    }
+    to->left = to->right = NIL;
+  }
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::exchange(RBTree& rbt) noexcept {
+  using std::swap;
+  pool.swap_content(rbt.pool);
+  swap(root, rbt.root);
+  swap(NIL, rbt.NIL);
+  swap(leftmost, rbt.leftmost);
+  swap(rightmost, rbt.rightmost);
+  swap(comparator, rbt.comparator);
+  swap(modifications, rbt.modifications);
+  ++modifications; // layouts prepared for either tree are stale
+  ++rbt.modifications;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::swap(RBTree& rbt) noexcept {
+  exchange(rbt);
+  if constexpr (NodeTraits::propagate_on_container_swap::value) {
+    pool.swap_allocator(rbt.pool);
+  }
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::release_nodes() noexcept {
+  if constexpr (!trivial_nodes) {
+    if (pool.size()>0) { // a moved-from tree owns no node
+      destroy_subtree(root);
+    }
+  }
+  pool.release();
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::destroy_subtree(NodePtr node) noexcept {
+  if (node==NIL or node==nullptr) {
+    return;
+  }
+  const NodePtr start{node};
+  for (;;) { // post-order through the parent links: no recursion, no stack, nothing allocated
+    if (node->left!=NIL and node->left!=nullptr) {
+      node = node->left;
+    } else if (node->right!=NIL and node->right!=nullptr) {
+      node = node->right;
+    } else { // both children gone: the node goes, and its parent forgets it
+      NodePtr parent{node->parent};
+      const bool last{node==start};
+      if (!last) {
+        (parent->left==node ? parent->left : parent->right) = NIL;
+      }
+      pool.destroy(node);
+      if (last) {
+        return;
+      }
+      node = parent;
+    }
+  }
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::veb_order(const NodePtr& node, const unsigned int height, std::vector<NodePtr>& order) const {
+  if (node==NIL or node==nullptr or height==0) {
+    return;
+  }
+  if (height==1) {
+    order.push_back(node);
+    return;
+  }
+  unsigned int bottom{height/2}, top{height-bottom};
+  veb_order(node, top, order); // top levels first
+  std::vector<NodePtr> bottom_roots;
+  collect_at_depth(node, top, bottom_roots);
+  for (const NodePtr& bottom_root : bottom_roots) { // then each bottom subtree, left to right
+    veb_order(bottom_root, bottom, order);
+  }
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::collect_at_depth(const NodePtr& node, const unsigned int depth, std::vector<NodePtr>& nodes) const {
+  if (node==NIL or node==nullptr) {
+    return;
+  }
+  if (depth==0) {
+    nodes.push_back(node);
+    return;
+  }
+  collect_at_depth(node->left, depth-1, nodes);
+  collect_at_depth(node->right, depth-1, nodes);
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+template <class F>
+bool RBTree<T, CMP, AUG, ALLOC>::call_visitor(F& f, const T& key, const unsigned int depth) {
+  if constexpr (std::is_invocable<F&, const T&, unsigned int>::value) {
+    if constexpr (std::is_same<std::invoke_result_t<F&, const T&, unsigned int>, bool>::value) {
+      return f(key, depth);
+    } else {
+      f(key, depth);
+      return true;
+    }
   } else {
-    copied = new Node;
-    copied->data = other_rbt->data;
-    copied->color = other_rbt->color;
-    copied->parent = new_parent;
-    copy(copied->left, copied, other_rbt->left);
-    copy(copied->right, copied, other_rbt->right);
+    if constexpr (std::is_same<std::invoke_result_t<F&, const T&>, bool>::value) {
+      return f(key);
+    } else {
+      f(key);
+      return true;
+    }
   }
 }
 
 
-template <class T, class CMP>
-void RBTree<T, CMP>::recursive_ordering(const NodePtr& root, const int choice) const {
-  if (root!=NIL) {
-    switch (choice) {
-      case 1: //in-order traversal (left-root-right)
-        recursive_ordering(root->left, choice);
-        std::cout << root->data << " | ";
-        recursive_ordering(root->right, choice);
-        break;
-      case 2: //pre-order traversal (root-left-right)
-        std::cout << root->data << " | ";
-        recursive_ordering(root->left, choice);
-        recursive_ordering(root->right, choice);
-        break;
-      case 3: //post-order traversal (left-right-root)
-        recursive_ordering(root->left, choice);
-        recursive_ordering(root->right, choice);
-        std::cout << root->data << " | ";
-        break;
-      default:
-        // choice doesn't match any available case (1, 2, 3)
-        std::cout << "Invalid option, please review your choice";
-        break;
-    }
-  }
-}
-
-
-template <class T, class CMP>
-typename RBTree<T, CMP>::NodePtr RBTree<T, CMP>::recursive_search(const NodePtr& root, const T& value) const {
-  if (value==root->data or root==NIL) {
+template <class T, class CMP, class AUG, class ALLOC>
+template <unsigned int choice, class F>
+bool RBTree<T, CMP, AUG, ALLOC>::walk(const NodePtr& start, const unsigned int max_depth, F&& f) const {
+  auto is_node = [this](const NodePtr& node) { return node!=NIL and node!=nullptr; };
+  if (!is_node(start)) {
+    return true;
+  }
+  NodePtr node{start}, previous{start->parent};
+  unsigned int depth{0};
+  for (;;) {
+    bool from_right{previous!=node->parent and previous!=node->left};
+    if (previous==node->parent) { // arriving from above
+      if (choice==2 and !f(node->data, depth)) {
+        return false;
+      }
+      if (depth<max_depth and is_node(node->left)) {
+        previous = node;
+        node = node->left;
+        ++depth;
+        continue;
+      }
+    }
+    if (!from_right) { // left subtree done (or skipped)
+      if (choice==1 and !f(node->data, depth)) {
+        return false;
+      }
+      if (depth<max_depth and is_node(node->right)) {
+        previous = node;
+        node = node->right;
+        ++depth;
+        continue;
+      }
+    }
+    if (choice==3 and !f(node->data, depth)) { // both subtrees done
+      return false;
+    }
+    if (node==start) {
+      return true;
+    }
+    previous = node;
+    node = node->parent;
+    --depth;
+  }
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::branchless_search(NodePtr node, const T& value, NodePtr& last) const noexcept {
+  typedef _OrderedKey<T> Key;
+  const auto probe{Key::compared(value)};
+  const NodePtr nil{NIL}; // locals: stores through last could alias the members
+  std::uintptr_t candidate{reinterpret_cast<std::uintptr_t>(nil)}; // last node whose key is not smaller than value
+  NodePtr parent{nullptr};
+  while (node!=nil and node!=nullptr) {
+    parent = node;
+    // all ones if the descent goes right: children and candidate are picked by masks, not by jumps
+    const std::uintptr_t right{std::uintptr_t{0}-std::uintptr_t(Key::compared(node->data)<probe)};
+    candidate = (candidate & right) | (reinterpret_cast<std::uintptr_t>(node) & ~right);
+    node = reinterpret_cast<NodePtr>((reinterpret_cast<std::uintptr_t>(node->left) & ~right)
+                                     | (reinterpret_cast<std::uintptr_t>(node->right) & right));
+  }
+  last = parent;
+  NodePtr found{reinterpret_cast<NodePtr>(candidate)};
+  return (found!=nil and Key::compared(found->data)==probe) ? found : nil;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::build_balanced(Node* slots, const std::vector<T>& keys,
+    const std::size_t low, const std::size_t high, NodePtr parent, const unsigned int depth, const unsigned int red_depth) noexcept {
+  if (low==high) {
+    return NIL;
+  }
+  std::size_t middle{low+(high-low)/2};
+  NodePtr node{new (slots+middle) Node(keys[middle], depth==red_depth ? RED : BLACK, parent)};
+  node->left = build_balanced(slots, keys, low, middle, node, depth+1, red_depth);
+  node->right = build_balanced(slots, keys, middle+1, high, node, depth+1, red_depth);
+  if constexpr (augmented) {
+    update_aggregate(node);
+  }
+  return node;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::recursive_search(const NodePtr& root, const T& value) const {
+  if constexpr (arithmetic) {
+    NodePtr last;
+    return branchless_search(root, value, last);
+  }
+  if (root==NIL) {
     return root;
   }
   if (comparator(value, root->data)) {
     return recursive_search(root->left, value);
-  } else {
+  } else if (comparator(root->data, value)) {
     return recursive_search(root->right, value);
   }
+  return root; // equivalent for the comparator (keys need no operator==)
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+template <class K>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::search_key(const K& key) const noexcept {
+  NodePtr node{root};
+  while (node!=NIL and node!=nullptr) {
+    if (comparator(key, node->data)) {
+      node = node->left;
+    } else if (comparator(node->data, key)) {
+      node = node->right;
+    } else {
+      return node;
+    }
+  }
+  return NIL;
 }
 
 
-template<class T, class CMP>
-void RBTree<T, CMP>::recursive_print(const NodePtr& root, const std::string& indentation, const bool is_right) const noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::recursive_print(const NodePtr& root, const std::string& indentation, const bool is_right) const noexcept {
   std::string h_branch {"        "};
   if (root->right) {
     recursive_print(root->right, indentation+(is_right ? h_branch : "L"+h_branch), 1);
@@ -325,9 +1023,9 @@ void RBTree<T, CMP>::recursive_print(const NodePtr& root, const std::string& ind
 }
 
 
-template <class T, class CMP>
-void RBTree<T, CMP>::node_replacement(const NodePtr& replaced, const NodePtr& replacer) noexcept {
-  if (replaced->parent==NIL) { // if node's parent is NIL 
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::node_replacement(const NodePtr& replaced, const NodePtr& replacer) noexcept {
+  if (replaced->parent==nullptr) { // if node has no parent (it is the root)
     root=replacer;   // A: replacer becomes new root
   } else if (replaced==replaced->parent->right) { // if node is right child
     replaced->parent->right=replacer; // B: replacer becomes right child
@@ -338,8 +1036,64 @@ void RBTree<T, CMP>::node_replacement(const NodePtr& replaced, const NodePtr& re
 }
 
 
-template <class T, class CMP>
-void RBTree<T, CMP>::node_rotation(NodePtr node, const bool to_right) noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::update_aggregate(const NodePtr& node) noexcept {
+  node->aggregate = AUG::combine(AUG::combine(node->left->aggregate, AUG::lift(node->data)), node->right->aggregate);
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::refresh_upwards(NodePtr node) noexcept {
+  while (node!=nullptr and node!=NIL) {
+    update_aggregate(node);
+    node = node->parent;
+  }
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::refresh_extremes() noexcept {
+  if (root==NIL or root==nullptr) {
+    leftmost = rightmost = NIL;
+    return;
+  }
+  for (leftmost = root; leftmost->left!=NIL and leftmost->left!=nullptr; leftmost = leftmost->left) {}
+  for (rightmost = root; rightmost->right!=NIL and rightmost->right!=nullptr; rightmost = rightmost->right) {}
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename AUG::value_type RBTree<T, CMP, AUG, ALLOC>::aggregate_from(NodePtr node, const T& lower) const noexcept {
+  typename AUG::value_type acc{AUG::identity()}; // keys found so far, all greater than the ones still to visit
+  while (node!=NIL) {
+    if (comparator(node->data, lower)) { // node and its left subtree are out of range
+      node = node->right;
+    } else { // node and its right subtree are in range
+      acc = AUG::combine(AUG::combine(AUG::lift(node->data), node->right->aggregate), acc);
+      node = node->left;
+    }
+  }
+  return acc;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename AUG::value_type RBTree<T, CMP, AUG, ALLOC>::aggregate_until(NodePtr node, const T& upper) const noexcept {
+  typename AUG::value_type acc{AUG::identity()}; // keys found so far, all smaller than the ones still to visit
+  while (node!=NIL) {
+    if (comparator(node->data, upper)) { // node and its left subtree are in range
+      acc = AUG::combine(acc, AUG::combine(node->left->aggregate, AUG::lift(node->data)));
+      node = node->right;
+    } else { // node and its right subtree are out of range
+      node = node->left;
+    }
+  }
+  return acc;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::node_rotation(NodePtr node, const bool to_right) noexcept {
   NodePtr _node;
   if (to_right) { // right rotation
     _node = node->left; // keep pivot left child
@@ -373,11 +1127,15 @@ void RBTree<T, CMP>::node_rotation(NodePtr node, const bool to_right) noexcept {
     _node->left = node; // pivot's right-left granchild becomes pivot
   }
   node->parent = _node; // pivot's parent becomes pivot's left or right child
+  if constexpr (augmented) { // only the two rotated nodes change subtree
+    update_aggregate(node);
+    update_aggregate(_node);
+  }
 }
 
 
-template<class T, class CMP>
-void RBTree<T, CMP>::rebalance_on_insert(NodePtr& node) noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::rebalance_on_insert(NodePtr& node) noexcept {
   // details on cases at sources:
   // https://en.wikipedia.org/wiki/Red-black_tree
   // https://www.geeksforgeeks.org/red-black-tree-set-2-insert/
@@ -421,8 +1179,8 @@ void RBTree<T, CMP>::rebalance_on_insert(NodePtr& node) noexcept {
 } // case: node's parent is BLACK omitted as no violations I
 
 
-template <class T, class CMP>
-void RBTree<T, CMP>::rebalance_on_delete(NodePtr& node) noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::rebalance_on_delete(NodePtr& node) noexcept {
   // details on cases at sources:
   // https://en.wikipedia.org/wiki/Red-black_tree
   // https://www.geeksforgeeks.org/red-black-tree-set-3-delete-2/
@@ -481,16 +1239,26 @@ void RBTree<T, CMP>::rebalance_on_delete(NodePtr& node) noexcept {
 }
 
 
-template<class T, class CMP>
-void RBTree<T, CMP>::delete_adjustment(const NodePtr& node, const T& value) noexcept {
-  NodePtr node_A{NIL}, node_B{NIL}, node_C{NIL}; // temporary helper nodes
-  if(recursive_search(node, value)!=NIL) {
-    node_A = recursive_search(node, value); // if found, node_A stores the node to be canceled
-  } else {
-    std::cout << "Value " << value << " not found" << std::endl;
-    return;
-  } // proceed similarly to a bst tree deletion
-  node_B = node_A; // node_B becomes node_A
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::delete_adjustment(const NodePtr& node, const T& value) noexcept {
+  NodePtr node_A{recursive_search(node, value)};
+  if (node_A!=NIL) { // if found, node_A stores the node to be canceled
+    unlink(node_A);
+  }
+  return node_A; // node_A is now unlinked, the caller decides when to free it
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::unlink(NodePtr node_A) noexcept {
+  NodePtr node_B{node_A}, node_C{NIL}; // temporary helper nodes, proceed similarly to a bst tree deletion
+  ++modifications;
+  if (node_A==leftmost) { // the in-order successor becomes the smallest key (identity kept by the relinking below)
+    leftmost = node_A->right!=NIL ? get_leftmost(node_A->right) : (node_A->parent!=nullptr ? node_A->parent : NIL);
+  }
+  if (node_A==rightmost) { // likewise, the predecessor becomes the largest key
+    rightmost = node_A->left!=NIL ? get_rightmost(node_A->left) : (node_A->parent!=nullptr ? node_A->parent : NIL);
+  }
   Color B_color{node_B->color}; // save original color of node_B node
   if (node_A->left==NIL) { // case: node_A has no left child I
     node_C = node_A->right; // -node_C becomes node_A's right child
@@ -514,7 +1282,9 @@ void RBTree<T, CMP>::delete_adjustment(const NodePtr& node, const T& value) noex
     node_B->left->parent = node_B; // node_B's left child's parent becomes node_B
     node_B->color = node_A->color; // node_B's color becomes node_A's color
   }
-  delete node_A; // case: node_A is a leaf node (direct deletion) I
+  if constexpr (augmented) { // node_C's parent is the lowest node which lost a key
+    refresh_upwards(node_C->parent);
+  }
   if (B_color==BLACK) { // if node_B was BLACK, we need to fix the tree (if RED we are done)
     rebalance_on_delete(node_C); // double black extra node C
   }
@@ -522,8 +1292,8 @@ void RBTree<T, CMP>::delete_adjustment(const NodePtr& node, const T& value) noex
 
 // public methods
 
-template <class T, class CMP>
-typename RBTree<T, CMP>::NodePtr RBTree<T, CMP>::get_root() const {
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::get_root() const {
   if(this->root==nullptr) {
     return nullptr;
   }
@@ -531,17 +1301,25 @@ typename RBTree<T, CMP>::NodePtr RBTree<T, CMP>::get_root() const {
 }
 
 
-template <class T, class CMP>
-unsigned int RBTree<T, CMP>::get_height(const NodePtr& root) const noexcept {
-  if (root==NIL) {
-    return 0;
-  }
-  return std::max(get_height(root->left), get_height(root->right))+1; 
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::get_nil() const noexcept {
+  return this->NIL;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+unsigned int RBTree<T, CMP, AUG, ALLOC>::get_height(const NodePtr& root) const noexcept {
+  unsigned int height{0};
+  walk<2>(root, ~0u, [&height](const T&, const unsigned int depth) {
+    height = std::max(height, depth+1);
+    return true;
+  });
+  return height;
 } 
 
 
-template<class T, class CMP>
-typename RBTree<T, CMP>::NodePtr RBTree<T, CMP>::get_leftmost(NodePtr node) const noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::get_leftmost(NodePtr node) const noexcept {
   while (node->left!=NIL) {
     node = node->left;
   }
@@ -549,8 +1327,8 @@ typename RBTree<T, CMP>::NodePtr RBTree<T, CMP>::get_leftmost(NodePtr node) cons
 }
 
 
-template<class T, class CMP>
-typename RBTree<T, CMP>::NodePtr RBTree<T, CMP>::get_rightmost(NodePtr node) const noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::get_rightmost(NodePtr node) const noexcept {
   while (node->right!=NIL) {
     node = node->right;
   }
@@ -558,22 +1336,36 @@ typename RBTree<T, CMP>::NodePtr RBTree<T, CMP>::get_rightmost(NodePtr node) con
 }
 
 
-template <class T, class CMP>
-void RBTree<T, CMP>::insert(const T& value) noexcept {
-  NodePtr node{new Node(value, RED)};
-  node->left = node->right = NIL;
+template <class T, class CMP, class AUG, class ALLOC>
+bool RBTree<T, CMP, AUG, ALLOC>::insert(const T& value) noexcept {
+  own_nil();
   NodePtr node_B{nullptr}; // temporary helper node_B
   NodePtr node_A{get_root()}; // temporary helper node_A
-  while (node_A!=NIL) { // root is different than NIL
-    node_B = node_A;  // keep track of previous node (possible parent)
-    if (comparator(node->data, node_A->data)) {
-      node_A = node_A->left; 
-    } else if (comparator(node_A->data, node->data)) {
-      node_A = node_A->right;
-    } else {
-      return; // value already exists
+  if constexpr (arithmetic) {
+    if (branchless_search(node_A, value, node_B)!=NIL) {
+      return false; // value already exists (nothing allocated yet)
+    }
+  } else {
+    while (node_A!=NIL) { // root is different than NIL
+      node_B = node_A;  // keep track of previous node (possible parent)
+      if (comparator(value, node_A->data)) {
+        node_A = node_A->left; 
+      } else if (comparator(node_A->data, value)) {
+        node_A = node_A->right;
+      } else {
+        return false; // value already exists (nothing allocated yet)
+      }
     }
   }
+  NodePtr node{pool.create(value, RED)};
+  ++modifications;
+  node->left = node->right = NIL;
+  if (leftmost==NIL or comparator(value, leftmost->data)) { // new smallest key
+    leftmost = node;
+  }
+  if (rightmost==NIL or comparator(rightmost->data, value)) { // new largest key
+    rightmost = node;
+  }
   node->parent = node_B; // node's parent becomes node_B
     if (node_B==nullptr) {
       this->root = node;  // if tree was empty, node becomes root
@@ -582,99 +1374,336 @@ void RBTree<T, CMP>::insert(const T& value) noexcept {
     } else { // node's bigger than node_B
       node_B->right = node; // node becomes node_B's right child
     }
+    if constexpr (augmented) { // every ancestor gained a key (before rotations, which stay local)
+      refresh_upwards(node_B);
+    }
     if (node->parent==nullptr) { // recolor when node's parent is NIL
       node->color = BLACK;
-      return;
+      return true;
     }
     if (node->parent->parent==nullptr) {
-      return;
+      return true;
     }
     rebalance_on_insert(node);
+    return true;
 }
 
 
-template <class T, class CMP>
-bool RBTree<T, CMP>::contains(const T& value) const noexcept {
-  if (recursive_search(get_root(), value)->data==value) {
-    return true;
+template <class T, class CMP, class AUG, class ALLOC>
+template <class InputIt>
+void RBTree<T, CMP, AUG, ALLOC>::bulk_load(InputIt first, InputIt last) {
+  std::vector<T> keys;
+  visit_inorder([&keys](const T& key) { keys.push_back(key); }); // keys already stored come first
+  keys.insert(keys.end(), first, last);
+  if constexpr (arithmetic) {
+    _radix_sort(keys);
   } else {
-    return false;
+    std::stable_sort(keys.begin(), keys.end(), comparator);
   }
+  keys.erase(std::unique(keys.begin(), keys.end(), [this](const T& a, const T& b) {
+    return !comparator(a, b) and !comparator(b, a);
+  }), keys.end());
+  release_nodes();
+  ++modifications;
+  if (keys.empty()) {
+    root = leftmost = rightmost = NIL;
+    return;
+  }
+  own_nil();
+  unsigned int red_depth{0}; // floor(log2(n+1)): the levels above are complete
+  for (std::size_t complete{keys.size()+1}; complete>1; complete >>= 1) {
+    ++red_depth;
+  }
+  Node* slots{pool.allocate_block(keys.size())}; // nodes are laid out in order
+  root = build_balanced(slots, keys, 0, keys.size(), nullptr, 0, red_depth);
+  leftmost = slots;
+  rightmost = slots+keys.size()-1;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+bool RBTree<T, CMP, AUG, ALLOC>::contains(const T& value) const noexcept {
+  return recursive_search(get_root(), value)!=NIL; // NIL's key is T{}, never compare against it
 }
 
 
-template <class T, class CMP>
-const T& RBTree<T, CMP>::find(const T& value) const noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+const T& RBTree<T, CMP, AUG, ALLOC>::find(const T& value) const noexcept {
     return recursive_search(root, value)->data;
 }
 
 
-template <class T, class CMP>
-void RBTree<T, CMP>::delete_(const T& value) noexcept {
-  delete_adjustment(get_root(), value);
+template <class T, class CMP, class AUG, class ALLOC>
+template <class F>
+bool RBTree<T, CMP, AUG, ALLOC>::modify(const T& value, F f) {
+  NodePtr node{recursive_search(root, value)};
+  if (node==NIL) {
+    return false;
+  }
+  f(node->data);
+  if constexpr (augmented) {
+    refresh_upwards(node);
+  }
+  ++modifications; // layouts prepared before hold the previous key
+  return true;
 }
 
 
-template <class T, class CMP>
-typename RBTree<T, CMP>::const_iterator RBTree<T, CMP>::begin() const noexcept {
-  return const_iterator(get_leftmost(get_root()));
+template <class T, class CMP, class AUG, class ALLOC>
+bool RBTree<T, CMP, AUG, ALLOC>::delete_(const T& value) noexcept {
+  NodePtr node{delete_adjustment(get_root(), value)};
+  if (node==NIL) {
+    if constexpr (_is_printable<T>::value) { // records need no operator<<
+      std::cout << "Value " << value << " not found" << std::endl;
+    }
+    return false;
+  }
+  pool.destroy(node); // node is unlinked from the tree (direct deletion)
+  return true;
 }
 
 
-template <class T, class CMP>
-typename RBTree<T, CMP>::const_iterator RBTree<T, CMP>::end() const noexcept {
-  return const_iterator(nullptr);
+template <class T, class CMP, class AUG, class ALLOC>
+template <class K, class C, class>
+bool RBTree<T, CMP, AUG, ALLOC>::delete_(const K& key) noexcept {
+  NodePtr node{search_key(key)};
+  if (node==NIL) {
+    if constexpr (_is_printable<K>::value) {
+      std::cout << "Value " << key << " not found" << std::endl;
+    }
+    return false;
+  }
+  unlink(node);
+  pool.destroy(node);
+  return true;
 }
 
 
-template <class T, class CMP>
-typename RBTree<T, CMP>::const_iterator RBTree<T, CMP>::rbegin() const noexcept {
-  return const_iterator(get_rightmost(get_root()));
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::apply_delta(const Delta<T>& delta) {
+  for (const T& key : delta.removed) {
+    NodePtr node{delete_adjustment(root, key)};
+    if (node!=NIL) { // quietly skip keys already absent
+      pool.destroy(node);
+    }
+  }
+  std::size_t depth{1};
+  for (std::size_t stored{pool.size()}; stored>1; stored >>= 1) {
+    ++depth;
+  }
+  if (delta.added.size()*depth<pool.size()) { // k inserts in O(k log n) beat a O(n+k) rebuild
+    for (const T& key : delta.added) {
+      insert(key);
+    }
+  } else {
+    bulk_load(delta.added.begin(), delta.added.end());
+  }
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+T RBTree<T, CMP, AUG, ALLOC>::pop_min() {
+  NodePtr node{leftmost};
+  T value{std::move(node->data)};
+  unlink(node); // node has no left child: no successor to search
+  pool.destroy(node);
+  return value;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+T RBTree<T, CMP, AUG, ALLOC>::pop_max() {
+  NodePtr node{rightmost};
+  T value{std::move(node->data)};
+  unlink(node); // node has no right child
+  pool.destroy(node);
+  return value;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::const_iterator RBTree<T, CMP, AUG, ALLOC>::begin() const noexcept {
+  return const_iterator(leftmost!=NIL ? leftmost : nullptr, this);
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::const_iterator RBTree<T, CMP, AUG, ALLOC>::lower_bound(const T& value) const noexcept {
+  NodePtr node{root}, bound{nullptr}; // nullptr is end()
+  while (node!=NIL and node!=nullptr) {
+    if (comparator(node->data, value)) {
+      node = node->right;
+    } else { // candidate, a smaller one may lie on the left
+      bound = node;
+      node = node->left;
+    }
+  }
+  return const_iterator(bound, this);
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+template <class K, class C, class>
+typename RBTree<T, CMP, AUG, ALLOC>::const_iterator RBTree<T, CMP, AUG, ALLOC>::lower_bound(const K& key) const noexcept {
+  NodePtr node{root}, bound{nullptr}; // nullptr is end()
+  while (node!=NIL and node!=nullptr) {
+    if (comparator(node->data, key)) {
+      node = node->right;
+    } else {
+      bound = node;
+      node = node->left;
+    }
+  }
+  return const_iterator(bound, this);
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::const_iterator RBTree<T, CMP, AUG, ALLOC>::end() const noexcept {
+  return const_iterator(nullptr, this);
 }
 
 
-template <class T, class CMP>
-typename RBTree<T, CMP>::const_iterator RBTree<T, CMP>::rend() const noexcept {
-  return const_iterator(nullptr);
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::const_iterator RBTree<T, CMP, AUG, ALLOC>::rbegin() const noexcept {
+  return const_iterator(rightmost!=NIL ? rightmost : nullptr, this);
 }
 
 
-template<class T, class CMP>
-typename RBTree<T, CMP>::NodePtr RBTree<T, CMP>::get_successor(NodePtr node) const noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::const_iterator RBTree<T, CMP, AUG, ALLOC>::rend() const noexcept {
+  return const_iterator(nullptr, this);
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename AUG::value_type RBTree<T, CMP, AUG, ALLOC>::aggregate() const noexcept {
+  static_assert(augmented, "aggregate() requires an augmentation policy");
+  return root->aggregate;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename AUG::value_type RBTree<T, CMP, AUG, ALLOC>::aggregate(const T& lower, const T& upper) const noexcept {
+  static_assert(augmented, "aggregate() requires an augmentation policy");
+  NodePtr node{root};
+  while (node!=NIL) { // descend to the highest node within the range (where both bounds' paths split)
+    if (comparator(node->data, lower)) {
+      node = node->right;
+    } else if (!comparator(node->data, upper)) {
+      node = node->left;
+    } else {
+      return AUG::combine(AUG::combine(aggregate_from(node->left, lower), AUG::lift(node->data)),
+                          aggregate_until(node->right, upper));
+    }
+  }
+  return AUG::identity(); // empty range
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::get_successor(NodePtr node) const noexcept {
   if (node->right!=NIL) {
     return get_leftmost(node->right); //leftmost node on right subtree
   }
-  while (node==node->parent->right and node->parent!=NIL) {
+  NodePtr parent{node->parent};
+  while (parent!=nullptr and node==parent->right) {
     // lowest ancestor whose left child is a node's ancestor as well
-    node = node->parent;
-    node->parent = node->parent->parent;
+    node = parent;
+    parent = parent->parent;
   }
-  return node->parent;
+  return parent==nullptr ? NIL : parent;
 }
 
 
-template<class T, class CMP>
-typename RBTree<T, CMP>::NodePtr RBTree<T, CMP>::get_predecessor(NodePtr node) const noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::NodePtr RBTree<T, CMP, AUG, ALLOC>::get_predecessor(NodePtr node) const noexcept {
   if (node->left!=NIL) {
     return get_rightmost(node->left); // rightmost node on left subtree
   }
-  while (node==node->parent->left and node->parent!=NIL) {
+  NodePtr parent{node->parent};
+  while (parent!=nullptr and node==parent->left) {
     // lowest ancestor whose right child is a node's ancestor as well
-    node = node->parent;
-    node->parent = node->parent->parent;
+    node = parent;
+    parent = parent->parent;
   }
-  return node->parent;
+  return parent==nullptr ? NIL : parent;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+template <class F>
+bool RBTree<T, CMP, AUG, ALLOC>::visit_inorder(F f) const {
+  return walk<1>(root, ~0u, [&f](const T& key, const unsigned int depth) { return call_visitor(f, key, depth); });
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+template <class F>
+bool RBTree<T, CMP, AUG, ALLOC>::visit_preorder(F f) const {
+  return walk<2>(root, ~0u, [&f](const T& key, const unsigned int depth) { return call_visitor(f, key, depth); });
 }
 
 
-template<class T, class CMP>
- void RBTree<T, CMP>::print_ordered_keys(const unsigned int choice) const noexcept {
-    recursive_ordering(get_root(), choice);
+template <class T, class CMP, class AUG, class ALLOC>
+template <class F>
+bool RBTree<T, CMP, AUG, ALLOC>::visit_postorder(F f) const {
+  return walk<3>(root, ~0u, [&f](const T& key, const unsigned int depth) { return call_visitor(f, key, depth); });
 }
 
 
-template <class T, class CMP>
-void RBTree<T, CMP>::print_tree() const noexcept {
+template <class T, class CMP, class AUG, class ALLOC>
+template <class F>
+bool RBTree<T, CMP, AUG, ALLOC>::visit_levelorder(F f) const {
+  for (unsigned int level{0}; ; ++level) {
+    bool reached{false}; // whether some node lies at this level
+    bool completed{walk<2>(root, level, [&](const T& key, const unsigned int depth) {
+      if (depth<level) {
+        return true;
+      }
+      reached = true;
+      return call_visitor(f, key, depth);
+    })};
+    if (!completed) {
+      return false;
+    }
+    if (!reached) {
+      return true;
+    }
+  }
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+template <class F>
+bool RBTree<T, CMP, AUG, ALLOC>::visit_bounded(const unsigned int max_depth, F f) const {
+  return walk<2>(root, max_depth, [&f](const T& key, const unsigned int depth) { return call_visitor(f, key, depth); });
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+ void RBTree<T, CMP, AUG, ALLOC>::print_ordered_keys(const unsigned int choice) const noexcept {
+  auto print = [](const T& key) { std::cout << key << " | "; };
+  switch (choice) {
+    case 1: //in-order traversal (left-root-right)
+      visit_inorder(print);
+      break;
+    case 2: //pre-order traversal (root-left-right)
+      visit_preorder(print);
+      break;
+    case 3: //post-order traversal (left-right-root)
+      visit_postorder(print);
+      break;
+    default:
+      // choice doesn't match any available case (1, 2, 3)
+      std::cout << "Invalid option, please review your choice";
+      break;
+  }
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::print_tree() const noexcept {
   if (root!=NIL) {
     recursive_print(get_root(), "", 1);
   } else {
@@ -683,18 +1712,166 @@ void RBTree<T, CMP>::print_tree() const noexcept {
 }
 
 
-template<class T, class CMP>
- void RBTree<T, CMP>::clear_tree(NodePtr node) noexcept {
-  if (node==nullptr) {
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::clear_tree(NodePtr node) noexcept {
+  if (node==nullptr or node==NIL) {
     return;
   }
-  delete(node->left); 
-  delete(node->right); 
-  delete node;  
-  //this->~RBTree(); //permanent alternative destruction
-  std::cout << "RBTree is now empty, nothing to print here!" << std::endl;
+  if (node==root) {
+    root = NIL;
+    std::cout << "RBTree is now empty, nothing to print here!" << std::endl;
+  } else if (node==node->parent->left) { // detach the subtree from its parent
+    node->parent->left = NIL;
+  } else {
+    node->parent->right = NIL;
   }
+  destroy_subtree(node);
+  refresh_extremes();
+  ++modifications;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+void RBTree<T, CMP, AUG, ALLOC>::compact(const Layout layout) {
+  commit_compaction(prepare_compaction(layout));
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+typename RBTree<T, CMP, AUG, ALLOC>::CompactedLayout RBTree<T, CMP, AUG, ALLOC>::prepare_compaction(const Layout layout) const {
+  CompactedLayout prepared{pool.get_allocator()};
+  prepared.nil = NIL;
+  prepared.modifications = modifications;
+  std::vector<NodePtr> order; // old nodes, in the order they will have in the block
+  order.reserve(pool.size());
+  if (layout==VAN_EMDE_BOAS) {
+    veb_order(root, get_height(root), order);
+  } else { // in-order traversal with an explicit stack
+    std::vector<NodePtr> stack;
+    NodePtr node{root};
+    while (!stack.empty() or (node!=NIL and node!=nullptr)) {
+      if (node!=NIL and node!=nullptr) {
+        stack.push_back(node);
+        node = node->left;
+      } else {
+        node = stack.back();
+        stack.pop_back();
+        order.push_back(node);
+        node = node->right;
+      }
+    }
+  }
+  std::vector<std::pair<NodePtr, NodePtr>> relocation(order.size()); // old node -> new node, sorted by old address
+  prepared.pool.reserve_exact(order.size());
+  for (std::size_t i{0}; i<order.size(); ++i) {
+    relocation[i] = {order[i], prepared.pool.create(*order[i])}; // copy of key, color, aggregate (and old links)
+  }
+  std::sort(relocation.begin(), relocation.end(), [](const auto& a, const auto& b) {
+    return std::less<NodePtr>{}(a.first, b.first);
+  });
+  auto relocated = [&](const NodePtr& old) -> NodePtr {
+    if (old==NIL or old==nullptr) { // NIL is shared by the old and new nodes
+      return old;
+    }
+    return std::lower_bound(relocation.begin(), relocation.end(), old, [](const auto& entry, const NodePtr& key) {
+      return std::less<NodePtr>{}(entry.first, key);
+    })->second;
+  };
+  for (const auto& entry : relocation) {
+    entry.second->left = relocated(entry.first->left);
+    entry.second->right = relocated(entry.first->right);
+    entry.second->parent = relocated(entry.first->parent);
+  }
+  prepared.root = relocated(root);
+  return prepared;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+std::future<typename RBTree<T, CMP, AUG, ALLOC>::CompactedLayout> RBTree<T, CMP, AUG, ALLOC>::compact_in_background(const Layout layout) const {
+  return std::async(std::launch::async, [this, layout]() { return prepare_compaction(layout); });
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+bool RBTree<T, CMP, AUG, ALLOC>::commit_compaction(CompactedLayout&& prepared) noexcept {
+  if (prepared.nil!=NIL or prepared.modifications!=modifications or prepared.root==nullptr) { // foreign, stale (or empty) layout
+    return false;
+  }
+  if constexpr (!trivial_nodes) {
+    destroy_subtree(root);
+  }
+  pool = std::move(prepared.pool); // old chunks are given back here
+  root = prepared.root;
+  prepared.root = nullptr;
+  refresh_extremes();
+  return true;
+}
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+LayoutStats RBTree<T, CMP, AUG, ALLOC>::layout_stats() const {
+  LayoutStats stats;
+  stats.slots = pool.capacity();
+  stats.chunks = pool.get_chunks().size();
+  const std::uintptr_t page{4096}, node_size{sizeof(Node)};
+  std::uintptr_t lowest{~std::uintptr_t{0}}, highest{0}, previous{0};
+  std::size_t adjacent{0}, links{0}, same_page{0};
+  double gaps{0};
+  std::vector<NodePtr> stack;
+  NodePtr node{root};
+  while (!stack.empty() or (node!=NIL and node!=nullptr)) { // in-order traversal with an explicit stack
+    if (node!=NIL and node!=nullptr) {
+      stack.push_back(node);
+      node = node->left;
+      continue;
+    }
+    node = stack.back();
+    stack.pop_back();
+    std::uintptr_t address{reinterpret_cast<std::uintptr_t>(node)};
+    lowest = std::min(lowest, address);
+    highest = std::max(highest, address);
+    if (stats.nodes>0) {
+      std::uintptr_t gap{address>previous ? address-previous : previous-address};
+      gaps += gap;
+      adjacent += (gap==node_size);
+    }
+    for (const NodePtr& child : {node->left, node->right}) {
+      if (child!=NIL and child!=nullptr) {
+        ++links;
+        same_page += (reinterpret_cast<std::uintptr_t>(child)/page==address/page);
+      }
+    }
+    previous = address;
+    ++stats.nodes;
+    node = node->right;
+  }
+  if (stats.nodes>0) {
+    stats.occupancy = stats.slots>0 ? double(stats.nodes)/stats.slots : 1;
+    stats.span = double(highest-lowest+node_size)/(stats.nodes*node_size);
+  }
+  if (stats.nodes>1) {
+    stats.mean_gap = gaps/(stats.nodes-1);
+    stats.adjacent_ratio = double(adjacent)/(stats.nodes-1);
+  }
+  if (links>0) {
+    stats.same_page_ratio = double(same_page)/links;
+  }
+  return stats;
+}
+
+
+namespace pmr {
+
+  ///\brief RBTree allocating its nodes from a std::pmr::memory_resource (as std::pmr::set does).
+  ///       With a std::pmr::monotonic_buffer_resource, trees of trivially destructible keys are torn
+  ///       down without visiting a node, the memory going back with the resource.
+  template <class T, class CMP=std::less<T>, class AUG=NoAugmentation>
+  using RBTree = ::RBTree<T, CMP, AUG, std::pmr::polymorphic_allocator<T>>;
+
+} // namespace pmr
 
 
 #include "RBT_iterator.hpp"
+#include "RBT_compressed.hpp"
 #endif // RBT_HPP
\ No newline at end of file
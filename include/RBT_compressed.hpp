@@ -0,0 +1,230 @@
+///\file RBT_compressed.hpp
+///\author mpv
+///\brief implementation of CompressedSnapshot, a read-only block-compressed copy of a RBTree of integer keys.
+
+
+#ifndef RBT_COMPRESSED_HPP
+#define RBT_COMPRESSED_HPP
+
+
+///\brief CompressedSnapshot holds sorted distinct integer keys in blocks of 128: each block keeps its first key,
+///       then the gaps between consecutive keys (minus one) bit-packed at the width of the block's largest gap.
+///       The largest key of every block forms a small index, binary searched before a single block is decoded.
+///       Dense or clustered keys take a few bits each, against the ~40 bytes of a RBTree node.
+///       Keys are handled through their order-preserving encoding (see: Key_traits.hpp), so signed keys work too.
+///\param T type of the keys, an integer.
+template <class T>
+class CompressedSnapshot {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef _OrderedKey<T> Ordered; ///< order-preserving encoding of the keys.
+
+
+  ///\brief Where and how a block is stored.
+  struct _Block {
+    std::uint64_t first;  ///< encoded first key of the block.
+    std::size_t word;     ///< first word of the block's packed gaps.
+    unsigned int width;   ///< bits per gap, 0 to 64.
+  };
+
+
+private:
+  std::vector<std::uint64_t> maxima; ///< encoded largest key of every block, searched first.
+  std::vector<_Block> blocks;        ///< one per 128 keys.
+  std::vector<std::uint64_t> words;  ///< packed gaps of every block, plus one padding word for two-word reads.
+  std::size_t count{0};              ///< number of keys.
+
+
+  ///\brief Helper function to read the bits [bit, bit+width) of the packed gaps (branch free).
+  std::uint64_t read(const std::size_t bit, const std::uint64_t mask) const noexcept {
+    const std::size_t word{bit>>6};
+    const unsigned int shift{unsigned(bit&63)};
+    return ((words[word]>>shift) | ((words[word+1]<<1)<<(63-shift))) & mask; // no shift by 64, whatever the offset
+  }
+
+
+  ///\brief Helper function to count the keys of a block (the last one may hold fewer than block_keys).
+  std::size_t keys_in(const std::size_t block) const noexcept {return std::min(block_keys, count-block*block_keys);}
+
+
+  ///\brief Helper function to compute the mask of width low bits.
+  static std::uint64_t mask_of(const unsigned int width) noexcept {return width==0 ? 0 : ~std::uint64_t{0}>>(64-width);}
+
+
+  ///\brief Helper function to pack the keys of a block (see: CompressedSnapshot's constructor).
+  void pack(const std::vector<std::uint64_t>& keys) {
+    std::uint64_t widest{0};
+    for (std::size_t i{1}; i<keys.size(); ++i) {
+      widest |= keys[i]-keys[i-1]-1;
+    }
+    unsigned int width{0};
+    for (; width<64 and (widest>>width)!=0; ++width) {}
+    const std::size_t start{words.size()-1}; // the padding word becomes the block's first one
+    blocks.push_back(_Block{keys.front(), start, width});
+    maxima.push_back(keys.back());
+    words.resize(start+((keys.size()-1)*width+63)/64+1, 0); // packed gaps, then a new padding word
+    for (std::size_t i{1}, bit{start*64}; i<keys.size(); ++i, bit += width) {
+      const std::uint64_t gap{keys[i]-keys[i-1]-1};
+      const unsigned int shift{unsigned(bit&63)};
+      words[bit>>6] |= gap<<shift;
+      if (shift+width>64) { // the gap spans two words
+        words[(bit>>6)+1] |= gap>>(64-shift);
+      }
+    }
+  }
+
+
+public:
+  static constexpr std::size_t block_keys{128}; ///< keys per block.
+
+  class const_iterator;
+
+
+  ///\brief CompressedSnapshot's constructor from sorted distinct keys (e.g. a RBTree's in-order walk, see: RBTree::compress).
+  ///\param first Beginning of the range of keys, in ascending order without duplicates.
+  ///\param last End of the range of keys.
+  template <class InputIt>
+  CompressedSnapshot(InputIt first, InputIt last) {
+    words.push_back(0); // padding word
+    std::vector<std::uint64_t> block;
+    block.reserve(block_keys);
+    for (; first!=last; ++first, ++count) {
+      block.push_back(std::uint64_t(Ordered::encode(*first)));
+      if (block.size()==block_keys) {
+        pack(block);
+        block.clear();
+      }
+    }
+    if (!block.empty()) {
+      pack(block);
+    }
+    maxima.shrink_to_fit();
+    blocks.shrink_to_fit();
+    words.shrink_to_fit();
+  }
+
+
+  ///\brief Function to find the first key not smaller than value: binary search of the block maxima,
+  ///       then a scan of one block, in O(log(n/128) + 128).
+  ///\return Iterator to the key, end() if every key is smaller.
+  const_iterator lower_bound(const T& value) const noexcept {
+    const std::uint64_t encoded{Ordered::encode(value)};
+    const std::size_t block(std::lower_bound(maxima.begin(), maxima.end(), encoded)-maxima.begin());
+    if (block==blocks.size()) {
+      return end();
+    }
+    const_iterator it{this, block};
+    while (it.key<encoded) { // the block's maximum is not smaller: the scan stops within the block
+      ++it;
+    }
+    return it;
+  }
+
+
+  ///\brief Function to test whether a key is stored (see: lower_bound).
+  bool contains(const T& value) const noexcept {
+    const_iterator it{lower_bound(value)};
+    return it!=end() and *it==value;
+  }
+
+
+  ///\brief Getter for the number of keys.
+  std::size_t size() const noexcept {return count;}
+
+  ///\brief Function to test whether the snapshot holds no key.
+  bool empty() const noexcept {return count==0;}
+
+  ///\brief Getter for the memory taken by the snapshot, in bytes (index and packed gaps).
+  std::size_t memory() const noexcept {
+    return sizeof(*this)+maxima.capacity()*sizeof(std::uint64_t)+blocks.capacity()*sizeof(_Block)+words.capacity()*sizeof(std::uint64_t);
+  }
+
+  ///\brief Function to get an iterator to the smallest key.
+  const_iterator begin() const noexcept {return blocks.empty() ? end() : const_iterator{this, 0};}
+
+  ///\brief Function to get the end of the keys.
+  const_iterator end() const noexcept {return const_iterator{this, blocks.size()};}
+
+};
+
+
+///\brief CompressedSnapshot's constant iterator: decodes one gap per step, keys are returned by value.
+template <class T>
+class CompressedSnapshot<T>::const_iterator {
+  friend class CompressedSnapshot;
+
+private:
+  const CompressedSnapshot* snapshot;  ///< the snapshot walked.
+  std::size_t block;                   ///< current block, blocks.size() at the end.
+  std::size_t index{0};                ///< position of the key within the block.
+  std::size_t bit{0};                  ///< position of the next gap in the packed words.
+  std::uint64_t mask{0};               ///< low bits of a gap of the current block.
+  std::uint64_t key{~std::uint64_t{0}}; ///< encoded current key (all ones at the end, above any key).
+
+
+  ///\brief Helper function to move to the first key of a block.
+  void enter(const std::size_t entered) noexcept {
+    block = entered;
+    index = 0;
+    if (block<snapshot->blocks.size()) {
+      const _Block& stored{snapshot->blocks[block]};
+      key = stored.first;
+      bit = stored.word*64;
+      mask = mask_of(stored.width);
+    } else {
+      key = ~std::uint64_t{0};
+    }
+  }
+
+public:
+  typedef std::input_iterator_tag iterator_category; ///< iterator traits, for the standard algorithms.
+  typedef T value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const T* pointer;
+  typedef T reference; ///< keys are decoded: no reference to them exists.
+
+
+  ///\brief CompressedSnapshot's iterator constructor.
+  ///\param walked The snapshot.
+  ///\param entered The block whose first key is pointed, blocks.size() for the end.
+  const_iterator(const CompressedSnapshot* walked, const std::size_t entered) noexcept: snapshot{walked} {enter(entered);}
+
+
+  ///\brief Decoded current key.
+  T operator*() const noexcept {return Ordered::decode(typename Ordered::bits_type(key));}
+
+
+  ///\brief Prefix increment: one gap decoded, or the next block entered.
+  const_iterator& operator++() noexcept {
+    if (++index<snapshot->keys_in(block)) {
+      key += snapshot->read(bit, mask)+1;
+      bit += snapshot->blocks[block].width;
+    } else {
+      enter(block+1);
+    }
+    return *this;
+  }
+
+
+  ///\brief Postfix increment.
+  const_iterator operator++(int) noexcept {
+    const_iterator retval{*this};
+    ++(*this);
+    return retval;
+  }
+
+  bool operator==(const const_iterator& other) const noexcept {return block==other.block and index==other.index;}
+  bool operator!=(const const_iterator& other) const noexcept {return !(*this==other);}
+
+};
+
+
+template <class T, class CMP, class AUG, class ALLOC>
+CompressedSnapshot<T> RBTree<T, CMP, AUG, ALLOC>::compress() const {
+  static_assert(std::is_integral<T>::value and !std::is_same<T, bool>::value and std::is_same<CMP, std::less<T>>::value,
+                "compress() needs integer keys ordered by std::less");
+  return CompressedSnapshot<T>(begin(), end());
+}
+
+
+#endif //RBT_COMPRESSED_HPP
@@ -0,0 +1,338 @@
+///\file RBT_concurrent.hpp
+///\author mpv
+///\brief single-writer / many-reader concurrent RBTree (optimistic readers, seqlock validation, epoch reclamation).
+
+#ifndef RBT_CONCURRENT_HPP
+#define RBT_CONCURRENT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "RBT.hpp"
+
+
+///\brief ConcurrentRBTree wraps a RBTree for a single writer and many lock-free readers.
+///       Readers never write shared memory while traversing: they read a version counter (seqlock),
+///       walk the tree optimistically and validate the counter at the end, retrying on conflict.
+///       Nodes unlinked by delete_ are not freed immediately, but retired with the current epoch
+///       and reclaimed only once every active reader has moved past that epoch.
+///       A reader may compare and copy a key before validating: it may then see a key still being written
+///       (the writer links nodes with plain stores), so keys are restricted to trivially copyable types,
+///       and CMP must not fail on a torn key (no pointer it would follow, e.g. no const char*).
+///       The copy or comparison of a torn key is discarded by the validation.
+///\param T type of the tree nodes' keys, trivially copyable.
+///\param CMP relational function to compare nodes' keys (default std::less<T>).
+template <class T, class CMP=std::less<T>>
+class ConcurrentRBTree {
+  static_assert(std::is_trivially_copyable<T>::value, "optimistic readers may copy or compare a key being written");
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef RBTree<T, CMP> Tree;            ///< type of the wrapped tree.
+  typedef typename Tree::NodePtr NodePtr; ///< type of pointer to templated tree's node.
+
+
+public:
+  static constexpr unsigned int max_readers{64};      ///< number of reader slots (concurrent reader handles).
+  static constexpr unsigned int max_depth{130};       ///< longest admissible path (2*log2(n+1) for 64 bits n).
+  static constexpr std::size_t reclaim_threshold{64}; ///< retired nodes accumulated before trying reclamation.
+  static constexpr std::uint64_t idle{~std::uint64_t{0}}; ///< epoch of a slot whose reader is not traversing.
+
+  ///\brief Per-thread handle used to perform lock-free reads (see: reader()).
+  class reader;
+
+
+private:
+  ///\brief Reader's slot, padded to a cache line so that readers never share a written line.
+  struct alignas(64) Slot {
+    std::atomic<std::uint64_t> epoch{idle}; ///< epoch observed when the traversal started (idle otherwise).
+    std::atomic<bool> taken{false};         ///< whether a reader handle currently owns the slot.
+  };
+
+  Tree tree; ///< the wrapped RBTree (mutated by the writer only).
+  std::mutex writer_lock; ///< serializes writers (never touched by readers).
+  std::vector<std::pair<std::uint64_t, NodePtr>> limbo; ///< retired nodes with their retirement epoch.
+  alignas(64) std::atomic<std::uint64_t> sequence{0}; ///< seqlock version, odd while a write is in progress.
+  alignas(64) std::atomic<std::uint64_t> global_epoch{1}; ///< current reclamation epoch.
+  Slot slots[max_readers]; ///< readers' slots.
+
+
+  ///\brief Reads a link that the writer may be changing at the same time.
+  ///       Links are word-sized, the volatile access keeps the compiler from caching or splitting the load.
+  ///\param link The link (child pointer or root) to be read.
+  ///\return The current value of the link.
+  static NodePtr load_link(const NodePtr& link) noexcept {
+    return *static_cast<const volatile NodePtr*>(&link);
+  }
+
+
+  ///\brief Optimistic descent from the root, looking for a value (see: reader::find).
+  ///\param value The value of the key you are searching within the RBTree.
+  ///\param found Node holding the value, or the tree's NIL if the value is not present.
+  ///\return False if the descent was longer than any valid RBTree path (the tree was changing).
+  bool optimistic_search(const T& value, NodePtr& found) const noexcept;
+
+
+  ///\brief Marks the start of a write: the seqlock version becomes odd.
+  void begin_write() noexcept;
+
+
+  ///\brief Marks the end of a write: the seqlock version becomes even again.
+  void end_write() noexcept;
+
+
+  ///\brief Frees the retired nodes that no active reader can still be looking at.
+  void try_reclaim() noexcept;
+
+
+public:
+  ///\brief ConcurrentRBTree's constructor.
+  ///\param cmp A custom comparison function for tree nodes (defaulted to std::less).
+  explicit ConcurrentRBTree(CMP cmp=CMP{}) noexcept {tree.comparator = cmp;}
+
+
+  ///\brief ConcurrentRBTree's destructor.
+  ///       No reader may be active: every retired node is freed.
+  ~ConcurrentRBTree() noexcept;
+
+
+  ConcurrentRBTree(const ConcurrentRBTree&) = delete;
+  ConcurrentRBTree& operator=(const ConcurrentRBTree&) = delete;
+
+
+  ///\brief Function to insert a new value in the tree (writer side).
+  ///\param value The value you are going to insert.
+  void insert(const T& value) noexcept;
+
+
+  ///\brief Function to delete a value from the tree (writer side).
+  ///       The unlinked node is retired, it is freed once no reader can reach it anymore.
+  ///       The retired list grows before the tree is touched: if that throws, the tree is unchanged.
+  ///\param value The value you are going to delete.
+  ///\return Bool true if the value was present and has been removed.
+  bool delete_(const T& value);
+
+
+  ///\brief Function to get a reader's handle, bound to a free slot (spins if all slots are taken).
+  ///\return A reader handle, to be used by a single thread.
+  reader get_reader() noexcept;
+
+
+  ///\brief Function to force the reclamation of retired nodes (writer side).
+  ///\return The number of nodes still waiting for active readers.
+  std::size_t reclaim() noexcept;
+
+
+  ///\brief Function to access the underlying RBTree, safe only while no writer is running.
+  ///       Its size() also counts the deleted nodes not reclaimed yet (see: reclaim).
+  ///\return Const reference to the wrapped tree.
+  const Tree& unsafe_tree() const noexcept {return tree;}
+
+};
+
+
+///\brief ConcurrentRBTree's reader handle. Owns a slot for its whole lifetime,
+///       but publishes an epoch only while a lookup is running.
+template <class T, class CMP>
+class ConcurrentRBTree<T, CMP>::reader {
+
+private:
+  ConcurrentRBTree* owner; ///< tree being read.
+  Slot* slot;              ///< slot owned by this handle.
+
+  ///\brief Enters a read-side critical section (publishes the current epoch).
+  void enter() noexcept {
+    slot->epoch.store(owner->global_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the writer's fence in try_reclaim
+  }
+
+  ///\brief Leaves a read-side critical section.
+  void leave() noexcept {
+    slot->epoch.store(idle, std::memory_order_release);
+  }
+
+
+public:
+  ///\brief Reader's constructor (see: get_reader).
+  ///\param tree The tree to be read.
+  ///\param s The slot already claimed for this reader.
+  reader(ConcurrentRBTree* tree, Slot* s) noexcept: owner{tree}, slot{s} {}
+
+  ///\brief Reader's destructor, releases the slot.
+  ~reader() noexcept {
+    if (slot!=nullptr) {
+      slot->taken.store(false, std::memory_order_release);
+    }
+  }
+
+  reader(const reader&) = delete;
+  reader& operator=(const reader&) = delete;
+
+  ///\brief Reader's move constructor, the slot changes owner.
+  reader(reader&& other) noexcept: owner{other.owner}, slot{other.slot} {other.slot = nullptr;}
+
+
+  ///\brief Function to find a value in the RBTree without taking any lock.
+  ///\param value The value to be checked if present within the RBTree.
+  ///\param result Filled with a copy of the stored key, if found.
+  ///\return Bool true if the value is in the RBTree, false otherwise.
+  bool find(const T& value, T& result) noexcept {
+    enter();
+    for (;;) {
+      std::uint64_t before{owner->sequence.load(std::memory_order_acquire)};
+      if (before & 1) { // a write is in progress
+        std::this_thread::yield();
+        continue;
+      }
+      NodePtr found{nullptr};
+      bool complete{owner->optimistic_search(value, found)};
+      bool present{complete and found!=owner->tree.NIL};
+      if (present) {
+        result = found->data; // a plain copy, thrown away if the validation fails; the node is kept alive by the epoch
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (complete and owner->sequence.load(std::memory_order_relaxed)==before) { // validation
+        leave();
+        return present;
+      }
+    }
+  }
+
+
+  ///\brief Function to test whether the tree contains a value, without taking any lock.
+  ///\param value The value to be checked if present within the RBTree.
+  ///\return Bool true if the value is in the RBTree, false otherwise.
+  bool contains(const T& value) noexcept {
+    T dummy{};
+    return find(value, dummy);
+  }
+
+};
+
+// --------------------------------IMPLEMENTATION------------------------------------------
+
+// private methods
+
+template <class T, class CMP>
+bool ConcurrentRBTree<T, CMP>::optimistic_search(const T& value, NodePtr& found) const noexcept {
+  NodePtr node{load_link(tree.root)};
+  for (unsigned int depth{0}; depth<max_depth; ++depth) {
+    if (node==tree.NIL or node==nullptr) { // empty subtree: value not present
+      found = tree.NIL;
+      return true;
+    }
+    if (tree.comparator(value, node->data)) {
+      node = load_link(node->left);
+    } else if (tree.comparator(node->data, value)) {
+      node = load_link(node->right);
+    } else {
+      found = node;
+      return true;
+    }
+  }
+  return false; // path too long for a valid tree, it was being restructured
+}
+
+
+template <class T, class CMP>
+void ConcurrentRBTree<T, CMP>::begin_write() noexcept {
+  sequence.store(sequence.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release); // odd version visible before any change
+}
+
+
+template <class T, class CMP>
+void ConcurrentRBTree<T, CMP>::end_write() noexcept {
+  sequence.store(sequence.load(std::memory_order_relaxed)+1, std::memory_order_release);
+}
+
+
+template <class T, class CMP>
+void ConcurrentRBTree<T, CMP>::try_reclaim() noexcept {
+  global_epoch.fetch_add(1, std::memory_order_acq_rel); // readers entering from now on cannot see retired nodes
+  std::atomic_thread_fence(std::memory_order_seq_cst);  // pairs with the readers' fence in enter()
+  std::uint64_t oldest{idle};
+  for (const Slot& slot : slots) {
+    std::uint64_t epoch{slot.epoch.load(std::memory_order_acquire)};
+    if (epoch<oldest) {
+      oldest = epoch;
+    }
+  }
+  std::size_t kept{0};
+  for (std::size_t i{0}; i<limbo.size(); ++i) {
+    if (limbo[i].first<oldest) { // retired before the oldest active reader started
+      tree.pool.destroy(limbo[i].second);
+    } else {
+      limbo[kept++] = limbo[i];
+    }
+  }
+  limbo.resize(kept);
+}
+
+// public methods
+
+template <class T, class CMP>
+ConcurrentRBTree<T, CMP>::~ConcurrentRBTree() noexcept {
+  for (auto& retired : limbo) {
+    tree.pool.destroy(retired.second);
+  }
+}
+
+
+template <class T, class CMP>
+void ConcurrentRBTree<T, CMP>::insert(const T& value) noexcept {
+  std::lock_guard<std::mutex> lock{writer_lock};
+  begin_write();
+  tree.insert(value);
+  end_write();
+}
+
+
+template <class T, class CMP>
+bool ConcurrentRBTree<T, CMP>::delete_(const T& value) {
+  std::lock_guard<std::mutex> lock{writer_lock};
+  if (limbo.size()==limbo.capacity()) { // readers may pin retired nodes for long: no fixed bound
+    limbo.reserve(std::max(reclaim_threshold, 2*limbo.size()));
+  }
+  begin_write();
+  NodePtr node{tree.delete_adjustment(tree.root, value)};
+  end_write();
+  if (node==tree.NIL) {
+    return false;
+  }
+  limbo.emplace_back(global_epoch.load(std::memory_order_relaxed), node); // retire, do not free (room reserved)
+  if (limbo.size()>=reclaim_threshold) {
+    try_reclaim();
+  }
+  return true;
+}
+
+
+template <class T, class CMP>
+typename ConcurrentRBTree<T, CMP>::reader ConcurrentRBTree<T, CMP>::get_reader() noexcept {
+  for (;;) {
+    for (Slot& slot : slots) {
+      bool expected{false};
+      if (!slot.taken.load(std::memory_order_relaxed)
+          and slot.taken.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        return reader{this, &slot};
+      }
+    }
+    std::this_thread::yield(); // all slots taken, wait for a reader to go away
+  }
+}
+
+
+template <class T, class CMP>
+std::size_t ConcurrentRBTree<T, CMP>::reclaim() noexcept {
+  std::lock_guard<std::mutex> lock{writer_lock};
+  try_reclaim();
+  return limbo.size();
+}
+
+
+#endif // RBT_CONCURRENT_HPP
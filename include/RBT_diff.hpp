@@ -0,0 +1,180 @@
+///\file RBT_diff.hpp
+///\author mpv
+///\brief diff between two versions of a RBTree, as the keys added and removed (see: RBTree::apply_delta).
+
+#ifndef RBT_DIFF_HPP
+#define RBT_DIFF_HPP
+
+#include <type_traits>
+#include <vector>
+#include "Augmentation.hpp"
+#include "RBT.hpp"
+
+
+namespace rbt_diff {
+
+  template <class Tree> struct _Differ;
+
+
+  ///\brief Computes the delta between two trees with the same order (see: diff).
+  ///       Trees augmented with DigestAugmentation are compared range by range: a subtree of the older tree
+  ///       whose digest equals the digest of the newer tree's keys in the same key range is skipped whole,
+  ///       so that only the paths towards the differences are walked, in O(d log^2 n) for d differences.
+  ///       Any other tree is compared by a linear merge of both in-order sequences.
+  template <class T, class CMP, class AUG, class ALLOC>
+  struct _Differ<RBTree<T, CMP, AUG, ALLOC>> {
+    typedef RBTree<T, CMP, AUG, ALLOC> Tree;
+    typedef typename Tree::NodePtr NodePtr;
+
+    static constexpr bool digested{std::is_same<typename AUG::value_type, KeyDigest>::value}; ///< whether subtrees can be skipped.
+
+
+    ///\brief Function to tell whether a node is a leaf (NIL, or missing child of a single-node tree).
+    static bool is_leaf(const NodePtr& node, const Tree& tree) noexcept {return node==tree.NIL or node==nullptr;}
+
+
+    ///\brief Digest of the keys greater than *lower in a subtree (every key if lower is nullptr).
+    static KeyDigest above(const Tree& tree, NodePtr node, const T* lower) noexcept {
+      if (lower==nullptr) {
+        return is_leaf(node, tree) ? AUG::identity() : node->aggregate;
+      }
+      KeyDigest acc{AUG::identity()};
+      while (!is_leaf(node, tree)) {
+        if (tree.comparator(*lower, node->data)) { // node and its right subtree are in
+          acc = AUG::combine(AUG::combine(AUG::lift(node->data), node->right->aggregate), acc);
+          node = node->left;
+        } else {
+          node = node->right;
+        }
+      }
+      return acc;
+    }
+
+
+    ///\brief Digest of the keys smaller than *upper in a subtree (every key if upper is nullptr).
+    static KeyDigest below(const Tree& tree, NodePtr node, const T* upper) noexcept {
+      if (upper==nullptr) {
+        return is_leaf(node, tree) ? AUG::identity() : node->aggregate;
+      }
+      KeyDigest acc{AUG::identity()};
+      while (!is_leaf(node, tree)) {
+        if (tree.comparator(node->data, *upper)) { // node and its left subtree are in
+          acc = AUG::combine(acc, AUG::combine(node->left->aggregate, AUG::lift(node->data)));
+          node = node->right;
+        } else {
+          node = node->left;
+        }
+      }
+      return acc;
+    }
+
+
+    ///\brief Digest of the keys of a tree within the open range (*lower, *upper), a nullptr bound being unbounded.
+    static KeyDigest within(const Tree& tree, const T* lower, const T* upper) noexcept {
+      NodePtr node{tree.root};
+      while (!is_leaf(node, tree)) { // down to the first node inside the range, which splits it
+        if (lower!=nullptr and !tree.comparator(*lower, node->data)) {
+          node = node->right;
+        } else if (upper!=nullptr and !tree.comparator(node->data, *upper)) {
+          node = node->left;
+        } else {
+          return AUG::combine(AUG::combine(above(tree, node->left, lower), AUG::lift(node->data)), below(tree, node->right, upper));
+        }
+      }
+      return AUG::identity();
+    }
+
+
+    ///\brief Appends in order the keys of a subtree within the open range (*lower, *upper).
+    static void report(const Tree& tree, const NodePtr& node, const T* lower, const T* upper, std::vector<T>& out) {
+      if (is_leaf(node, tree)) {
+        return;
+      }
+      const bool after_lower{lower==nullptr or tree.comparator(*lower, node->data)};
+      const bool before_upper{upper==nullptr or tree.comparator(node->data, *upper)};
+      if (after_lower) {
+        report(tree, node->left, lower, upper, out);
+      }
+      if (after_lower and before_upper) {
+        out.push_back(node->data);
+      }
+      if (before_upper) {
+        report(tree, node->right, lower, upper, out);
+      }
+    }
+
+
+    ///\brief Compares a subtree of the older tree, holding its keys in (*lower, *upper), with the newer tree's keys there.
+    static void walk(const Tree& older, const Tree& newer, const NodePtr& node, const T* lower, const T* upper, Delta<T>& delta) {
+      if (is_leaf(node, older)) { // anything the newer tree has here was added
+        report(newer, newer.root, lower, upper, delta.added);
+        return;
+      }
+      const KeyDigest other{within(newer, lower, upper)};
+      if (node->aggregate==other) { // same keys in the range: nothing to walk
+        return;
+      }
+      if (other.count==0) { // the whole subtree was removed
+        report(older, node, nullptr, nullptr, delta.removed);
+        return;
+      }
+      walk(older, newer, node->left, lower, &node->data, delta);
+      if (!newer.contains(node->data)) {
+        delta.removed.push_back(node->data);
+      }
+      walk(older, newer, node->right, &node->data, upper, delta);
+    }
+
+
+    ///\brief Linear merge of both in-order sequences, for trees without digests.
+    static void merge(const Tree& older, const Tree& newer, Delta<T>& delta) {
+      auto it_old{older.begin()}, it_new{newer.begin()};
+      while (it_old!=older.end() and it_new!=newer.end()) {
+        if (older.comparator(*it_old, *it_new)) {
+          delta.removed.push_back(*it_old++);
+        } else if (older.comparator(*it_new, *it_old)) {
+          delta.added.push_back(*it_new++);
+        } else {
+          ++it_old;
+          ++it_new;
+        }
+      }
+      for (; it_old!=older.end(); ++it_old) {
+        delta.removed.push_back(*it_old);
+      }
+      for (; it_new!=newer.end(); ++it_new) {
+        delta.added.push_back(*it_new);
+      }
+    }
+
+
+    ///\brief Picks the digest walk or the merge (see: ::diff).
+    static Delta<T> diff(const Tree& older, const Tree& newer) {
+      Delta<T> delta;
+      if constexpr (digested) {
+        walk(older, newer, older.root, nullptr, nullptr, delta);
+      } else {
+        merge(older, newer, delta);
+      }
+      return delta;
+    }
+  };
+
+} // namespace rbt_diff
+
+
+///\brief Function to compute the keys added and removed from one version of a RBTree to another,
+///       e.g. to ship only the changes to a replica, which applies them by apply_delta.
+///       With DigestAugmentation, the key ranges both trees agree on are skipped, in O(d log^2 n) for
+///       d differences; without it, both trees are merged in O(n). Both must use the same order.
+///       The digest walk pays off while d stays far below n/log^2 n: with many changes, merging is faster.
+///\param older The tree the delta starts from.
+///\param newer The tree the delta leads to.
+///\return The delta: older.apply_delta(delta) leaves older with the keys of newer.
+template <class T, class CMP, class AUG, class ALLOC>
+Delta<T> diff(const RBTree<T, CMP, AUG, ALLOC>& older, const RBTree<T, CMP, AUG, ALLOC>& newer) {
+  return rbt_diff::_Differ<RBTree<T, CMP, AUG, ALLOC>>::diff(older, newer);
+}
+
+
+#endif // RBT_DIFF_HPP
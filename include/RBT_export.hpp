@@ -0,0 +1,282 @@
+///\file RBT_export.hpp
+///\author mpv
+///\brief bulk export of RBTree's keys (newline separated, CSV or binary) through big buffered writes.
+
+#ifndef RBT_EXPORT_HPP
+#define RBT_EXPORT_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "RBT.hpp"
+#include "RBT_parallel.hpp"
+
+
+enum ExportFormat { NEWLINE=0, CSV=1, BINARY=2 }; ///< enumerated type, output formats of export_keys.
+
+
+///\brief Sink writing to a POSIX file descriptor (see: export_keys).
+class FdSink {
+  int fd; ///< descriptor written to, owned by the caller.
+
+public:
+  ///\brief FdSink's constructor (implicit, so that a descriptor can be passed to export_keys).
+  FdSink(const int descriptor) noexcept: fd{descriptor} {}
+
+  ///\brief Writes a whole block, retrying on partial writes and interruptions.
+  ///\return Bool false if the descriptor refused the data.
+  bool write(const char* data, std::size_t size) noexcept {
+    while (size>0) {
+      ssize_t written{::write(fd, data, size)};
+      if (written<0) {
+        if (errno==EINTR) {
+          continue;
+        }
+        return false;
+      }
+      data += written;
+      size -= static_cast<std::size_t>(written);
+    }
+    return true;
+  }
+};
+
+
+///\brief Sink writing to a std::ostream, block by block and without flushing (see: export_keys).
+class StreamSink {
+  std::ostream& os; ///< stream written to, owned by the caller.
+
+public:
+  ///\brief StreamSink's constructor (implicit, so that a stream can be passed to export_keys).
+  StreamSink(std::ostream& stream) noexcept: os{stream} {}
+
+  ///\brief Writes a whole block.
+  ///\return Bool false if the stream is in a failed state.
+  bool write(const char* data, const std::size_t size) {
+    os.write(data, static_cast<std::streamsize>(size));
+    return static_cast<bool>(os);
+  }
+};
+
+
+namespace rbt_export {
+
+  constexpr std::size_t default_buffer{std::size_t{1}<<20}; ///< bytes accumulated before each write.
+  constexpr std::size_t default_grain{std::size_t{1}<<15};  ///< subtrees smaller than this are formatted by one task.
+  constexpr std::size_t max_chars{64};                      ///< room for any arithmetic key and its separator.
+
+
+  ///\brief Growable byte buffer, written in place (no per-key allocation once it has grown).
+  class Buffer {
+    std::vector<char> bytes; ///< storage, never shrunk.
+    std::size_t used{0};     ///< bytes filled so far.
+
+  public:
+    ///\brief Makes room for n more bytes.
+    ///\return Pointer to the first free byte.
+    char* reserve(const std::size_t n) {
+      if (used+n>bytes.size()) {
+        bytes.resize(std::max(2*bytes.size(), used+n));
+      }
+      return bytes.data()+used;
+    }
+
+    ///\brief Marks n bytes, written after reserve, as filled.
+    void commit(const std::size_t n) noexcept {used += n;}
+
+    ///\brief Copies n bytes at the end of the buffer.
+    void append(const char* data, const std::size_t n) {
+      std::memcpy(reserve(n), data, n);
+      commit(n);
+    }
+
+    const char* data() const noexcept {return bytes.data();}
+    std::size_t size() const noexcept {return used;}
+    void clear() noexcept {used = 0;}
+  };
+
+
+  ///\brief Whether keys of type T can be written in the given format.
+  ///       Binary output copies the keys' bytes, so it needs trivially copyable keys.
+  template <class T>
+  bool supports(const ExportFormat format) noexcept {
+    return format!=BINARY or std::is_trivially_copyable<T>::value;
+  }
+
+
+  ///\brief Function to append a key to a buffer in the given format.
+  ///       Arithmetic keys are formatted with std::to_chars, any other key with its operator<<.
+  ///\param separator Whether a comma goes before the key (CSV only: every key but the first).
+  template <class T>
+  void append_key(Buffer& out, const T& key, const ExportFormat format, const bool separator) {
+    if (format==BINARY) {
+      if constexpr (std::is_trivially_copyable<T>::value) {
+        out.append(reinterpret_cast<const char*>(&key), sizeof(T));
+      }
+      return;
+    }
+    if (separator) {
+      out.append(",", 1);
+    }
+    if constexpr (std::is_arithmetic<T>::value and !std::is_same<T, bool>::value) {
+      char* first{out.reserve(max_chars)};
+      char* last{std::to_chars(first, first+max_chars, key).ptr};
+      out.commit(static_cast<std::size_t>(last-first));
+    } else {
+      std::ostringstream os;
+      os << key;
+      const std::string text{os.str()};
+      out.append(text.data(), text.size());
+    }
+    if (format==NEWLINE) {
+      out.append("\n", 1);
+    }
+  }
+
+} // namespace rbt_export
+
+
+///\brief KeyExporter writes a RBTree's keys in order through a large buffer it keeps between exports,
+///       handing the sink a few big blocks instead of one write (and flush) per key.
+class KeyExporter {
+  std::size_t block;                       ///< bytes accumulated before each write.
+  rbt_export::Buffer buffer;               ///< sequential export's buffer.
+  std::vector<rbt_export::Buffer> pieces;  ///< parallel export's buffers, one per task of a round.
+
+
+  ///\brief A recursive helper function to split a tree into in-order pieces (see: export_parallel).
+  ///       A piece is a subtree smaller than grain, or a single key lying between two pieces.
+  ///\param pieces Output vector of (node, whole subtree or single key).
+  template <class NodePtr>
+  static void split(const NodePtr& node, const NodePtr& nil, const std::size_t grain,
+                    std::vector<std::pair<NodePtr, bool>>& pieces) {
+    if (rbt_parallel::is_leaf(node, nil)) {
+      return;
+    }
+    if (rbt_parallel::min_subtree_size(node, nil)<=grain) {
+      pieces.emplace_back(node, true);
+      return;
+    }
+    split(node->left, nil, grain, pieces);
+    pieces.emplace_back(node, false);
+    split(node->right, nil, grain, pieces);
+  }
+
+
+public:
+  ///\brief KeyExporter's constructor (allocates nothing: the buffer grows with the trees exported).
+  ///\param block_size Bytes accumulated before each write to the sink.
+  explicit KeyExporter(const std::size_t block_size=rbt_export::default_buffer) noexcept: block{block_size} {}
+
+
+  ///\brief Function to write every key of a RBTree, in order.
+  ///\param tree The RBTree to be exported.
+  ///\param sink Destination: any object with a bool write(const char*, std::size_t), e.g. FdSink or StreamSink.
+  ///\param format NEWLINE (one key per line), CSV (one line, comma separated) or BINARY (raw bytes of the keys).
+  ///\return Bool false if the format does not suit the keys or the sink failed.
+  template <class T, class CMP, class AUG, class ALLOC, class Sink>
+  bool export_keys(const RBTree<T, CMP, AUG, ALLOC>& tree, Sink&& sink, const ExportFormat format=NEWLINE) {
+    if (!rbt_export::supports<T>(format)) {
+      return false;
+    }
+    bool good{true};
+    bool first{true};
+    buffer.clear();
+    buffer.reserve(std::min(block, tree.size()*rbt_export::max_chars)+rbt_export::max_chars); // small trees, small buffer
+    tree.visit_inorder([&](const T& key) {
+      rbt_export::append_key(buffer, key, format, format==CSV and !first);
+      first = false;
+      if (buffer.size()>=block) {
+        good = sink.write(buffer.data(), buffer.size());
+        buffer.clear();
+      }
+      return good;
+    });
+    if (format==CSV and !first) {
+      buffer.append("\n", 1);
+    }
+    return good and sink.write(buffer.data(), buffer.size());
+  }
+
+
+  ///\brief Function to write every key of a RBTree, in order, formatting subtrees on the pool's threads.
+  ///       Rounds of in-order pieces are formatted concurrently, then written one after the other.
+  ///\param tree The RBTree to be exported (must not be modified meanwhile).
+  ///\param sink Destination (see: export_keys).
+  ///\param format NEWLINE, CSV or BINARY (see: export_keys).
+  ///\param grain Subtree size below which a piece is formatted by a single task.
+  ///\param pool The pool executing the tasks (defaulted to the process-wide one).
+  ///\return Bool false if the format does not suit the keys or the sink failed.
+  template <class T, class CMP, class AUG, class ALLOC, class Sink>
+  bool export_parallel(const RBTree<T, CMP, AUG, ALLOC>& tree, Sink&& sink, const ExportFormat format=NEWLINE,
+                       const std::size_t grain=rbt_export::default_grain, ThreadPool& pool=ThreadPool::default_pool()) {
+    if (!rbt_export::supports<T>(format)) {
+      return false;
+    }
+    typedef decltype(tree.get_root()) NodePtr;
+    std::vector<std::pair<NodePtr, bool>> order;
+    split(tree.get_root(), tree.get_nil(), grain, order);
+    pieces.resize(4*pool.concurrency());
+    for (std::size_t start{0}; start<order.size(); start += pieces.size()) {
+      std::size_t round{std::min(pieces.size(), order.size()-start)};
+      ThreadPool::TaskGroup group;
+      for (std::size_t i{0}; i<round; ++i) {
+        pool.run(group, [&, i]() {
+          rbt_export::Buffer& out{pieces[i]};
+          const std::pair<NodePtr, bool>& piece{order[start+i]};
+          bool first{start+i==0}; // CSV: no comma before the very first key
+          auto format_key = [&](const T& key) {
+            rbt_export::append_key(out, key, format, format==CSV and !first);
+            first = false;
+          };
+          out.clear();
+          if (piece.second) {
+            rbt_parallel::sequential_for_each(piece.first, tree.get_nil(), format_key);
+          } else {
+            format_key(piece.first->data);
+          }
+        });
+      }
+      pool.wait(group);
+      for (std::size_t i{0}; i<round; ++i) {
+        if (!sink.write(pieces[i].data(), pieces[i].size())) {
+          return false;
+        }
+      }
+    }
+    return format!=CSV or order.empty() or sink.write("\n", 1);
+  }
+
+};
+
+
+///\brief Function to write every key of a RBTree, in order, to a file descriptor or a std::ostream.
+///       Keys are formatted into a buffer (std::to_chars for arithmetic keys) written in big blocks;
+///       the buffer is sized from the tree, up to rbt_export::default_buffer, and freed on return.
+///\param tree The RBTree to be exported.
+///\param sink A file descriptor or a std::ostream (see: FdSink, StreamSink).
+///\param format NEWLINE (one key per line), CSV (one line, comma separated) or BINARY (raw bytes of the keys).
+///\return Bool false if the format does not suit the keys or the sink failed.
+template <class T, class CMP, class AUG, class ALLOC>
+bool export_keys(const RBTree<T, CMP, AUG, ALLOC>& tree, FdSink sink, const ExportFormat format=NEWLINE) {
+  return KeyExporter{}.export_keys(tree, sink, format);
+}
+
+
+///\brief Function to write every key of a RBTree, in order, to a std::ostream (see: export_keys).
+template <class T, class CMP, class AUG, class ALLOC>
+bool export_keys(const RBTree<T, CMP, AUG, ALLOC>& tree, StreamSink sink, const ExportFormat format=NEWLINE) {
+  return KeyExporter{}.export_keys(tree, sink, format);
+}
+
+
+#endif // RBT_EXPORT_HPP
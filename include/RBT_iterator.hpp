@@ -9,16 +9,29 @@
 
 ///\brief RBTree's constant iterator class.
 ///       Used to iterate over a sequence and access only RBTree's elements.
-template <class T, class CMP> 
-class RBTree<T, CMP>::const_iterator {
+template <class T, class CMP, class AUG, class ALLOC> 
+class RBTree<T, CMP, AUG, ALLOC>::const_iterator {
 
 private:
-  NodePtr current_node; ///< node currently pointed by the iterator.
+  NodePtr current_node; ///< node currently pointed by the iterator (nullptr past the last key).
+  const RBTree* tree;   ///< iterated tree, whose NIL ends the links and whose rightmost node precedes end().
+
+
+  ///\brief Whether a child link points to a leaf, i.e. out of the keys.
+  bool is_leaf(const NodePtr& node) const noexcept {return node==nullptr or node==tree->NIL;}
 
 public:
+  typedef std::bidirectional_iterator_tag iterator_category; ///< iterator traits, for the standard algorithms.
+  typedef T value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const T* pointer;
+  typedef const T& reference;
+
+
   ///\brief RBTree's constant iterator constructor.
-  ///\param node RBTree's node over which const iterator is constructed.
-  explicit const_iterator(NodePtr node) noexcept: current_node{node} {}
+  ///\param node RBTree's node over which const iterator is constructed (nullptr for end).
+  ///\param iterated The tree the node belongs to.
+  const_iterator(NodePtr node, const RBTree* iterated) noexcept: current_node{node}, tree{iterated} {}
 
 
   ///\brief RBTree's constant iterator destructor.
@@ -47,11 +60,14 @@ public:
   ///       Used to pre-increment the RBTree's const_iterator.
   ///  see: https://www.cs.odu.edu/~zeil/cs361/latest/Public/treetraversal/index.html
   const_iterator& operator++() noexcept {
-    if(current_node->right!=nullptr and current_node->right->data!=0) { // if right exists and not a leaf
-      current_node = current_node->right->f_leftmost(); //down-right and to left most
+    if (!is_leaf(current_node->right)) { // if right exists and not a leaf
+      for (current_node = current_node->right; !is_leaf(current_node->left); current_node = current_node->left) {} //down-right and to left most
     }
-    else { // if right does not exist
-      current_node = current_node->f_rightmost();
+    else { // if right does not exist, go up until coming from a left child (nullptr past the root)
+      NodePtr child{current_node};
+      for (current_node = current_node->parent; current_node!=nullptr and current_node->right==child; current_node = current_node->parent) {
+        child = current_node;
+      }
     }
     return *this;
   }
@@ -69,13 +85,19 @@ public:
 
   ///\brief RBTree's constant iterator prefix -- operator (i.e. --IT).
   ///\return Reference const_iterator to the new current RBTree node, after moving backwards IT. 
-  ///       Used to pre-decrement the RBTree's const_iterator.
+  ///       Used to pre-decrement the RBTree's const_iterator; end() moves to the last key.
   const_iterator& operator--() noexcept {
-   if(current_node->left!=nullptr and current_node->left->data!=0) { // if left exists and not a leaf
-      current_node = current_node->left->b_rightmost(); //down-left and to right most
+    if (current_node==nullptr) { // from end(), back to the largest key
+      current_node = tree->rightmost!=tree->NIL ? tree->rightmost : nullptr;
+    }
+    else if (!is_leaf(current_node->left)) { // if left exists and not a leaf
+      for (current_node = current_node->left; !is_leaf(current_node->right); current_node = current_node->right) {} //down-left and to right most
     }
-    else { // if left does not exist
-      current_node = current_node->b_leftmost();
+    else { // if left does not exist, go up until coming from a right child (nullptr past the root)
+      NodePtr child{current_node};
+      for (current_node = current_node->parent; current_node!=nullptr and current_node->left==child; current_node = current_node->parent) {
+        child = current_node;
+      }
     }
     return *this;
   } 
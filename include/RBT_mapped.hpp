@@ -0,0 +1,636 @@
+///\file RBT_mapped.hpp
+///\author mpv
+///\brief header file with MappedRBTree, a Red-Black Tree living in a memory-mapped file or shared memory segment.
+
+#ifndef RBT_MAPPED_HPP
+#define RBT_MAPPED_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+enum Backing { FILE_BACKED=0, SHARED_MEMORY=1 }; ///< enumerated type, where a MappedRBTree's bytes live.
+
+
+///\brief Links of a MappedRBTree's node, also used alone as the false root of the top-down passes.
+///       Links are byte offsets from the start of the mapping, 0 for leaves (offset 0 is the header):
+///       they stay valid wherever the file is mapped, in any process.
+struct _MappedLinks {
+  std::uint64_t link[2]{0, 0}; ///< left (0) and right (1) children.
+};
+
+
+///\brief MappedRBTree's node: key, color and two offset links, no parent (see: RBT_topdown.hpp).
+template <class T>
+struct _MappedNode : _MappedLinks {
+  T data;   ///< key of the node.
+  bool red; ///< color of the node.
+
+  ///\brief Constructor of a new (red) node given a key.
+  explicit _MappedNode(const T& key) noexcept: data{key}, red{true} {}
+};
+
+
+///\brief First bytes of a MappedRBTree's file: what is needed to reopen it.
+struct _MappedHeader {
+  std::uint64_t magic;     ///< identifies a MappedRBTree's file.
+  std::uint64_t node_size; ///< bytes of a node, a different key type is refused.
+  std::uint64_t bytes;     ///< size of the file, larger than the mapping of a process which has not seen it grow.
+  std::uint64_t used;      ///< end of the slots handed out so far.
+  std::uint64_t free;      ///< first freed slot (they are chained by their left link), 0 if none.
+  std::uint64_t root;      ///< root of the tree, 0 if empty.
+  std::uint64_t keys;      ///< number of keys stored.
+};
+
+
+///\brief MappedRBTree is a Red-Black Tree whose nodes live in a memory-mapped file (or a POSIX shared memory
+///       segment), with its own allocator: a bump pointer and a free list of node slots, stored in the file.
+///       Nodes link each other by offsets, so an existing file is opened in O(1), with no rebuild, and can be
+///       mapped by several processes at different addresses. Insertion and deletion are the single-pass
+///       top-down ones of TopDownRBTree; the file doubles when full.
+///       Changes reach the file through the kernel's page cache; sync() waits until they are on disk.
+///       The tree is consistent only between operations: a crash during a mutation, or a reader running
+///       while another process mutates, needs a lock (or a copy of the file) outside of the tree.
+///       Pointers and iterators are invalidated by insertions, and by any call after another process grew the file.
+///\param T type of the keys, trivially copyable (they are stored as bytes).
+///\param CMP relational function to compare keys (default std::less<T>).
+template <class T, class CMP=std::less<T>>
+class MappedRBTree {
+  static_assert(std::is_trivially_copyable<T>::value, "MappedRBTree stores its keys as bytes: T must be trivially copyable");
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef _MappedNode<T> Node;   ///< type of the tree's node.
+  typedef _MappedLinks Links;    ///< type of the false root.
+  typedef _MappedHeader Header;  ///< type of the file's header.
+
+  static constexpr std::uint64_t magic{0x50414d5452425200ull}; ///< "\0RBTMAP" (little endian).
+  static constexpr std::uint64_t first_slot{(sizeof(Header)+alignof(Node)-1)/alignof(Node)*alignof(Node)}; ///< offset of the first node.
+
+
+private:
+  int fd{-1};                    ///< descriptor of the file or segment.
+  mutable char* base{nullptr};   ///< start of the mapping.
+  mutable std::size_t mapped{0}; ///< bytes mapped by this process.
+
+
+  ///\brief Helper function to reach the header.
+  Header* header() const noexcept {return reinterpret_cast<Header*>(base);}
+
+  ///\brief Helper function to turn an offset into a node, nullptr for 0.
+  Node* at(const std::uint64_t offset) const noexcept {return offset==0 ? nullptr : reinterpret_cast<Node*>(base+offset);}
+
+  ///\brief Helper function to turn a node into its offset, 0 for nullptr.
+  std::uint64_t offset_of(const Node* node) const noexcept {return node==nullptr ? 0 : reinterpret_cast<const char*>(node)-base;}
+
+  ///\brief Whether a node is red (leaves are black).
+  static bool is_red(const Node* node) noexcept {return node!=nullptr and node->red;}
+
+  ///\brief Whether two keys are equivalent for the comparator.
+  bool equivalent(const T& a, const T& b) const noexcept {return !comparator(a, b) and !comparator(b, a);}
+
+
+  ///\brief Helper function to throw the error of the last failed system call.
+  [[noreturn]] static void fail(const char* what) {throw std::system_error(errno, std::generic_category(), what);}
+
+
+  ///\brief Helper function to map bytes of the file, replacing the current mapping if any.
+  void map(const std::size_t bytes) const;
+
+
+  ///\brief Helper function to follow the file when another process made it grow (O(1) otherwise).
+  void refresh() const {
+    if (header()->bytes!=mapped) {
+      map(header()->bytes);
+    }
+  }
+
+
+  ///\brief Helper function to make sure one node can be allocated without remapping, doubling the file if needed.
+  ///       Called before a mutation's descent, so that the nodes on its path do not move.
+  void reserve_one();
+
+
+  ///\brief Helper function to allocate a node (see: reserve_one), from the free list or the bump pointer.
+  Node* create(const T& value) noexcept;
+
+
+  ///\brief Helper function to give a node's slot back to the free list.
+  void release(Node* node) noexcept;
+
+
+  ///\brief Single rotation of a subtree towards dir; the old root becomes red, the new one black.
+  ///\return The new root of the subtree.
+  Node* rotate_single(Node* node, const int dir) noexcept;
+
+
+  ///\brief Double rotation of a subtree towards dir (see: rotate_single).
+  ///\return The new root of the subtree.
+  Node* rotate_double(Node* node, const int dir) noexcept;
+
+
+public:
+  CMP comparator; ///< comparison operator.
+
+  static constexpr std::size_t node_size{sizeof(Node)};  ///< bytes of a node.
+  static constexpr std::size_t initial_bytes{1<<16};     ///< size of a new file.
+
+  ///\brief MappedRBTree's constant iterator, carrying the path from the root to its node.
+  class const_iterator;
+
+
+  ///\brief MappedRBTree's constructor: opens the tree stored under a name, or creates an empty one.
+  ///\param name Path of the file, or name of the shared memory segment (e.g. "/my_tree").
+  ///\param backing FILE_BACKED for a file, SHARED_MEMORY for a POSIX shared memory segment.
+  ///\param cmp A custom comparison function for keys (defaulted to std::less); every opener must use the same order.
+  ///\throw std::system_error if the file cannot be opened or mapped,
+  ///       std::runtime_error if it holds something else than a MappedRBTree of nodes of this size.
+  explicit MappedRBTree(const std::string& name, const Backing backing=FILE_BACKED, CMP cmp=CMP{});
+
+
+  ///\brief MappedRBTree's destructor: unmaps the tree, which stays in the file (see: remove).
+  ~MappedRBTree() noexcept {
+    if (base!=nullptr) {
+      munmap(base, mapped);
+    }
+    if (fd>=0) {
+      close(fd);
+    }
+  }
+
+
+  MappedRBTree(const MappedRBTree&) = delete;
+  MappedRBTree& operator=(const MappedRBTree&) = delete;
+
+
+  ///\brief Move constructor, in O(1): the moved tree is left closed.
+  MappedRBTree(MappedRBTree&& other) noexcept: fd{other.fd}, base{other.base}, mapped{other.mapped}, comparator{other.comparator} {
+    other.fd = -1;
+    other.base = nullptr;
+    other.mapped = 0;
+  }
+
+
+  ///\brief Function to delete the file or shared memory segment of a tree (open trees keep their mapping).
+  ///\return Bool true if it existed and has been removed.
+  static bool remove(const std::string& name, const Backing backing=FILE_BACKED) noexcept {
+    return (backing==SHARED_MEMORY ? shm_unlink(name.c_str()) : unlink(name.c_str()))==0;
+  }
+
+
+  ///\brief Function to insert a value, in a single top-down pass (the file may grow first).
+  ///\param value The value you are going to insert.
+  ///\return Bool true if the value was not present and has been inserted.
+  bool insert(const T& value);
+
+
+  ///\brief Function to delete a value, in a single top-down pass; its slot is reused by the next insertion.
+  ///\param value The value you are going to delete.
+  ///\return Bool true if the value was present and has been removed.
+  bool delete_(const T& value);
+
+
+  ///\brief Function to test whether the tree contains a value.
+  bool contains(const T& value) const;
+
+
+  ///\brief Function to find a value.
+  ///\return An iterator to the value (carrying its path), or end() if not present.
+  const_iterator find(const T& value) const;
+
+
+  ///\brief Function to write the changes back to the file and wait for the disk, a durability point.
+  ///\throw std::system_error if the pages cannot be written.
+  void sync() const {
+    refresh();
+    if (msync(base, header()->used, MS_SYNC)!=0) {
+      fail("MappedRBTree::sync");
+    }
+  }
+
+
+  ///\brief Getter for the number of keys stored.
+  std::size_t size() const {refresh(); return header()->keys;}
+
+  ///\brief Whether the tree is empty.
+  bool empty() const {return size()==0;}
+
+  ///\brief Getter for the size of the file in bytes (header, alive, freed and never used slots).
+  std::size_t memory() const {refresh(); return header()->bytes;}
+
+
+  ///\brief Function to check the Red-Black properties: black root, no red node with a red child,
+  ///       same number of black nodes on every path, keys in order (see: TopDownRBTree::is_valid).
+  bool is_valid() const;
+
+
+  ///\brief Function to get an iterator to the smallest key (its path from the root).
+  const_iterator begin() const;
+
+  ///\brief Function to get the past-the-end iterator.
+  const_iterator end() const noexcept;
+
+};
+
+
+///\brief MappedRBTree's constant iterator, keeping the stack of the ancestors still to be visited
+///       (see: TopDownRBTree::const_iterator), as pointers into this process' mapping.
+template <class T, class CMP>
+class MappedRBTree<T, CMP>::const_iterator {
+  friend class MappedRBTree;
+
+  const MappedRBTree* tree{nullptr}; ///< the tree walked, to follow the offsets.
+  std::vector<const Node*> path;     ///< current node on top, below it the ancestors it lies in the left subtree of.
+
+
+  ///\brief Pushes a node and the left spine of its subtree.
+  void push_left(const Node* node) {
+    for (; node!=nullptr; node = tree->at(node->link[0])) {
+      path.push_back(node);
+    }
+  }
+
+
+public:
+  typedef std::forward_iterator_tag iterator_category; ///< iterator traits, for the standard algorithms.
+  typedef T value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const T* pointer;
+  typedef const T& reference;
+
+
+  ///\brief Constructor of the past-the-end iterator.
+  const_iterator() noexcept {}
+
+
+  ///\brief Dereference operator.
+  ///\return Const reference to the key of the current node.
+  const T& operator*() const noexcept {return path.back()->data;}
+
+
+  ///\brief Member access operator.
+  const T* operator->() const noexcept {return &path.back()->data;}
+
+
+  ///\brief Prefix ++ operator: next key in order (past-the-end after the largest).
+  const_iterator& operator++() {
+    const Node* node{path.back()};
+    path.pop_back();
+    push_left(tree->at(node->link[1]));
+    return *this;
+  }
+
+
+  ///\brief Postfix ++ operator.
+  const_iterator operator++(int) {
+    const_iterator previous{*this};
+    ++(*this);
+    return previous;
+  }
+
+
+  ///\brief Equality operator: same node (or both past-the-end).
+  bool operator==(const const_iterator& other) const noexcept {
+    return path.empty() ? other.path.empty() : (!other.path.empty() and path.back()==other.path.back());
+  }
+
+
+  ///\brief Inequality operator.
+  bool operator!=(const const_iterator& other) const noexcept {return !(*this==other);}
+
+};
+
+// --------------------------------IMPLEMENTATION------------------------------------------
+
+// private methods
+
+template <class T, class CMP>
+void MappedRBTree<T, CMP>::map(const std::size_t bytes) const {
+  void* mapping{mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+  if (mapping==MAP_FAILED) {
+    fail("MappedRBTree: mmap");
+  }
+  if (base!=nullptr) { // the new mapping is in place: the old one can go
+    munmap(base, mapped);
+  }
+  base = static_cast<char*>(mapping);
+  mapped = bytes;
+}
+
+
+template <class T, class CMP>
+void MappedRBTree<T, CMP>::reserve_one() {
+  refresh();
+  if (header()->free!=0 or header()->used+node_size<=header()->bytes) {
+    return;
+  }
+  const std::size_t bytes{header()->bytes*2};
+  if (ftruncate(fd, off_t(bytes))!=0) {
+    fail("MappedRBTree: ftruncate");
+  }
+  map(bytes);
+  header()->bytes = bytes;
+}
+
+
+template <class T, class CMP>
+typename MappedRBTree<T, CMP>::Node* MappedRBTree<T, CMP>::create(const T& value) noexcept {
+  std::uint64_t slot{header()->free};
+  if (slot!=0) {
+    header()->free = at(slot)->link[0];
+  } else {
+    slot = header()->used;
+    header()->used += node_size;
+  }
+  return new (base+slot) Node(value);
+}
+
+
+template <class T, class CMP>
+void MappedRBTree<T, CMP>::release(Node* node) noexcept {
+  node->link[0] = header()->free;
+  header()->free = offset_of(node);
+}
+
+
+template <class T, class CMP>
+typename MappedRBTree<T, CMP>::Node* MappedRBTree<T, CMP>::rotate_single(Node* node, const int dir) noexcept {
+  Node* pivot{at(node->link[!dir])};
+  node->link[!dir] = pivot->link[dir];
+  pivot->link[dir] = offset_of(node);
+  node->red = true;
+  pivot->red = false;
+  return pivot;
+}
+
+
+template <class T, class CMP>
+typename MappedRBTree<T, CMP>::Node* MappedRBTree<T, CMP>::rotate_double(Node* node, const int dir) noexcept {
+  node->link[!dir] = offset_of(rotate_single(at(node->link[!dir]), !dir));
+  return rotate_single(node, dir);
+}
+
+// public methods
+
+template <class T, class CMP>
+MappedRBTree<T, CMP>::MappedRBTree(const std::string& name, const Backing backing, CMP cmp): comparator{cmp} {
+  fd = backing==SHARED_MEMORY ? shm_open(name.c_str(), O_RDWR | O_CREAT, 0644) : open(name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd<0) {
+    fail("MappedRBTree: open");
+  }
+  try { // the destructor does not run: release what was acquired before throwing
+    struct stat status;
+    if (fstat(fd, &status)!=0) {
+      fail("MappedRBTree: fstat");
+    }
+    const bool created{status.st_size==0};
+    if (created and ftruncate(fd, off_t(initial_bytes))!=0) {
+      fail("MappedRBTree: ftruncate");
+    }
+    map(created ? initial_bytes : std::size_t(status.st_size));
+    if (created) {
+      new (base) Header{magic, node_size, initial_bytes, first_slot, 0, 0, 0};
+    } else if (mapped<sizeof(Header) or header()->magic!=magic or header()->node_size!=node_size) {
+      throw std::runtime_error("MappedRBTree: " + name + " does not hold a tree of this key type");
+    }
+    refresh(); // the size read by fstat may be older than the header's
+  } catch (...) {
+    if (base!=nullptr) {
+      munmap(base, mapped);
+    }
+    close(fd);
+    throw;
+  }
+}
+
+
+template <class T, class CMP>
+bool MappedRBTree<T, CMP>::insert(const T& value) {
+  reserve_one();
+  Header* head_of_file{header()};
+  if (head_of_file->root==0) {
+    Node* node{create(value)};
+    node->red = false;
+    head_of_file->root = offset_of(node);
+    ++head_of_file->keys;
+    return true;
+  }
+  Links head; // false root, so that the real root can be rotated like any other node
+  Links* great{&head};  // great-grandparent
+  Node* grand{nullptr}; // grandparent
+  Node* parent{nullptr};
+  Node* node{at(head_of_file->root)};
+  head.link[1] = head_of_file->root;
+  int dir{0}, last{0};
+  bool inserted{false};
+  for (;;) {
+    if (node==nullptr) { // bottom reached: new red leaf
+      node = create(value);
+      parent->link[dir] = offset_of(node);
+      inserted = true;
+    } else if (is_red(at(node->link[0])) and is_red(at(node->link[1]))) { // split a 4-node on the way down
+      node->red = true;
+      at(node->link[0])->red = false;
+      at(node->link[1])->red = false;
+    }
+    if (is_red(node) and is_red(parent)) { // red violation, fixed right here by one or two rotations
+      int side{great->link[1]==offset_of(grand)};
+      great->link[side] = offset_of(node==at(parent->link[last]) ? rotate_single(grand, !last) : rotate_double(grand, !last));
+    }
+    if (inserted or equivalent(node->data, value)) {
+      break;
+    }
+    last = dir;
+    dir = comparator(node->data, value);
+    if (grand!=nullptr) {
+      great = grand;
+    }
+    grand = parent;
+    parent = node;
+    node = at(node->link[dir]);
+  }
+  head_of_file->root = head.link[1];
+  at(head_of_file->root)->red = false;
+  head_of_file->keys += inserted;
+  return inserted;
+}
+
+
+template <class T, class CMP>
+bool MappedRBTree<T, CMP>::delete_(const T& value) {
+  refresh();
+  Header* head_of_file{header()};
+  if (head_of_file->root==0) {
+    return false;
+  }
+  Links head; // false root (see: insert)
+  head.link[1] = head_of_file->root;
+  Links* grand{nullptr};
+  Links* parent{nullptr};
+  Links* node{&head};
+  Node* found{nullptr};
+  int dir{1};
+  while (node->link[dir]!=0) {
+    int last{dir};
+    grand = parent;
+    parent = node;
+    Node* current{at(node->link[dir])};
+    node = current;
+    dir = comparator(current->data, value);
+    if (found==nullptr and equivalent(current->data, value)) {
+      found = current;
+    }
+    if (is_red(current) or is_red(at(current->link[dir]))) {
+      continue;
+    }
+    // push a red node down, so that the leaf finally removed is red
+    if (is_red(at(current->link[!dir]))) {
+      Node* rotated{rotate_single(current, dir)};
+      parent->link[last] = offset_of(rotated);
+      parent = rotated;
+      continue;
+    }
+    Node* sibling{at(parent->link[!last])}; // never set when parent is the false root
+    if (sibling==nullptr) {
+      continue;
+    }
+    Node* father{static_cast<Node*>(parent)};
+    if (!is_red(at(sibling->link[0])) and !is_red(at(sibling->link[1]))) { // color flip
+      father->red = false;
+      sibling->red = true;
+      current->red = true;
+    } else {
+      int side{grand->link[1]==offset_of(father)};
+      grand->link[side] = offset_of(is_red(at(sibling->link[last])) ? rotate_double(father, last) : rotate_single(father, last));
+      Node* top{at(grand->link[side])};
+      current->red = top->red = true;
+      at(top->link[0])->red = at(top->link[1])->red = false;
+    }
+  }
+  if (found!=nullptr) { // node is found or its in-order neighbour, and has at most one child
+    Node* leaf{static_cast<Node*>(node)};
+    if (found!=leaf) {
+      found->data = leaf->data;
+    }
+    parent->link[parent->link[1]==offset_of(leaf)] = leaf->link[leaf->link[0]==0];
+    release(leaf);
+    --head_of_file->keys;
+  }
+  head_of_file->root = head.link[1];
+  if (head_of_file->root!=0) {
+    at(head_of_file->root)->red = false;
+  }
+  return found!=nullptr;
+}
+
+
+template <class T, class CMP>
+bool MappedRBTree<T, CMP>::contains(const T& value) const {
+  refresh();
+  const Node* node{at(header()->root)};
+  while (node!=nullptr) {
+    if (comparator(value, node->data)) {
+      node = at(node->link[0]);
+    } else if (comparator(node->data, value)) {
+      node = at(node->link[1]);
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+template <class T, class CMP>
+typename MappedRBTree<T, CMP>::const_iterator MappedRBTree<T, CMP>::find(const T& value) const {
+  refresh();
+  const_iterator it;
+  it.tree = this;
+  const Node* node{at(header()->root)};
+  while (node!=nullptr) {
+    if (comparator(value, node->data)) { // node comes after value: stays on the stack
+      it.path.push_back(node);
+      node = at(node->link[0]);
+    } else if (comparator(node->data, value)) {
+      node = at(node->link[1]);
+    } else {
+      it.path.push_back(node);
+      return it;
+    }
+  }
+  return end();
+}
+
+
+template <class T, class CMP>
+bool MappedRBTree<T, CMP>::is_valid() const {
+  refresh();
+  const Node* root{at(header()->root)};
+  if (is_red(root)) {
+    return false;
+  }
+  std::size_t black_height{0}, counted{0};
+  std::vector<std::pair<const Node*, std::size_t>> stack; // node, black nodes above it
+  if (root!=nullptr) {
+    stack.emplace_back(root, 0);
+  }
+  while (!stack.empty()) {
+    auto [node, blacks] = stack.back();
+    stack.pop_back();
+    ++counted;
+    blacks += !node->red;
+    for (int dir : {0, 1}) {
+      const Node* child{at(node->link[dir])};
+      if (child==nullptr) { // a leaf: every path must have the same black height
+        if (black_height==0) {
+          black_height = blacks;
+        } else if (black_height!=blacks) {
+          return false;
+        }
+        continue;
+      }
+      if ((node->red and child->red) or (dir==0 ? !comparator(child->data, node->data) : !comparator(node->data, child->data))) {
+        return false;
+      }
+      stack.emplace_back(child, blacks);
+    }
+  }
+  bool ordered{true};
+  const T* previous{nullptr};
+  for (const_iterator it{begin()}; it!=end() and ordered; ++it) { // in order over the whole tree
+    ordered = previous==nullptr or comparator(*previous, *it);
+    previous = &*it;
+  }
+  return ordered and counted==header()->keys;
+}
+
+
+template <class T, class CMP>
+typename MappedRBTree<T, CMP>::const_iterator MappedRBTree<T, CMP>::begin() const {
+  refresh();
+  const_iterator it;
+  it.tree = this;
+  it.push_left(at(header()->root));
+  return it;
+}
+
+
+template <class T, class CMP>
+typename MappedRBTree<T, CMP>::const_iterator MappedRBTree<T, CMP>::end() const noexcept {
+  return const_iterator{};
+}
+
+
+#endif // RBT_MAPPED_HPP
@@ -0,0 +1,233 @@
+///\file RBT_parallel.hpp
+///\author mpv
+///\brief parallel for_each and reduce over a RBTree, splitting it into subtrees on a work-stealing pool.
+
+#ifndef RBT_PARALLEL_HPP
+#define RBT_PARALLEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+#include "RBT.hpp"
+#include "Thread_pool.hpp"
+
+
+namespace rbt_parallel {
+
+  constexpr std::size_t default_grain{2048}; ///< subtrees smaller than this are walked sequentially.
+
+
+  ///\brief Function to tell whether a node is a leaf (NIL, or missing child of a single-node tree).
+  ///\param node The node to be checked.
+  ///\param nil The tree's NIL sentinel.
+  ///\return Bool true if there is no key in node.
+  template <class NodePtr>
+  bool is_leaf(const NodePtr& node, const NodePtr& nil) noexcept {
+    return node==nil or node==nullptr;
+  }
+
+
+  ///\brief Function to estimate from below the number of keys in a subtree.
+  ///       A subtree with black height bh holds at least 2^bh-1 keys, bh is read along the leftmost path.
+  ///\param node The root of the subtree.
+  ///\param nil The tree's NIL sentinel.
+  ///\return A lower bound of the subtree's size.
+  template <class NodePtr>
+  std::size_t min_subtree_size(NodePtr node, const NodePtr& nil) noexcept {
+    unsigned int black_height{0};
+    for (; !is_leaf(node, nil); node = node->left) {
+      black_height += (node->color==BLACK);
+    }
+    return black_height>=8*sizeof(std::size_t) ? ~std::size_t{0} : (std::size_t{1}<<black_height)-1;
+  }
+
+
+  ///\brief A recursive helper function to apply f to every key of a subtree, in-order (sequential part).
+  template <class NodePtr, class F>
+  void sequential_for_each(const NodePtr& node, const NodePtr& nil, F& f) {
+    if (!is_leaf(node, nil)) {
+      sequential_for_each(node->left, nil, f);
+      f(node->data);
+      sequential_for_each(node->right, nil, f);
+    }
+  }
+
+
+  ///\brief A recursive helper function to fold a subtree, in-order (sequential part).
+  ///\return The fold of the subtree's keys, empty if the subtree has no key.
+  template <class R, class NodePtr, class Op, class Transform>
+  std::optional<R> sequential_reduce(const NodePtr& node, const NodePtr& nil, Op& op, Transform& transform) {
+    if (is_leaf(node, nil)) {
+      return std::nullopt;
+    }
+    std::optional<R> left{sequential_reduce<R>(node->left, nil, op, transform)};
+    R acc{left ? op(std::move(*left), transform(node->data)) : R(transform(node->data))};
+    std::optional<R> right{sequential_reduce<R>(node->right, nil, op, transform)};
+    return right ? op(std::move(acc), std::move(*right)) : std::move(acc);
+  }
+
+
+  ///\brief A recursive helper function which forks the left subtree and continues on the right one.
+  template <class NodePtr, class F>
+  void for_each_task(const NodePtr& node, const NodePtr& nil, F& f, const std::size_t grain, ThreadPool& pool) {
+    if (min_subtree_size(node, nil)<=grain) {
+      sequential_for_each(node, nil, f);
+      return;
+    }
+    ThreadPool::TaskGroup group;
+    NodePtr left{node->left};
+    pool.run(group, [&]() { for_each_task(left, nil, f, grain, pool); });
+    f(node->data);
+    for_each_task(node->right, nil, f, grain, pool);
+    pool.wait(group);
+  }
+
+
+  ///\brief A recursive helper function which forks the left subtree, reduces the right one and joins in-order.
+  template <class R, class NodePtr, class Op, class Transform>
+  std::optional<R> reduce_task(const NodePtr& node, const NodePtr& nil, Op& op, Transform& transform,
+                               const std::size_t grain, ThreadPool& pool) {
+    if (min_subtree_size(node, nil)<=grain) {
+      return sequential_reduce<R>(node, nil, op, transform);
+    }
+    ThreadPool::TaskGroup group;
+    NodePtr left_node{node->left};
+    std::optional<R> left;
+    pool.run(group, [&]() { left = reduce_task<R>(left_node, nil, op, transform, grain, pool); });
+    std::optional<R> right{reduce_task<R>(node->right, nil, op, transform, grain, pool)};
+    R acc{transform(node->data)};
+    pool.wait(group);
+    acc = left ? op(std::move(*left), std::move(acc)) : std::move(acc); // keep in-order: left, key, right
+    return right ? op(std::move(acc), std::move(*right)) : std::move(acc);
+  }
+
+
+  ///\brief Sizes of the subtrees split among tasks by a parallel clone, mirroring the forks (see: parallel_clone).
+  struct _CloneSplit {
+    std::size_t left_size{0};            ///< number of keys in the left subtree of the forking node.
+    std::unique_ptr<_CloneSplit> left;   ///< splits within the left subtree (null if copied sequentially).
+    std::unique_ptr<_CloneSplit> right;  ///< splits within the right subtree (null if copied sequentially).
+  };
+
+
+  ///\brief A recursive helper function to count the keys of a subtree, recording the size of every forked left subtree.
+  ///\param split Filled with the forks' sizes, left null if the subtree is counted sequentially.
+  ///\return The number of keys in the subtree.
+  template <class NodePtr>
+  std::size_t count_task(const NodePtr& node, const NodePtr& nil, std::unique_ptr<_CloneSplit>& split,
+                         const std::size_t grain, ThreadPool& pool) {
+    if (min_subtree_size(node, nil)<=grain) {
+      std::size_t count{0};
+      auto counter = [&count](const auto&) { ++count; };
+      sequential_for_each(node, nil, counter);
+      return count;
+    }
+    split = std::make_unique<_CloneSplit>();
+    ThreadPool::TaskGroup group;
+    NodePtr left{node->left};
+    pool.run(group, [&]() { split->left_size = count_task(left, nil, split->left, grain, pool); });
+    std::size_t right_size{count_task(node->right, nil, split->right, grain, pool)};
+    pool.wait(group);
+    return split->left_size+1+right_size;
+  }
+
+
+  ///\brief Parallel deep copy of a RBTree into one block of nodes laid out in pre-order (see: parallel_clone).
+  ///       Every task knows from the counts where its subtree starts in the block, so no allocation is shared.
+  template <class Tree>
+  struct _Cloner {
+    typedef typename Tree::Node Node;       ///< type of the tree's node.
+    typedef typename Tree::NodePtr NodePtr; ///< type of pointer to tree's node.
+
+    ///\brief A recursive helper function which copies a subtree into the slots starting at slots.
+    ///\param link Link of the copied parent (or root) to be set to the copied subtree.
+    static void clone_task(const Tree& source, Tree& target, const NodePtr& node, NodePtr parent, Node* slots,
+                           const _CloneSplit* split, NodePtr& link, ThreadPool& pool) {
+      if (split==nullptr) { // small subtree: sequential copy, pre-order from slots on
+        link = target.copy(node, source.NIL, parent, [&slots](const Node& other) { return new (slots++) Node(other); });
+        return;
+      }
+      NodePtr copied{new (slots) Node(*node)};
+      copied->parent = parent;
+      link = copied;
+      ThreadPool::TaskGroup group;
+      pool.run(group, [&]() {
+        clone_task(source, target, node->left, copied, slots+1, split->left.get(), copied->left, pool);
+      });
+      clone_task(source, target, node->right, copied, slots+1+split->left_size, split->right.get(), copied->right, pool);
+      pool.wait(group);
+    }
+
+    ///\brief Counts the keys, allocates the block and copies the tree into it (see: parallel_clone).
+    static Tree clone(const Tree& source, const std::size_t grain, ThreadPool& pool) {
+      Tree target{Tree::NodeTraits::select_on_container_copy_construction(source.pool.get_allocator())};
+      target.comparator = source.comparator;
+      std::unique_ptr<_CloneSplit> split;
+      std::size_t size{count_task(source.root, source.NIL, split, grain, pool)};
+      if (size>0) {
+        target.own_nil();
+        Node* slots{target.pool.allocate_block(size)};
+        clone_task(source, target, source.root, nullptr, slots, split.get(), target.root, pool);
+      }
+      target.refresh_extremes();
+      return target;
+    }
+  };
+
+
+  ///\brief Identity transform (see: parallel_reduce).
+  struct identity {
+    template <class U>
+    const U& operator()(const U& value) const noexcept {return value;}
+  };
+
+} // namespace rbt_parallel
+
+
+///\brief Function to apply f to every key of the RBTree, using all the pool's threads.
+///       Subtrees at the top levels become tasks, subtrees smaller than grain are walked sequentially.
+///\param tree The RBTree to be visited (must not be modified meanwhile).
+///\param f Callable invoked as f(key), concurrently and in no particular order: it must be thread-safe.
+///\param grain Subtree size below which no more tasks are spawned.
+///\param pool The pool executing the tasks (defaulted to the process-wide one).
+template <class T, class CMP, class AUG, class ALLOC, class F>
+void parallel_for_each(const RBTree<T, CMP, AUG, ALLOC>& tree, F f, const std::size_t grain=rbt_parallel::default_grain,
+                       ThreadPool& pool=ThreadPool::default_pool()) {
+  rbt_parallel::for_each_task(tree.get_root(), tree.get_nil(), f, grain, pool);
+}
+
+
+///\brief Function to reduce the keys of the RBTree, using all the pool's threads.
+///       Partial results are combined following the keys' order, so op must be associative, not commutative.
+///\param tree The RBTree to be reduced (must not be modified meanwhile).
+///\param init Initial value, combined once on the left of the result (as in std::reduce).
+///\param op Binary associative operation, invoked as op(R, R).
+///\param transform Unary operation applied to each key before reducing it (defaulted to identity).
+///\param grain Subtree size below which no more tasks are spawned.
+///\param pool The pool executing the tasks (defaulted to the process-wide one).
+///\return init op transform(k1) op transform(k2) ... for the keys k1 < k2 < ... of the tree.
+template <class T, class CMP, class AUG, class ALLOC, class R, class Op, class Transform=rbt_parallel::identity>
+R parallel_reduce(const RBTree<T, CMP, AUG, ALLOC>& tree, R init, Op op, Transform transform=Transform{},
+                  const std::size_t grain=rbt_parallel::default_grain, ThreadPool& pool=ThreadPool::default_pool()) {
+  std::optional<R> total{rbt_parallel::reduce_task<R>(tree.get_root(), tree.get_nil(), op, transform, grain, pool)};
+  return total ? op(std::move(init), std::move(*total)) : init;
+}
+
+
+///\brief Function to deep copy a RBTree, using all the pool's threads.
+///       Keys are counted in parallel first, then every node is built in one block sized up front,
+///       each task filling the slots of its own subtree (laid out in pre-order).
+///\param tree The RBTree to be copied (must not be modified meanwhile).
+///\param grain Subtree size below which no more tasks are spawned.
+///\param pool The pool executing the tasks (defaulted to the process-wide one).
+///\return A deep copy of tree, with its own NIL and a copy of its comparator.
+template <class T, class CMP, class AUG, class ALLOC>
+RBTree<T, CMP, AUG, ALLOC> parallel_clone(const RBTree<T, CMP, AUG, ALLOC>& tree, const std::size_t grain=rbt_parallel::default_grain,
+                                          ThreadPool& pool=ThreadPool::default_pool()) {
+  return rbt_parallel::_Cloner<RBTree<T, CMP, AUG, ALLOC>>::clone(tree, grain, pool);
+}
+
+
+#endif // RBT_PARALLEL_HPP
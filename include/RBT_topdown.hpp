@@ -0,0 +1,573 @@
+///\file RBT_topdown.hpp
+///\author mpv
+///\brief header file with a parent-pointer-free Red-Black Tree, balanced top-down in a single pass.
+
+#ifndef RBT_TOPDOWN_HPP
+#define RBT_TOPDOWN_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Node_pool.hpp"
+
+
+///\brief Links of a TopDownRBTree's node, also used alone as the false root of the top-down passes.
+template <class Node>
+struct _TopDownLinks {
+  Node* link[2]{nullptr, nullptr}; ///< left (0) and right (1) children, nullptr for leaves.
+};
+
+
+///\brief TopDownRBTree's node: key, color and two children, no parent pointer.
+template <class T>
+struct _TopDownNode : _TopDownLinks<_TopDownNode<T>> {
+  T data;   ///< key of the node.
+  bool red; ///< color of the node.
+
+  ///\brief Constructor of a new (red) node given a key.
+  explicit _TopDownNode(const T& key) : data{key}, red{true} {}
+};
+
+
+///\brief TopDownRBTree is a Red-Black Tree whose nodes have no parent pointer.
+///       Insertion splits 4-nodes and deletion pushes a red node down on the way from the root to the leaf,
+///       so both are done in a single top-down pass, rotating only around the last few nodes of the path.
+///       Nodes are smaller than RBTree's (two links, no parent) and a writer never walks back up the path,
+///       which is what lock coupling needs. Iterators carry their own stack of ancestors.
+///\param T type of the tree nodes' keys.
+///\param CMP relational function to compare nodes' keys (default std::less<T>).
+///\param ALLOC allocator, rebound to the nodes (default std::allocator<T>).
+template <class T, class CMP=std::less<T>, class ALLOC=std::allocator<T>>
+class TopDownRBTree {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef _TopDownNode<T> Node;       ///< type of the tree's node.
+  typedef _TopDownLinks<Node> Links;  ///< type of the false root.
+  typedef typename std::allocator_traits<ALLOC>::template rebind_alloc<Node> NodeAllocator; ///< allocator of the nodes.
+  typedef std::allocator_traits<NodeAllocator> NodeTraits;  ///< propagation traits of the allocator.
+
+
+private:
+  _NodePool<Node, NodeAllocator> pool; ///< owner of every node.
+  Node* root{nullptr};                 ///< root of the tree (always black), nullptr if empty.
+  std::size_t keys{0};                 ///< number of keys stored.
+
+
+  ///\brief Whether a node is red (leaves are black).
+  static bool is_red(const Node* node) noexcept {return node!=nullptr and node->red;}
+
+
+  ///\brief Single rotation of a subtree towards dir; the old root becomes red, the new one black.
+  ///\return The new root of the subtree.
+  static Node* rotate_single(Node* node, const int dir) noexcept;
+
+
+  ///\brief Double rotation of a subtree towards dir (see: rotate_single).
+  ///\return The new root of the subtree.
+  static Node* rotate_double(Node* node, const int dir) noexcept;
+
+
+  ///\brief Whether two keys are equivalent for the comparator.
+  bool equivalent(const T& a, const T& b) const noexcept {return !comparator(a, b) and !comparator(b, a);}
+
+
+  ///\brief Helper function to destroy every node, giving the chunks back to the allocator.
+  void release_nodes() noexcept;
+
+
+public:
+  CMP comparator; ///< comparison operator.
+
+  static constexpr std::size_t node_size{sizeof(Node)}; ///< bytes of a node.
+
+  ///\brief TopDownRBTree's constant iterator, carrying the path from the root to its node.
+  class const_iterator;
+
+
+  ///\brief TopDownRBTree's constructor.
+  ///\param cmp A custom comparison function for tree nodes (defaulted to std::less).
+  ///\param alloc The allocator of the nodes (defaulted to a value-initialized one).
+  explicit TopDownRBTree(CMP cmp=CMP{}, const ALLOC& alloc=ALLOC{}) noexcept: pool{NodeAllocator(alloc)}, comparator{cmp} {}
+
+
+  ///\brief TopDownRBTree's destructor.
+  ~TopDownRBTree() noexcept {release_nodes();}
+
+
+  ///\brief Copy constructor, with the allocator select_on_container_copy_construction picks.
+  TopDownRBTree(const TopDownRBTree& other): TopDownRBTree(other, NodeTraits::select_on_container_copy_construction(other.pool.get_allocator())) {}
+
+
+  ///\brief Copy constructor with the allocator of the copy, in pre-order with an explicit stack.
+  TopDownRBTree(const TopDownRBTree& other, const ALLOC& alloc);
+
+
+  ///\brief Copy assignment (copy and swap): the copy's nodes come from this tree's allocator,
+  ///       or from other's if it propagates on copy assignment (then taken along).
+  TopDownRBTree& operator=(const TopDownRBTree& other) {
+    if (this!=&other) {
+      TopDownRBTree copied{other, NodeTraits::propagate_on_container_copy_assignment::value ? other.get_allocator() : get_allocator()};
+      swap(copied);
+      if constexpr (NodeTraits::propagate_on_container_copy_assignment::value) {
+        pool.swap_allocator(copied.pool);
+      }
+    }
+    return *this;
+  }
+
+
+  ///\brief Move constructor, in O(1): the moved tree is left empty.
+  TopDownRBTree(TopDownRBTree&& other) noexcept: pool{std::move(other.pool)}, root{other.root}, keys{other.keys}, comparator{other.comparator} {
+    other.root = nullptr;
+    other.keys = 0;
+  }
+
+
+  ///\brief Move assignment, in O(1) if the allocators are equal (see: swap),
+  ///       otherwise the keys are copied into nodes from this tree's allocator.
+  TopDownRBTree& operator=(TopDownRBTree&& other) noexcept(NodeTraits::is_always_equal::value) {
+    if (this==&other) {
+      return *this;
+    }
+    if (NodeTraits::is_always_equal::value or pool.get_allocator()==other.pool.get_allocator()) {
+      swap(other);
+    } else {
+      TopDownRBTree copied{other, get_allocator()};
+      swap(copied);
+    }
+    return *this;
+  }
+
+
+  ///\brief Function to get a copy of the allocator.
+  ALLOC get_allocator() const noexcept {return ALLOC(pool.get_allocator());}
+
+
+  ///\brief Function to exchange the content of two trees in O(1) (allocators must be equal).
+  void swap(TopDownRBTree& other) noexcept {
+    using std::swap;
+    pool.swap_content(other.pool);
+    swap(root, other.root);
+    swap(keys, other.keys);
+    swap(comparator, other.comparator);
+  }
+
+
+  ///\brief Function to insert a value, in a single top-down pass.
+  ///\param value The value you are going to insert.
+  ///\return Bool true if the value was not present and has been inserted.
+  bool insert(const T& value);
+
+
+  ///\brief Function to delete a value, in a single top-down pass.
+  ///\param value The value you are going to delete.
+  ///\return Bool true if the value was present and has been removed.
+  bool delete_(const T& value) noexcept;
+
+
+  ///\brief Function to test whether the tree contains a value.
+  ///\param value The value to be checked.
+  ///\return Bool true if the value is in the tree.
+  bool contains(const T& value) const noexcept;
+
+
+  ///\brief Function to find a value.
+  ///\param value The value to be found.
+  ///\return An iterator to the value (carrying its path), or end() if not present.
+  const_iterator find(const T& value) const;
+
+
+  ///\brief Getter for the number of keys stored.
+  std::size_t size() const noexcept {return keys;}
+
+  ///\brief Whether the tree is empty.
+  bool empty() const noexcept {return root==nullptr;}
+
+  ///\brief Getter for the bytes allocated for the nodes (alive, freed or never used slots).
+  std::size_t memory() const noexcept {return pool.capacity()*node_size;}
+
+
+  ///\brief Function to compute the height of the tree (number of nodes on the longest path).
+  std::size_t get_height() const;
+
+
+  ///\brief Function to check the Red-Black properties: black root, no red node with a red child,
+  ///       same number of black nodes on every path, keys in order.
+  ///\return Bool true if the tree is a valid Red-Black Tree.
+  bool is_valid() const;
+
+
+  ///\brief Function to get an iterator to the smallest key (its path from the root).
+  const_iterator begin() const;
+
+  ///\brief Function to get the past-the-end iterator.
+  const_iterator end() const noexcept;
+
+};
+
+
+///\brief TopDownRBTree's constant iterator. Nodes have no parent, so the iterator keeps the stack
+///       of the ancestors still to be visited (at most the tree's height, 2*log2(n+1) entries).
+template <class T, class CMP, class ALLOC>
+class TopDownRBTree<T, CMP, ALLOC>::const_iterator {
+  friend class TopDownRBTree;
+
+  std::vector<const Node*> path; ///< current node on top, below it the ancestors it lies in the left subtree of.
+
+
+  ///\brief Pushes a node and the left spine of its subtree.
+  void push_left(const Node* node) {
+    for (; node!=nullptr; node = node->link[0]) {
+      path.push_back(node);
+    }
+  }
+
+
+public:
+  typedef std::forward_iterator_tag iterator_category; ///< iterator traits, for the standard algorithms.
+  typedef T value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const T* pointer;
+  typedef const T& reference;
+
+
+  ///\brief Constructor of the past-the-end iterator.
+  const_iterator() noexcept {}
+
+
+  ///\brief Dereference operator.
+  ///\return Const reference to the key of the current node.
+  const T& operator*() const noexcept {return path.back()->data;}
+
+
+  ///\brief Member access operator.
+  const T* operator->() const noexcept {return &path.back()->data;}
+
+
+  ///\brief Prefix ++ operator: next key in order (past-the-end after the largest).
+  const_iterator& operator++() {
+    const Node* node{path.back()};
+    path.pop_back();
+    push_left(node->link[1]);
+    return *this;
+  }
+
+
+  ///\brief Postfix ++ operator.
+  const_iterator operator++(int) {
+    const_iterator previous{*this};
+    ++(*this);
+    return previous;
+  }
+
+
+  ///\brief Equality operator: same node (or both past-the-end).
+  bool operator==(const const_iterator& other) const noexcept {
+    return path.empty() ? other.path.empty() : (!other.path.empty() and path.back()==other.path.back());
+  }
+
+
+  ///\brief Inequality operator.
+  bool operator!=(const const_iterator& other) const noexcept {return !(*this==other);}
+
+};
+
+// --------------------------------IMPLEMENTATION------------------------------------------
+
+// private methods
+
+template <class T, class CMP, class ALLOC>
+typename TopDownRBTree<T, CMP, ALLOC>::Node* TopDownRBTree<T, CMP, ALLOC>::rotate_single(Node* node, const int dir) noexcept {
+  Node* pivot{node->link[!dir]};
+  node->link[!dir] = pivot->link[dir];
+  pivot->link[dir] = node;
+  node->red = true;
+  pivot->red = false;
+  return pivot;
+}
+
+
+template <class T, class CMP, class ALLOC>
+typename TopDownRBTree<T, CMP, ALLOC>::Node* TopDownRBTree<T, CMP, ALLOC>::rotate_double(Node* node, const int dir) noexcept {
+  node->link[!dir] = rotate_single(node->link[!dir], !dir);
+  return rotate_single(node, dir);
+}
+
+
+template <class T, class CMP, class ALLOC>
+void TopDownRBTree<T, CMP, ALLOC>::release_nodes() noexcept {
+  if constexpr (!std::is_trivially_destructible<T>::value) {
+    std::vector<Node*> stack;
+    if (root!=nullptr) {
+      stack.push_back(root);
+    }
+    while (!stack.empty()) {
+      Node* node{stack.back()};
+      stack.pop_back();
+      for (Node* child : node->link) {
+        if (child!=nullptr) {
+          stack.push_back(child);
+        }
+      }
+      pool.destroy(node);
+    }
+  }
+  pool.release();
+  root = nullptr;
+  keys = 0;
+}
+
+// public methods
+
+template <class T, class CMP, class ALLOC>
+TopDownRBTree<T, CMP, ALLOC>::TopDownRBTree(const TopDownRBTree& other, const ALLOC& alloc)
+  : pool{NodeAllocator(alloc)}, keys{other.keys}, comparator{other.comparator} {
+  if (other.root==nullptr) {
+    return;
+  }
+  pool.reserve_exact(other.keys);
+  std::vector<std::pair<const Node*, Node**>> stack{{other.root, &root}}; // source node, link to fill
+  while (!stack.empty()) {
+    auto [source, link] = stack.back();
+    stack.pop_back();
+    Node* copied{pool.create(source->data)};
+    copied->red = source->red;
+    *link = copied;
+    for (int dir : {1, 0}) {
+      if (source->link[dir]!=nullptr) {
+        stack.emplace_back(source->link[dir], &copied->link[dir]);
+      }
+    }
+  }
+}
+
+
+template <class T, class CMP, class ALLOC>
+bool TopDownRBTree<T, CMP, ALLOC>::insert(const T& value) {
+  if (root==nullptr) {
+    root = pool.create(value);
+    root->red = false;
+    ++keys;
+    return true;
+  }
+  Links head; // false root, so that the real root can be rotated like any other node
+  Links* great{&head};  // great-grandparent
+  Node* grand{nullptr}; // grandparent
+  Node* parent{nullptr};
+  Node* node{root};
+  head.link[1] = root;
+  int dir{0}, last{0};
+  bool inserted{false};
+  for (;;) {
+    if (node==nullptr) { // bottom reached: new red leaf
+      node = pool.create(value);
+      parent->link[dir] = node;
+      inserted = true;
+    } else if (is_red(node->link[0]) and is_red(node->link[1])) { // split a 4-node on the way down
+      node->red = node!=root; // the root stays black
+      node->link[0]->red = false;
+      node->link[1]->red = false;
+    }
+    if (is_red(node) and is_red(parent)) { // red violation, fixed right here by one or two rotations
+      int side{great->link[1]==grand};
+      great->link[side] = node==parent->link[last] ? rotate_single(grand, !last) : rotate_double(grand, !last);
+      root = head.link[1]; // kept current: the tree is whole should the leaf's creation (or a comparison) throw
+    }
+    if (inserted or equivalent(node->data, value)) {
+      break;
+    }
+    last = dir;
+    dir = comparator(node->data, value);
+    if (grand!=nullptr) {
+      great = grand;
+    }
+    grand = parent;
+    parent = node;
+    node = node->link[dir];
+  }
+  keys += inserted;
+  return inserted;
+}
+
+
+template <class T, class CMP, class ALLOC>
+bool TopDownRBTree<T, CMP, ALLOC>::delete_(const T& value) noexcept {
+  if (root==nullptr) {
+    return false;
+  }
+  Links head; // false root (see: insert)
+  head.link[1] = root;
+  Links* grand{nullptr};
+  Links* parent{nullptr};
+  Links* node{&head};
+  Node* found{nullptr};
+  int dir{1};
+  while (node->link[dir]!=nullptr) {
+    int last{dir};
+    grand = parent;
+    parent = node;
+    Node* current{node->link[dir]};
+    node = current;
+    dir = comparator(current->data, value);
+    if (found==nullptr and equivalent(current->data, value)) {
+      found = current;
+    }
+    if (is_red(current) or is_red(current->link[dir])) {
+      continue;
+    }
+    // push a red node down, so that the leaf finally removed is red
+    if (is_red(current->link[!dir])) {
+      parent = parent->link[last] = rotate_single(current, dir);
+      continue;
+    }
+    Node* sibling{parent->link[!last]}; // never set when parent is the false root
+    if (sibling==nullptr) {
+      continue;
+    }
+    Node* father{static_cast<Node*>(parent)};
+    if (!is_red(sibling->link[0]) and !is_red(sibling->link[1])) { // color flip
+      father->red = false;
+      sibling->red = true;
+      current->red = true;
+    } else {
+      int side{grand->link[1]==father};
+      grand->link[side] = is_red(sibling->link[last]) ? rotate_double(father, last) : rotate_single(father, last);
+      Node* top{grand->link[side]};
+      current->red = top->red = true;
+      top->link[0]->red = top->link[1]->red = false;
+    }
+  }
+  if (found!=nullptr) { // node is found or its in-order neighbour, and has at most one child
+    Node* leaf{static_cast<Node*>(node)};
+    if (found!=leaf) {
+      found->data = std::move(leaf->data);
+    }
+    parent->link[parent->link[1]==leaf] = leaf->link[leaf->link[0]==nullptr];
+    pool.destroy(leaf);
+    --keys;
+  }
+  root = head.link[1];
+  if (root!=nullptr) {
+    root->red = false;
+  }
+  return found!=nullptr;
+}
+
+
+template <class T, class CMP, class ALLOC>
+bool TopDownRBTree<T, CMP, ALLOC>::contains(const T& value) const noexcept {
+  const Node* node{root};
+  while (node!=nullptr) {
+    if (comparator(value, node->data)) {
+      node = node->link[0];
+    } else if (comparator(node->data, value)) {
+      node = node->link[1];
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+template <class T, class CMP, class ALLOC>
+typename TopDownRBTree<T, CMP, ALLOC>::const_iterator TopDownRBTree<T, CMP, ALLOC>::find(const T& value) const {
+  const_iterator it;
+  const Node* node{root};
+  while (node!=nullptr) {
+    if (comparator(value, node->data)) { // node comes after value: stays on the stack
+      it.path.push_back(node);
+      node = node->link[0];
+    } else if (comparator(node->data, value)) {
+      node = node->link[1];
+    } else {
+      it.path.push_back(node);
+      return it;
+    }
+  }
+  return end();
+}
+
+
+template <class T, class CMP, class ALLOC>
+std::size_t TopDownRBTree<T, CMP, ALLOC>::get_height() const {
+  std::size_t height{0};
+  std::vector<std::pair<const Node*, std::size_t>> stack;
+  if (root!=nullptr) {
+    stack.emplace_back(root, 1);
+  }
+  while (!stack.empty()) {
+    auto [node, depth] = stack.back();
+    stack.pop_back();
+    height = std::max(height, depth);
+    for (const Node* child : node->link) {
+      if (child!=nullptr) {
+        stack.emplace_back(child, depth+1);
+      }
+    }
+  }
+  return height;
+}
+
+
+template <class T, class CMP, class ALLOC>
+bool TopDownRBTree<T, CMP, ALLOC>::is_valid() const {
+  if (is_red(root)) {
+    return false;
+  }
+  std::size_t black_height{0}, counted{0};
+  std::vector<std::pair<const Node*, std::size_t>> stack; // node, black nodes above it
+  if (root!=nullptr) {
+    stack.emplace_back(root, 0);
+  }
+  while (!stack.empty()) {
+    auto [node, blacks] = stack.back();
+    stack.pop_back();
+    ++counted;
+    blacks += !node->red;
+    for (int dir : {0, 1}) {
+      const Node* child{node->link[dir]};
+      if (child==nullptr) { // a leaf: every path must have the same black height
+        if (black_height==0) {
+          black_height = blacks;
+        } else if (black_height!=blacks) {
+          return false;
+        }
+        continue;
+      }
+      if ((node->red and child->red) or (dir==0 ? !comparator(child->data, node->data) : !comparator(node->data, child->data))) {
+        return false;
+      }
+      stack.emplace_back(child, blacks);
+    }
+  }
+  bool ordered{true};
+  const T* previous{nullptr};
+  for (const_iterator it{begin()}; it!=end() and ordered; ++it) { // in order over the whole tree
+    ordered = previous==nullptr or comparator(*previous, *it);
+    previous = &*it;
+  }
+  return ordered and counted==keys;
+}
+
+
+template <class T, class CMP, class ALLOC>
+typename TopDownRBTree<T, CMP, ALLOC>::const_iterator TopDownRBTree<T, CMP, ALLOC>::begin() const {
+  const_iterator it;
+  it.push_left(root);
+  return it;
+}
+
+
+template <class T, class CMP, class ALLOC>
+typename TopDownRBTree<T, CMP, ALLOC>::const_iterator TopDownRBTree<T, CMP, ALLOC>::end() const noexcept {
+  return const_iterator{};
+}
+
+
+#endif // RBT_TOPDOWN_HPP
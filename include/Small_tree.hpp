@@ -0,0 +1,297 @@
+///\file Small_tree.hpp
+///\author mpv
+///\brief header file with SmallTree, a sorted inline array of a few keys which becomes a RBTree when it grows.
+
+#ifndef SMALL_TREE_HPP
+#define SMALL_TREE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include "RBT.hpp"
+
+
+///\brief SmallTree holds up to N keys in a sorted array inside the object itself: no NIL sentinel, no node pool,
+///       no allocation at all. Searches count the stored keys smaller than the value, in one pass without
+///       branches (a loop the compiler vectorizes for arithmetic keys), which beats a tree descent at this size.
+///       The (N+1)-th key promotes the set to a RBTree allocated on the heap, with the same operations and
+///       iterators; deletions demote it back to the array at N/2 keys, so that a size hovering around N does
+///       not rebuild at every operation.
+///\param T type of the keys.
+///\param N keys held inline, at most (default 16).
+///\param CMP relational function to compare keys (default std::less<T>).
+template <class T, std::size_t N=16, class CMP=std::less<T>>
+class SmallTree {
+  static_assert(N>=2, "SmallTree needs room for two keys at least");
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef RBTree<T, CMP> Tree; ///< type of the promoted set.
+
+
+private:
+  std::array<T, N> keys{};    ///< the keys in order while small, the first count of them are stored.
+  std::size_t count{0};       ///< number of keys, in either mode.
+  std::unique_ptr<Tree> tree; ///< the keys once promoted, nullptr while small.
+
+
+  ///\brief Helper function to count the stored keys smaller than value, i.e. its position in the array (branch free).
+  std::size_t position(const T& value) const noexcept {
+    std::size_t below{0};
+    for (std::size_t i{0}; i<count; ++i) {
+      below += comparator(keys[i], value);
+    }
+    return below;
+  }
+
+
+  ///\brief Helper function to move the keys to a RBTree, together with a new one.
+  void promote(const T& value) {
+    std::unique_ptr<Tree> promoted{std::make_unique<Tree>()};
+    promoted->comparator = comparator;
+    promoted->bulk_load(keys.begin(), keys.begin()+count);
+    promoted->insert(value);
+    tree = std::move(promoted);
+  }
+
+
+  ///\brief Helper function to move the keys of the RBTree back to the array, and free the tree.
+  void demote() {
+    std::size_t i{0};
+    tree->visit_inorder([this, &i](const T& key) { keys[i++] = key; });
+    tree.reset();
+  }
+
+
+public:
+  CMP comparator; ///< comparison operator.
+
+  static constexpr std::size_t inline_keys{N}; ///< keys held without allocation, at most.
+
+  class const_iterator;
+
+
+  ///\brief SmallTree's constructor.
+  ///\param cmp A custom comparison function for keys (defaulted to std::less).
+  explicit SmallTree(CMP cmp=CMP{}) noexcept: comparator{cmp} {}
+
+
+  ///\brief Copy constructor: the array is copied, a promoted tree deep copied.
+  SmallTree(const SmallTree& other): keys{other.keys}, count{other.count}, comparator{other.comparator} {
+    if (other.tree!=nullptr) {
+      tree = std::make_unique<Tree>(*other.tree);
+    }
+  }
+
+
+  ///\brief Copy assignment (copy and swap).
+  SmallTree& operator=(const SmallTree& other) {
+    if (this!=&other) {
+      SmallTree copied{other};
+      swap(copied);
+    }
+    return *this;
+  }
+
+
+  ///\brief Move constructor: the array is moved, a promoted tree handed over; the moved set is left empty.
+  SmallTree(SmallTree&& other) noexcept: keys{std::move(other.keys)}, count{other.count}, tree{std::move(other.tree)}, comparator{other.comparator} {
+    other.count = 0;
+  }
+
+
+  ///\brief Move assignment (see: swap).
+  SmallTree& operator=(SmallTree&& other) noexcept {
+    if (this!=&other) {
+      swap(other);
+    }
+    return *this;
+  }
+
+
+  ///\brief Function to exchange the content of two sets.
+  void swap(SmallTree& other) noexcept {
+    using std::swap;
+    swap(keys, other.keys);
+    swap(count, other.count);
+    swap(tree, other.tree);
+    swap(comparator, other.comparator);
+  }
+
+
+  ///\brief Function to insert a new key; the (N+1)-th one promotes the set to a RBTree.
+  ///\param value The value you are going to insert.
+  void insert(const T& value) {
+    if (tree!=nullptr) {
+      count += tree->insert(value);
+      return;
+    }
+    const std::size_t at{position(value)};
+    if (at<count and !comparator(value, keys[at])) { // already stored
+      return;
+    }
+    if (count==N) {
+      promote(value);
+    } else {
+      std::move_backward(keys.begin()+at, keys.begin()+count, keys.begin()+count+1);
+      keys[at] = value;
+    }
+    ++count;
+  }
+
+
+  ///\brief Function to delete a key; a RBTree left with N/2 keys is demoted to the array.
+  ///\param value The value you are going to delete.
+  void delete_(const T& value) {
+    if (tree!=nullptr) {
+      if (tree->delete_(value) and --count<=N/2) { // a missing value is reported by the tree
+        demote();
+      }
+      return;
+    }
+    const std::size_t at{position(value)};
+    if (at==count or comparator(value, keys[at])) {
+      if constexpr (_is_printable<T>::value) { // records need no operator<<
+        std::cout << "Value " << value << " not found" << std::endl;
+      }
+      return;
+    }
+    std::move(keys.begin()+at+1, keys.begin()+count, keys.begin()+at);
+    --count;
+  }
+
+
+  ///\brief Function to test whether a key is stored.
+  bool contains(const T& value) const noexcept {
+    if (tree!=nullptr) {
+      return tree->contains(value);
+    }
+    const std::size_t at{position(value)};
+    return at<count and !comparator(value, keys[at]);
+  }
+
+
+  ///\brief Function to find a value.
+  ///\return The stored key if present, a value-initialized key otherwise (as RBTree::find).
+  const T& find(const T& value) const noexcept {
+    static const T missing{};
+    if (tree!=nullptr) {
+      return tree->find(value);
+    }
+    const std::size_t at{position(value)};
+    return at<count and !comparator(value, keys[at]) ? keys[at] : missing;
+  }
+
+
+  ///\brief Function to find the first key not smaller than value.
+  ///\return Iterator to the key, end() if every key is smaller.
+  const_iterator lower_bound(const T& value) const noexcept {
+    return tree!=nullptr ? const_iterator{tree->lower_bound(value)} : const_iterator{keys.data()+position(value)};
+  }
+
+
+  ///\brief Getter for the smallest key (the set must not be empty).
+  const T& min() const noexcept {return tree!=nullptr ? tree->min() : keys[0];}
+
+  ///\brief Getter for the largest key (the set must not be empty).
+  const T& max() const noexcept {return tree!=nullptr ? tree->max() : keys[count-1];}
+
+  ///\brief Getter for the number of keys.
+  std::size_t size() const noexcept {return count;}
+
+  ///\brief Function to test whether the set holds no key.
+  bool empty() const noexcept {return count==0;}
+
+  ///\brief Whether the keys are held inline (false once promoted to a RBTree).
+  bool is_small() const noexcept {return tree==nullptr;}
+
+  ///\brief Function to get an iterator to the smallest key.
+  const_iterator begin() const noexcept {return tree!=nullptr ? const_iterator{tree->begin()} : const_iterator{keys.data()};}
+
+  ///\brief Function to get the end of the keys.
+  const_iterator end() const noexcept {return tree!=nullptr ? const_iterator{tree->end()} : const_iterator{keys.data()+count};}
+
+};
+
+
+///\brief SmallTree's constant iterator: a pointer into the array while small, a RBTree's const_iterator once promoted.
+template <class T, std::size_t N, class CMP>
+class SmallTree<T, N, CMP>::const_iterator {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef typename Tree::const_iterator TreeIterator; ///< iterator of the promoted set.
+
+  const T* key{nullptr};                 ///< key pointed in the array, nullptr once promoted.
+  TreeIterator node{nullptr, nullptr};   ///< node pointed in the promoted tree.
+
+public:
+  typedef std::bidirectional_iterator_tag iterator_category; ///< iterator traits, for the standard algorithms.
+  typedef T value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const T* pointer;
+  typedef const T& reference;
+
+
+  ///\brief Constructor of an iterator over the array.
+  explicit const_iterator(const T* pointed) noexcept: key{pointed} {}
+
+  ///\brief Constructor of an iterator over the promoted tree.
+  explicit const_iterator(const TreeIterator& pointed) noexcept: node{pointed} {}
+
+
+  ///\brief Dereference operator.
+  const T& operator*() const noexcept {return key!=nullptr ? *key : *node;}
+
+  ///\brief Member access operator.
+  const T* operator->() const noexcept {return &**this;}
+
+
+  ///\brief Prefix ++ operator: next key in order.
+  const_iterator& operator++() noexcept {
+    if (key!=nullptr) {
+      ++key;
+    } else {
+      ++node;
+    }
+    return *this;
+  }
+
+
+  ///\brief Postfix ++ operator.
+  const_iterator operator++(int) noexcept {
+    const_iterator retval{*this};
+    ++(*this);
+    return retval;
+  }
+
+
+  ///\brief Prefix -- operator: previous key in order.
+  const_iterator& operator--() noexcept {
+    if (key!=nullptr) {
+      --key;
+    } else {
+      --node;
+    }
+    return *this;
+  }
+
+
+  ///\brief Postfix -- operator.
+  const_iterator operator--(int) noexcept {
+    const_iterator retval{*this};
+    --(*this);
+    return retval;
+  }
+
+
+  bool operator==(const const_iterator& other) const noexcept {return key==other.key and node==other.node;}
+  bool operator!=(const const_iterator& other) const noexcept {return !(*this==other);}
+
+};
+
+
+#endif // SMALL_TREE_HPP
@@ -0,0 +1,144 @@
+///\file Static_set.hpp
+///\author mpv
+///\brief header file with StaticSet, an ordered set of keys fixed at compile time and stored in a flat sorted array.
+
+#ifndef STATIC_SET_HPP
+#define STATIC_SET_HPP
+
+#include <array>
+#include <cstddef>
+#include <functional>
+
+
+///\brief StaticSet is an ordered set built by a constant expression: a table declared constexpr is sorted by the
+///       compiler and lands in read-only data, so it costs no allocation and no work at startup.
+///       Queries follow RBTree's (contains, find, lower_bound, min, max, in-order iteration) on a sorted array.
+///\param T type of the keys, a literal type.
+///\param N capacity of the set, the number of keys it is built from (duplicates are dropped).
+///\param CMP relational function to compare keys, whose call operator is constexpr (default std::less<T>).
+template <class T, std::size_t N, class CMP=std::less<T>>
+class StaticSet {
+
+public:
+  typedef const T* const_iterator; ///< keys are visited in order by pointer.
+
+
+private:
+  std::array<T, N> keys{};  ///< sorted distinct keys in [0, count), then leftovers of the duplicates.
+  std::size_t count{0};     ///< number of distinct keys.
+  T nil{};                  ///< key returned by find() when the value is missing (as RBTree's NIL).
+  CMP comparator{};         ///< comparison of the keys.
+
+
+  ///\brief Helper function to restore the max-heap order below a slot (see: sort).
+  constexpr void sift_down(std::size_t slot, const std::size_t end) noexcept {
+    for (std::size_t child{2*slot+1}; child<end; child = 2*slot+1) {
+      if (child+1<end and comparator(keys[child], keys[child+1])) {
+        ++child;
+      }
+      if (!comparator(keys[slot], keys[child])) {
+        return;
+      }
+      T moved{keys[slot]};
+      keys[slot] = keys[child];
+      keys[child] = moved;
+      slot = child;
+    }
+  }
+
+
+  ///\brief Helper function to sort and deduplicate the keys: heapsort, O(N log N) steps for the compiler.
+  constexpr void sort() noexcept {
+    for (std::size_t slot{N/2}; slot>0; --slot) {
+      sift_down(slot-1, N);
+    }
+    for (std::size_t end{N}; end>1; --end) {
+      T largest{keys[0]};
+      keys[0] = keys[end-1];
+      keys[end-1] = largest;
+      sift_down(0, end-1);
+    }
+    for (std::size_t i{0}; i<N; ++i) { // keep the first of every run of equivalent keys
+      if (count==0 or comparator(keys[count-1], keys[i])) {
+        keys[count++] = keys[i];
+      }
+    }
+  }
+
+
+public:
+  ///\brief StaticSet's constructor from an array of keys, in any order.
+  ///\param values The keys of the set.
+  ///\param cmp A custom comparison function for keys (defaulted to std::less).
+  constexpr StaticSet(const T (&values)[N], CMP cmp=CMP{}) noexcept: comparator{cmp} {
+    for (std::size_t i{0}; i<N; ++i) {
+      keys[i] = values[i];
+    }
+    sort();
+  }
+
+
+  ///\brief StaticSet's constructor from a std::array of keys, in any order (e.g. computed by a constexpr function).
+  constexpr StaticSet(const std::array<T, N>& values, CMP cmp=CMP{}) noexcept: keys{values}, comparator{cmp} {sort();}
+
+
+  ///\brief Function to find the first key not smaller than value, by a branch free binary search.
+  ///\return Pointer to the key, end() if every key is smaller.
+  constexpr const_iterator lower_bound(const T& value) const noexcept {
+    if (count==0) {
+      return end();
+    }
+    const T* base{keys.data()};
+    for (std::size_t remaining{count}; remaining>1; remaining -= remaining/2) { // conditional move, no branch to mispredict
+      base = comparator(base[remaining/2], value) ? base+remaining/2 : base;
+    }
+    return comparator(*base, value) ? base+1 : base;
+  }
+
+
+  ///\brief Function to test whether the set contains a value, in O(log n).
+  constexpr bool contains(const T& value) const noexcept {
+    const_iterator bound{lower_bound(value)};
+    return bound!=end() and !comparator(value, *bound);
+  }
+
+
+  ///\brief Function to find a value in the set.
+  ///\return The stored key equivalent to value if present, a value-initialized key otherwise (as RBTree::find).
+  constexpr const T& find(const T& value) const noexcept {
+    const_iterator bound{lower_bound(value)};
+    return bound!=end() and !comparator(value, *bound) ? *bound : nil;
+  }
+
+
+  ///\brief Getter for the smallest key (the set must not be empty).
+  constexpr const T& min() const noexcept {return keys[0];}
+
+  ///\brief Getter for the largest key (the set must not be empty).
+  constexpr const T& max() const noexcept {return keys[count-1];}
+
+  ///\brief Getter for the number of distinct keys.
+  constexpr std::size_t size() const noexcept {return count;}
+
+  ///\brief Function to test whether the set holds no key.
+  constexpr bool empty() const noexcept {return count==0;}
+
+  ///\brief Function to get a pointer to the smallest key.
+  constexpr const_iterator begin() const noexcept {return keys.data();}
+
+  ///\brief Function to get a pointer past the largest key.
+  constexpr const_iterator end() const noexcept {return keys.data()+count;}
+
+};
+
+
+///\brief Function to build a StaticSet deducing its capacity, e.g. constexpr auto codes{make_static_set<int>({404, 200, 500})}.
+///\param values The keys of the set, in any order.
+///\param cmp A custom comparison function for keys (defaulted to std::less).
+template <class T, std::size_t N, class CMP=std::less<T>>
+constexpr StaticSet<T, N, CMP> make_static_set(const T (&values)[N], CMP cmp=CMP{}) noexcept {
+  return StaticSet<T, N, CMP>{values, cmp};
+}
+
+
+#endif // STATIC_SET_HPP
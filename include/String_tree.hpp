@@ -0,0 +1,272 @@
+///\file String_tree.hpp
+///\author mpv
+///\brief header file with a RBTree of strings keeping an inline key prefix in the nodes and the rest in an arena.
+
+#ifndef STRING_TREE_HPP
+#define STRING_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "RBT.hpp"
+
+
+///\brief String key of a StringTree: its first bytes are packed inline, in a big-endian integer,
+///       the remaining ones (the tail) live in the tree's arena.
+///       Comparing two keys compares the integers first, and reads the tails only on ties.
+struct ArenaString {
+  static constexpr std::size_t inline_size{sizeof(std::uint64_t)}; ///< bytes kept inline.
+
+  std::uint64_t prefix{0};    ///< first inline_size bytes, big-endian, zero padded.
+  const char* tail{nullptr};  ///< bytes past the prefix (nullptr if there are none).
+  std::uint32_t size{0};      ///< length of the whole string.
+
+
+  ///\brief Function to build a key referring to a string owned by someone else (e.g. a lookup's probe).
+  ///\param text The string, which must outlive the key.
+  ///\return The key of text, whose tail points into text.
+  static ArenaString view(const std::string_view text) noexcept {
+    ArenaString key;
+    key.size = static_cast<std::uint32_t>(text.size());
+    for (std::size_t i{0}; i<inline_size; ++i) {
+      key.prefix = (key.prefix<<8) | (i<text.size() ? static_cast<unsigned char>(text[i]) : 0u);
+    }
+    key.tail = text.size()>inline_size ? text.data()+inline_size : nullptr;
+    return key;
+  }
+
+
+  ///\brief Function to get the length of the tail.
+  std::size_t tail_size() const noexcept {
+    return size>inline_size ? size-inline_size : 0;
+  }
+
+
+  ///\brief Function to compare the tails of two keys whose prefixes are equal.
+  ///\return A negative, zero or positive value, as std::string::compare.
+  static int compare_tails(const ArenaString& a, const ArenaString& b) noexcept {
+    std::size_t common{std::min(a.tail_size(), b.tail_size())};
+    int order{common>0 ? std::memcmp(a.tail, b.tail, common) : 0};
+    if (order!=0) {
+      return order;
+    }
+    return a.size<b.size ? -1 : (b.size<a.size ? 1 : 0);
+  }
+
+
+  ///\brief Function to write the whole string into a buffer.
+  ///\param out The buffer, overwritten.
+  void assign_to(std::string& out) const {
+    out.resize(size);
+    for (std::size_t i{0}; i<size and i<inline_size; ++i) {
+      out[i] = static_cast<char>((prefix>>(8*(inline_size-1-i))) & 0xFF);
+    }
+    if (tail_size()>0) {
+      std::memcpy(&out[inline_size], tail, tail_size());
+    }
+  }
+
+
+  bool operator==(const ArenaString& other) const noexcept {
+    return prefix==other.prefix and size==other.size and compare_tails(*this, other)==0;
+  }
+};
+
+
+///\brief Prints a key as its whole string (used by RBTree's print functions).
+inline std::ostream& operator<<(std::ostream& os, const ArenaString& key) {
+  std::string text;
+  key.assign_to(text);
+  return os << text;
+}
+
+
+///\brief Orders ArenaString keys as the strings they stand for (std::string order).
+struct ArenaStringLess {
+  bool operator()(const ArenaString& a, const ArenaString& b) const noexcept {
+    if (a.prefix!=b.prefix) { // decided by one integer compare, no memory touched
+      return a.prefix<b.prefix;
+    }
+    return ArenaString::compare_tails(a, b)<0;
+  }
+};
+
+
+///\brief Bump allocator for the keys' tails: bytes are appended to big blocks which are never moved,
+///       so the tails of all the keys share a few allocations instead of one heap buffer each.
+class _StringArena {
+  static constexpr std::size_t block_size{std::size_t{1}<<16}; ///< bytes of a regular block.
+
+  std::vector<std::unique_ptr<char[]>> blocks; ///< every block owned.
+  char* current{nullptr};                      ///< first free byte of the block being filled.
+  std::size_t left{0};                         ///< free bytes in the block being filled.
+  std::size_t reserved{0};                     ///< total bytes over all blocks.
+  std::size_t stored{0};                       ///< bytes handed out.
+
+public:
+  ///\brief Copies bytes into the arena.
+  ///\return Pointer to the copy, stable until the arena is destroyed.
+  const char* store(const char* data, const std::size_t size) {
+    stored += size;
+    if (size>block_size/4) { // large tail: a block of its own, the current one keeps filling
+      blocks.push_back(std::make_unique<char[]>(size));
+      reserved += size;
+      std::memcpy(blocks.back().get(), data, size);
+      return blocks.back().get();
+    }
+    if (size>left) {
+      blocks.push_back(std::make_unique<char[]>(block_size));
+      reserved += block_size;
+      current = blocks.back().get();
+      left = block_size;
+    }
+    char* copy{current};
+    std::memcpy(copy, data, size);
+    current += size;
+    left -= size;
+    return copy;
+  }
+
+  ///\brief Gives back the bytes of the last store (e.g. the tail of a key which was already stored).
+  ///\param size The size passed to that store.
+  void unstore(const std::size_t size) noexcept {
+    stored -= size;
+    if (size>block_size/4) { // it owns the last block
+      blocks.pop_back();
+      reserved -= size;
+      return;
+    }
+    current -= size; // the block being filled ends with that copy
+    left += size;
+  }
+
+  ///\brief Getter for the bytes handed out (live or not).
+  std::size_t size() const noexcept {return stored;}
+
+  ///\brief Getter for the bytes allocated.
+  std::size_t capacity() const noexcept {return reserved;}
+};
+
+
+///\brief StringTree stores strings in a RBTree whose nodes hold an ArenaString: the first 8 bytes of
+///       a key inline, compared as an integer, and a pointer to the rest of it in a shared arena.
+///       Keys up to 8 bytes never touch the arena; during a lookup most comparisons are decided
+///       by the inline prefixes, without dereferencing any string.
+///       Deleted keys leave their tails in the arena until compact_arena() is called.
+class StringTree {
+
+  ///   Aliasing existing types with typedef-names for clarity.
+  typedef RBTree<ArenaString, ArenaStringLess> Tree; ///< type of the balancing core.
+
+
+private:
+  Tree tree;                ///< keys, ordered as strings.
+  _StringArena arena;       ///< tails of the keys.
+  std::size_t live_tail{0}; ///< arena bytes still referred to by a key.
+
+
+  ///\brief Invokes a visitor returning void or bool (see: for_each).
+  ///\return Bool false if f asks to stop the visit.
+  template <class F>
+  static bool call_visitor(F& f, const std::string_view text) {
+    if constexpr (std::is_same<decltype(f(text)), bool>::value) {
+      return f(text);
+    } else {
+      f(text);
+      return true;
+    }
+  }
+
+
+public:
+  ///\brief Function to insert a string (stored once).
+  ///\param text The string you are going to insert.
+  void insert(const std::string_view text) {
+    ArenaString key{ArenaString::view(text)};
+    if (key.tail_size()>0) {
+      key.tail = arena.store(key.tail, key.tail_size());
+    }
+    if (!tree.insert(key)) { // already stored: the copy of the tail is not needed
+      if (key.tail_size()>0) {
+        arena.unstore(key.tail_size());
+      }
+      return;
+    }
+    live_tail += key.tail_size();
+  }
+
+
+  ///\brief Function to delete a string (its tail stays in the arena, see: compact_arena).
+  ///\param text The string you are going to delete.
+  void delete_(const std::string_view text) noexcept {
+    ArenaString key{ArenaString::view(text)};
+    if (tree.delete_(key)) {
+      live_tail -= key.tail_size();
+    }
+  }
+
+
+  ///\brief Function to test whether the tree contains a string.
+  ///\param text The string to be checked.
+  ///\return Bool true if text is stored.
+  bool contains(const std::string_view text) const noexcept {
+    return tree.contains(ArenaString::view(text));
+  }
+
+
+  ///\brief Function to visit the strings in order (see: RBTree::visit_inorder).
+  ///\param f Callable invoked as f(std::string_view), valid during the call only; returning false stops the visit.
+  ///\return Bool false if the visit has been stopped by f.
+  template <class F>
+  bool for_each(F f) const {
+    std::string text; // reused for every key
+    return tree.visit_inorder([&](const ArenaString& key) {
+      key.assign_to(text);
+      return call_visitor(f, std::string_view{text});
+    });
+  }
+
+
+  ///\brief Function to rebuild the arena with the live tails only, in key order, and the tree balanced.
+  void compact_arena() {
+    StringTree fresh;
+    std::vector<ArenaString> sorted;
+    sorted.reserve(tree.size());
+    tree.visit_inorder([&](const ArenaString& key) {
+      ArenaString copy{key};
+      if (copy.tail_size()>0) {
+        copy.tail = fresh.arena.store(key.tail, key.tail_size());
+      }
+      sorted.push_back(copy);
+    });
+    fresh.tree.bulk_load(sorted.begin(), sorted.end());
+    fresh.live_tail = live_tail;
+    std::swap(tree, fresh.tree);
+    std::swap(arena, fresh.arena);
+  }
+
+
+  ///\brief Getter for the number of strings stored.
+  std::size_t size() const noexcept {return tree.size();}
+
+  ///\brief Getter for the arena bytes allocated.
+  std::size_t arena_capacity() const noexcept {return arena.capacity();}
+
+  ///\brief Getter for the arena bytes no key refers to anymore (reclaimed by compact_arena).
+  std::size_t arena_garbage() const noexcept {return arena.size()-live_tail;}
+
+  ///\brief Function to access the underlying RBTree (e.g. to print it).
+  ///\return Const reference to the balancing core.
+  const Tree& get_tree() const noexcept {return tree;}
+
+};
+
+
+#endif // STRING_TREE_HPP
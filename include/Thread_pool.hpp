@@ -0,0 +1,191 @@
+///\file Thread_pool.hpp
+///\author mpv
+///\brief header file with the implementation of a small work-stealing thread pool (fork-join style).
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+///\brief ThreadPool runs tasks on a fixed set of workers, each owning a deque of tasks.
+///       A worker pops its own newest task first (LIFO, good locality for divide and conquer)
+///       and, when empty, steals the oldest task of another worker (FIFO, the biggest pieces of work).
+///       Threads waiting on a TaskGroup keep executing tasks instead of blocking, so nested
+///       fork-join (tasks spawning and waiting on tasks) cannot deadlock.
+class ThreadPool {
+
+public:
+  typedef std::function<void()> Task; ///< type of a unit of work.
+
+  ///\brief Set of tasks that can be waited for as a whole (see: run, wait).
+  class TaskGroup {
+    friend class ThreadPool;
+    std::atomic<std::size_t> pending{0}; ///< tasks of the group not completed yet.
+  };
+
+
+private:
+  ///\brief Worker's queue, padded to a cache line to avoid false sharing between workers.
+  struct alignas(64) Queue {
+    std::deque<Task> tasks; ///< queued tasks (owner pops back, thieves pop front).
+    std::mutex lock;        ///< protects tasks.
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues; ///< one queue per worker, plus a last one for external threads.
+  std::vector<std::thread> workers;           ///< worker threads.
+  std::atomic<std::size_t> queued{0};         ///< number of tasks waiting in any queue.
+  std::atomic<bool> stopping{false};          ///< set by the destructor.
+  std::mutex sleep_lock;                      ///< protects the idle workers' sleep.
+  std::condition_variable wake;               ///< wakes idle workers on new tasks.
+
+  inline static thread_local const ThreadPool* current_pool{nullptr}; ///< pool the calling thread works for.
+  inline static thread_local std::size_t current_index{0};            ///< index of the calling worker's queue.
+
+
+  ///\brief Index of the queue owned by the calling thread (external threads share the last one).
+  ///\return The queue index.
+  std::size_t own_index() const noexcept {
+    return current_pool==this ? current_index : queues.size()-1;
+  }
+
+
+  ///\brief Tries to pop a task, first from the own queue and then stealing from the others.
+  ///\param task Filled with the task found, if any.
+  ///\return Bool true if a task has been found.
+  bool try_pop(Task& task) noexcept {
+    std::size_t self{own_index()};
+    {
+      std::lock_guard<std::mutex> guard{queues[self]->lock};
+      if (!queues[self]->tasks.empty()) {
+        task = std::move(queues[self]->tasks.back()); // newest own task
+        queues[self]->tasks.pop_back();
+        --queued;
+        return true;
+      }
+    }
+    for (std::size_t i{1}; i<queues.size(); ++i) {
+      Queue& victim{*queues[(self+i)%queues.size()]};
+      std::lock_guard<std::mutex> guard{victim.lock};
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front()); // oldest task of another queue
+        victim.tasks.pop_front();
+        --queued;
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  ///\brief Main loop of a worker: run tasks while any, sleep otherwise.
+  ///\param index Index of the worker's own queue.
+  void worker_loop(const std::size_t index) noexcept {
+    current_pool = this;
+    current_index = index;
+    Task task;
+    while (!stopping.load()) {
+      if (try_pop(task)) {
+        task();
+        task = nullptr;
+      } else {
+        std::unique_lock<std::mutex> guard{sleep_lock};
+        wake.wait(guard, [this]() { return stopping.load() or queued.load()>0; });
+      }
+    }
+  }
+
+
+public:
+  ///\brief ThreadPool's constructor.
+  ///\param n_workers Number of worker threads (the thread calling wait works as well).
+  explicit ThreadPool(const unsigned int n_workers=std::max(1u, std::thread::hardware_concurrency())-1) {
+    for (unsigned int i{0}; i<=n_workers; ++i) {
+      queues.emplace_back(new Queue);
+    }
+    for (unsigned int i{0}; i<n_workers; ++i) {
+      workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+  }
+
+
+  ///\brief ThreadPool's destructor, joins the workers (queued tasks are dropped).
+  ~ThreadPool() noexcept {
+    {
+      std::lock_guard<std::mutex> guard{sleep_lock};
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+
+  ///\brief Function to get the number of threads executing tasks (workers plus the waiting thread).
+  ///\return The degree of parallelism.
+  std::size_t concurrency() const noexcept {
+    return workers.size()+1;
+  }
+
+
+  ///\brief Function to schedule a task as part of a group.
+  ///\param group The group the task belongs to (see: wait).
+  ///\param task The work to be executed, it must not throw.
+  void run(TaskGroup& group, Task task) {
+    ++group.pending;
+    Queue& queue{*queues[own_index()]};
+    {
+      std::lock_guard<std::mutex> guard{queue.lock};
+      queue.tasks.emplace_back([&group, task = std::move(task)]() {
+        task();
+        group.pending.fetch_sub(1, std::memory_order_release);
+      });
+      ++queued;
+    }
+    {
+      std::lock_guard<std::mutex> guard{sleep_lock}; // do not notify between a worker's check and its sleep
+    }
+    wake.notify_one();
+  }
+
+
+  ///\brief Function to wait until every task of a group has completed, executing tasks meanwhile.
+  ///\param group The group to be waited for.
+  void wait(TaskGroup& group) noexcept {
+    Task task;
+    while (group.pending.load(std::memory_order_acquire)!=0) {
+      if (try_pop(task)) {
+        task();
+        task = nullptr;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+
+  ///\brief Function to get the process-wide pool, created on first use.
+  ///\return Reference to the default pool (one thread per core).
+  static ThreadPool& default_pool() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+};
+
+
+#endif // THREAD_POOL_HPP
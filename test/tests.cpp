@@ -3,9 +3,37 @@
 #define BOOST_TEST_MODULE RBTree_tests
 #define BOOST_TEST_LOG_LEVEL message //   ./tests --log_level=message
 #include "RBT.hpp"
+#include "RBT_concurrent.hpp"
+#include "RBT_parallel.hpp"
+#include "RBT_export.hpp"
+#include "RBT_topdown.hpp"
+#include "Adaptive_tree.hpp"
+#include "Bloom_filter.hpp"
+#include "Counted_multiset.hpp"
+#include "Hashed_tree.hpp"
+#include "Key_of.hpp"
+#include "Merged_view.hpp"
+#include "RBT_diff.hpp"
+#include "RBT_mapped.hpp"
+#include "Small_tree.hpp"
+#include "Static_set.hpp"
+#include "Interval_tree.hpp"
+#include "String_tree.hpp"
+#include <algorithm>
+#include <atomic>
 #include <boost/mpl/list.hpp>
 #include <boost/test/included/unit_test.hpp>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 
@@ -71,8 +99,10 @@ BOOST_AUTO_TEST_CASE(insert_method) {
   rbt0.print_tree(); // template parameter
   std::cout << std::endl;
 
+  BOOST_CHECK_EQUAL(rbt.size(), v.size());
   BOOST_TEST_MESSAGE("Inserting a duplicate key :");
-  rbt.insert(101); // duplicate key ignored by design
+  BOOST_CHECK_EQUAL(rbt.insert(101), false); // duplicate key ignored by design
+  BOOST_CHECK_EQUAL(rbt.size(), v.size());
   rbt.print_tree();
   std::cout << std::endl;
 }
@@ -89,13 +119,15 @@ BOOST_AUTO_TEST_CASE(find_and_contains_methods) {
 //--------------------------------------
 BOOST_AUTO_TEST_CASE(delete_method) {
   BOOST_TEST_MESSAGE("Testing RBTree delete_() :");
-  rbt.delete_(102);
-  rbt.delete_(52);
-  rbt.delete_(55);
+  std::size_t size{rbt.size()};
+  BOOST_CHECK_EQUAL(rbt.delete_(102), true);
+  BOOST_CHECK_EQUAL(rbt.delete_(52), true);
+  BOOST_CHECK_EQUAL(rbt.delete_(55), true);
   BOOST_CHECK_EQUAL(rbt.contains(52), false); // after deletion not found
   BOOST_CHECK_EQUAL(rbt.contains(55), false); // after deletion not found
-  rbt.delete_(82); // not present not deleted
-  rbt.delete_(10); // not present not deleted
+  BOOST_CHECK_EQUAL(rbt.delete_(82), false); // not present not deleted
+  BOOST_CHECK_EQUAL(rbt.delete_(10), false); // not present not deleted
+  BOOST_CHECK_EQUAL(rbt.size(), size-3);
 }
 //--------------------------------------
 BOOST_AUTO_TEST_CASE(get_root_method) {
@@ -153,6 +185,7 @@ BOOST_AUTO_TEST_SUITE(RBTree_copy_move_semantics)
 RBTree<int> rbt{999}; 
 RBTree<int> rbt3{rbt};              // copy constructor
 RBTree<int> rbt4{};
+const int* moved_key{&rbt.find(999)};
 RBTree<int> rbt5{std::move(rbt)};   //move constructor
 RBTree<int> rbt6{};
 
@@ -162,27 +195,96 @@ BOOST_AUTO_TEST_CASE(copy_constructor_and_assignement) {
   std::cout << std::endl;
   rbt3.print_tree();
   std::cout << std::endl;
-  BOOST_CHECK_EQUAL(rbt3.find(999), rbt.find(999));
-  BOOST_CHECK_NE(&rbt3.find(999), &rbt.find(999)); // testing deep copy (different addresses)
+  BOOST_CHECK_EQUAL(rbt3.find(999), 999);
+  BOOST_CHECK_NE(&rbt3.find(999), moved_key); // testing deep copy (different addresses)
 
-  rbt4 = rbt;                       // copy assignment
+  rbt4 = rbt3;                      // copy assignment
   rbt4.print_tree();
   std::cout << std::endl;
-  BOOST_CHECK_EQUAL(rbt4.find(999), rbt.find(999));
-  BOOST_CHECK_NE(&rbt4.find(999), &rbt.find(999)); // testing deep copy (different addresses)
+  BOOST_CHECK_EQUAL(rbt4.find(999), rbt3.find(999));
+  BOOST_CHECK_NE(&rbt4.find(999), &rbt3.find(999)); // testing deep copy (different addresses)
 }
 //--------------------------------------
 BOOST_AUTO_TEST_CASE(move_constructor_and_assignement) {
   BOOST_TEST_MESSAGE("Testing RBTree move constructor & assignment :");
   rbt5.print_tree();
   std::cout << std::endl;
-  BOOST_CHECK_EQUAL(rbt5.find(999), rbt.find(999));
-  BOOST_CHECK_EQUAL(&rbt5.find(999), &rbt.find(999)); // testing move (same address)
+  BOOST_CHECK_EQUAL(rbt5.find(999), 999);
+  BOOST_CHECK_EQUAL(&rbt5.find(999), moved_key); // testing move (same address)
+  BOOST_CHECK_EQUAL(rbt.contains(999), false);   // the moved tree is left empty
+  rbt.insert(7);                                 // and usable
+  BOOST_CHECK_EQUAL(rbt.contains(7), true);
   rbt6 = std::move(rbt5);           // move assignment
   rbt6.print_tree();
   std::cout << std::endl;
-  BOOST_CHECK_EQUAL(rbt6.find(999), rbt5.find(999));
-  BOOST_CHECK_EQUAL(&rbt6.find(999), &rbt5.find(999)); // testing move (same address)
+  BOOST_CHECK_EQUAL(rbt6.find(999), 999);
+  BOOST_CHECK_EQUAL(&rbt6.find(999), moved_key); // testing move (same address)
+  BOOST_CHECK_EQUAL(rbt5.contains(999), false);
+  swap(rbt6, rbt);                               // O(1) swap
+  BOOST_CHECK_EQUAL(&rbt.find(999), moved_key);
+  BOOST_CHECK_EQUAL(rbt6.contains(7), true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(deep_copy_and_parallel_clone) {
+  BOOST_TEST_MESSAGE("Testing RBTree deep copy of a large tree & parallel_clone() :");
+  RBTree<int, std::greater<int>, SumAugmentation<int>> big{};
+  for (int i{0}; i<20000; ++i) {
+    big.insert((i*7919)%20000+1);
+  }
+  auto copied{big};
+  auto cloned{parallel_clone(big, 64)};
+  BOOST_CHECK_EQUAL(copied.aggregate(), big.aggregate());
+  BOOST_CHECK_EQUAL(cloned.aggregate(), big.aggregate());
+  BOOST_CHECK_EQUAL(cloned.layout_stats().chunks, 1); // one block sized up front
+  BOOST_CHECK_EQUAL(*cloned.begin(), 20000);          // the comparator is copied
+  auto it{cloned.begin()};
+  for (const int& key : big) {
+    BOOST_REQUIRE_EQUAL(*it, key);
+    ++it;
+  }
+  BOOST_CHECK_EQUAL(cloned.get_height(cloned.get_root()), big.get_height(big.get_root()));
+  big.delete_(20000);
+  cloned.insert(20001);
+  BOOST_CHECK_EQUAL(copied.contains(20000), true);
+  BOOST_CHECK_EQUAL(big.contains(20001), false);
+  BOOST_CHECK_EQUAL(*cloned.begin(), 20001);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(nothrow_moves) {
+  BOOST_TEST_MESSAGE("Testing RBTree moves without allocation (vector growth, moved-from trees) :");
+  static_assert(std::is_nothrow_move_constructible<RBTree<int>>::value);
+  static_assert(std::is_nothrow_default_constructible<RBTree<int>>::value);
+  static_assert(std::is_nothrow_move_constructible<HashedTree<int>>::value);
+  static_assert(std::is_nothrow_move_constructible<StringTree>::value);
+  std::vector<RBTree<int>> trees(1);
+  for (int i{0}; i<1000; ++i) {
+    trees[0].insert(i);
+  }
+  const int* key{&trees[0].find(500)};
+  trees.reserve(64); // moved, not copied
+  BOOST_CHECK_EQUAL(&trees[0].find(500), key);
+  RBTree<int> moved{std::move(trees[0])};
+  BOOST_CHECK_EQUAL(trees[0].empty(), true);
+  BOOST_CHECK_EQUAL(trees[0].begin()==trees[0].end(), true);
+  for (int i{0}; i<100; ++i) { // the moved-from tree gets a NIL of its own
+    trees[0].insert(i);
+  }
+  for (int i{0}; i<100; i+=2) {
+    trees[0].delete_(i);
+  }
+  BOOST_CHECK_EQUAL(trees[0].min(), 1);
+  const RBTree<int> empty;
+  BOOST_CHECK_EQUAL(empty.get_nil()->parent==nullptr, true); // the shared empty NIL was never written
+  BOOST_CHECK_EQUAL(empty.get_nil()->color, BLACK);
+  BOOST_CHECK_EQUAL(empty.contains(0), false);
+
+  HashedTree<int> hashed;
+  hashed.insert(3);
+  HashedTree<int> hashed_moved{std::move(hashed)};
+  BOOST_CHECK_EQUAL(hashed.contains(3), false);
+  hashed.insert(4);
+  BOOST_CHECK_EQUAL(hashed.contains(4), true);
+  BOOST_CHECK_EQUAL(hashed_moved.contains(3), true);
 }
 //--------------------------------------
 
@@ -244,6 +346,1486 @@ BOOST_AUTO_TEST_CASE(const_iterator) {
 BOOST_AUTO_TEST_SUITE_END()
 //----------------------------------------------------------------
 
+BOOST_AUTO_TEST_SUITE(RBTree_concurrent)
+ConcurrentRBTree<int> crbt{}; // single writer, many readers
+
+BOOST_AUTO_TEST_CASE(single_thread_semantics) {
+  BOOST_TEST_MESSAGE("Testing ConcurrentRBTree insert(), delete_() and reader :");
+  for (int i{0}; i<100; i+=2) {
+    crbt.insert(i); // even keys are never deleted
+  }
+  auto reader{crbt.get_reader()};
+  int found{-1};
+  BOOST_CHECK_EQUAL(reader.contains(42), true);
+  BOOST_CHECK_EQUAL(reader.contains(43), false);
+  BOOST_CHECK_EQUAL(reader.find(0, found), true); // key 0 is a valid key
+  BOOST_CHECK_EQUAL(found, 0);
+  crbt.insert(43);
+  BOOST_CHECK_EQUAL(reader.contains(43), true);
+  BOOST_CHECK_EQUAL(crbt.delete_(43), true);
+  BOOST_CHECK_EQUAL(crbt.delete_(43), false); // not present not deleted
+  BOOST_CHECK_EQUAL(reader.contains(43), false);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(readers_with_concurrent_writer) {
+  BOOST_TEST_MESSAGE("Testing ConcurrentRBTree readers while the writer rotates and deletes :");
+  std::atomic<bool> stop{false};
+  std::atomic<int> wrong{0};
+  std::vector<std::thread> readers;
+  for (int r{0}; r<4; ++r) {
+    readers.emplace_back([&]() {
+      auto reader{crbt.get_reader()};
+      while (!stop.load()) {
+        for (int i{0}; i<100; i+=2) {
+          if (!reader.contains(i) or reader.contains(1000+i)) { // stable keys only
+            ++wrong;
+          }
+        }
+      }
+    });
+  }
+  for (int round{0}; round<200; ++round) { // odd keys come and go, forcing rotations
+    for (int i{1}; i<100; i+=2) {
+      crbt.insert(i);
+    }
+    for (int i{1}; i<100; i+=2) {
+      crbt.delete_(i);
+    }
+  }
+  stop = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+  BOOST_CHECK_EQUAL(wrong.load(), 0);
+  BOOST_CHECK_EQUAL(crbt.reclaim(), 0); // no reader left, every retired node is freed
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_parallel)
+RBTree<int> rbt{};
+ThreadPool pool{3}; // 3 workers plus the waiting thread
+
+BOOST_AUTO_TEST_CASE(parallel_for_each_method) {
+  BOOST_TEST_MESSAGE("Testing parallel_for_each() :");
+  for (int i{1}; i<=5000; ++i) {
+    rbt.insert(i);
+  }
+  std::atomic<long> sum{0}, count{0};
+  parallel_for_each(rbt, [&](const int& key) { sum += key; ++count; }, 16, pool); // small grain, many tasks
+  BOOST_CHECK_EQUAL(count.load(), 5000);
+  BOOST_CHECK_EQUAL(sum.load(), 5000L*5001/2);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(parallel_reduce_method) {
+  BOOST_TEST_MESSAGE("Testing parallel_reduce() :");
+  BOOST_CHECK_EQUAL(parallel_reduce(rbt, 10L, std::plus<long>{}), 10L+5000L*5001/2); // init used once
+  auto concat = [](std::vector<int> a, const std::vector<int>& b) { a.insert(a.end(), b.begin(), b.end()); return a; };
+  auto wrap = [](const int& key) { return std::vector<int>{key}; };
+  std::vector<int> keys{parallel_reduce(rbt, std::vector<int>{}, concat, wrap, 16, pool)}; // not commutative
+  BOOST_CHECK_EQUAL(keys.size(), 5000);
+  BOOST_CHECK_EQUAL(std::is_sorted(keys.begin(), keys.end()), true); // partials are joined in-order
+  RBTree<int> empty{};
+  BOOST_CHECK_EQUAL(parallel_reduce(empty, 7, std::plus<int>{}), 7);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_augmentation)
+RBTree<int, std::less<int>, SumAugmentation<int>> rbt_sum{}; // range sums
+RBTree<int, std::less<int>, CountAugmentation<int>> rbt_count{}; // range counts
+RBTree<int, std::greater<int>, MaxAugmentation<int>> rbt_max{}; // alternative order
+
+BOOST_AUTO_TEST_CASE(aggregate_after_insert) {
+  BOOST_TEST_MESSAGE("Testing RBTree aggregate() after insert() :");
+  std::vector<int> v{61,52,20,16,55,85,76,71,65,81,93,90,101,102};
+  for(long unsigned int i{0}; i<v.size(); i++) {
+    rbt_sum.insert(v[i]);
+    rbt_count.insert(v[i]);
+    rbt_max.insert(v[i]);
+  }
+  rbt_sum.insert(101); // duplicate key ignored by design
+  BOOST_CHECK_EQUAL(rbt_sum.aggregate(), 968); // whole tree
+  BOOST_CHECK_EQUAL(rbt_sum.aggregate(20, 65), 20+52+55+61); // [20, 65)
+  BOOST_CHECK_EQUAL(rbt_sum.aggregate(0, 16), 0); // empty range
+  BOOST_CHECK_EQUAL(rbt_count.aggregate(70, 95), 6);
+  BOOST_CHECK_EQUAL(rbt_count.aggregate(95, 70), 0); // reversed bounds
+  BOOST_CHECK_EQUAL(rbt_max.aggregate(80, 50), 76); // keys in (50, 80], following std::greater
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(aggregate_after_delete) {
+  BOOST_TEST_MESSAGE("Testing RBTree aggregate() after delete_() :");
+  rbt_sum.delete_(61); // root's neighbourhood, node with two children
+  rbt_sum.delete_(16);
+  rbt_count.delete_(81);
+  BOOST_CHECK_EQUAL(rbt_sum.aggregate(), 968-61-16);
+  BOOST_CHECK_EQUAL(rbt_sum.aggregate(20, 65), 20+52+55);
+  BOOST_CHECK_EQUAL(rbt_count.aggregate(70, 95), 5);
+  BOOST_CHECK_EQUAL(rbt_count.aggregate(), 13);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Interval_tree)
+IntervalTree<int> itree{};
+
+BOOST_AUTO_TEST_CASE(overlap_and_stabbing_queries) {
+  BOOST_TEST_MESSAGE("Testing IntervalTree overlapping() and stabbing() :");
+  std::vector<Interval<int>> v{{15,20},{10,30},{17,19},{5,20},{12,15},{30,40},{5,8},{50,60}};
+  for(long unsigned int i{0}; i<v.size(); i++) {
+    itree.insert(v[i]);
+  }
+  BOOST_CHECK_EQUAL(itree.max_end(), 60);
+  std::vector<Interval<int>> expected{{5,20},{10,30},{12,15},{15,20}}; // in start order
+  std::vector<Interval<int>> found{itree.overlapping(13, 16)};
+  BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(), expected.end());
+  expected = {{10,30},{30,40}}; // closed intervals: touching ends overlap
+  found = itree.stabbing(30);
+  BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(), expected.end());
+  BOOST_CHECK_EQUAL(itree.overlapping(41, 49).size(), 0);
+  BOOST_CHECK_EQUAL(itree.overlapping(0, 100).size(), v.size());
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(queries_after_delete) {
+  BOOST_TEST_MESSAGE("Testing IntervalTree after delete_() :");
+  itree.delete_({50,60});
+  itree.delete_({10,30});
+  BOOST_CHECK_EQUAL(itree.max_end(), 40); // subtree maxima follow deletions and rotations
+  BOOST_CHECK_EQUAL(itree.contains({10,30}), false);
+  std::vector<Interval<int>> expected{{30,40}};
+  std::vector<Interval<int>> found{itree.stabbing(30)};
+  BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(), expected.end());
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_compaction)
+RBTree<int, std::less<int>, SumAugmentation<int>> rbt{};
+struct Alive {
+  int key{0};
+  static inline int count{0}; ///< keys alive, NIL's included.
+  Alive() noexcept {++count;}
+  explicit Alive(int k) noexcept : key{k} {++count;}
+  Alive(const Alive& other) noexcept : key{other.key} {++count;}
+  ~Alive() {--count;}
+  bool operator<(const Alive& other) const noexcept {return key<other.key;}
+};
+
+BOOST_AUTO_TEST_CASE(compact_method) {
+  BOOST_TEST_MESSAGE("Testing RBTree compact() and layout_stats() :");
+  for (int i{0}; i<3000; ++i) { // churn: interleaved insertions and deletions
+    rbt.insert((i*7919)%2000);
+    if (i%3==0 and rbt.contains((i*104729)%2000)) { // only keys already inserted: no "not found" noise
+      rbt.delete_((i*104729)%2000);
+    }
+  }
+  int sum{rbt.aggregate()};
+  unsigned int height{rbt.get_height(rbt.get_root())};
+  LayoutStats before{rbt.layout_stats()};
+  rbt.compact(); // in-order
+  LayoutStats after{rbt.layout_stats()};
+  BOOST_CHECK_EQUAL(after.nodes, before.nodes);
+  BOOST_CHECK_EQUAL(after.slots, after.nodes); // a single block sized exactly
+  BOOST_CHECK_EQUAL(after.chunks, 1);
+  BOOST_CHECK_EQUAL(after.adjacent_ratio, 1); // in-order neighbours are memory neighbours
+  BOOST_CHECK_EQUAL(after.span, 1);
+  BOOST_CHECK_EQUAL(rbt.aggregate(), sum); // keys, colors and aggregates are preserved
+  BOOST_CHECK_EQUAL(rbt.get_height(rbt.get_root()), height);
+  rbt.compact(VAN_EMDE_BOAS);
+  BOOST_CHECK_EQUAL(rbt.layout_stats().span, 1);
+  BOOST_CHECK_EQUAL(rbt.aggregate(), sum);
+  rbt.insert(5000); // the tree keeps working on relocated nodes
+  rbt.delete_(5000);
+  BOOST_CHECK_EQUAL(rbt.aggregate(), sum);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(compact_in_background_method) {
+  BOOST_TEST_MESSAGE("Testing RBTree compact_in_background() and commit_compaction() :");
+  auto prepared{rbt.compact_in_background()};
+  BOOST_CHECK_EQUAL(rbt.commit_compaction(prepared.get()), true);
+  auto stale{rbt.prepare_compaction()};
+  rbt.insert(6000); // modified after the preparation
+  BOOST_CHECK_EQUAL(rbt.commit_compaction(std::move(stale)), false);
+  BOOST_CHECK_EQUAL(rbt.contains(6000), true);
+  RBTree<int> first{}, second{};
+  for (int i{0}; i<10; ++i) { // same history, same modification count
+    first.insert(i);
+    second.insert(-i);
+  }
+  auto foreign{second.prepare_compaction()};
+  BOOST_CHECK_EQUAL(first.commit_compaction(std::move(foreign)), false); // prepared on another tree
+  BOOST_CHECK_EQUAL(first.contains(9), true);
+  BOOST_CHECK_EQUAL(first.contains(-9), false);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(pool_growth) {
+  BOOST_TEST_MESSAGE("Testing the node pool of small, growing and emptied trees :");
+  RBTree<int> small{};
+  for (int i{0}; i<5; ++i) {
+    small.insert(i);
+  }
+  BOOST_CHECK_LE(small.layout_stats().slots, 16); // a few slots, not a big first chunk
+  RBTree<int> grown{};
+  for (int i{0}; i<10000; ++i) {
+    grown.insert(i);
+  }
+  BOOST_CHECK_LT(grown.layout_stats().slots, 2*10000); // geometric growth
+  for (int i{0}; i<9000; ++i) {
+    grown.delete_(i);
+  }
+  BOOST_CHECK_GE(grown.layout_stats().slots, 10000); // high-water mark, until compaction
+  grown.compact();
+  BOOST_CHECK_EQUAL(grown.layout_stats().slots, 1000);
+  while (!grown.empty()) {
+    grown.pop_min();
+  }
+  BOOST_CHECK_EQUAL(grown.layout_stats().slots, 0); // the last node gives the chunks back
+  grown.insert(1);
+  BOOST_CHECK_EQUAL(grown.min(), 1);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(destroy_through_parent_links) {
+  BOOST_TEST_MESSAGE("Testing the destruction of subtrees of keys with a destructor :");
+  const int before{Alive::count};
+  {
+    RBTree<Alive> tree{};
+    for (int i{0}; i<5000; ++i) {
+      tree.insert(Alive{i});
+    }
+    tree.clear_tree(tree.get_root()->left); // a subtree: its nodes go, the rest stays linked
+    int kept{0};
+    tree.visit_inorder([&kept](const Alive&) { ++kept; });
+    BOOST_CHECK_EQUAL(Alive::count, before+kept+1); // the keys left and NIL
+    BOOST_CHECK_GT(tree.min().key, 0);
+  }
+  BOOST_CHECK_EQUAL(Alive::count, before); // every node destroyed once
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_visitors)
+RBTree<int> rbt{};
+
+BOOST_AUTO_TEST_CASE(depth_first_visitors) {
+  BOOST_TEST_MESSAGE("Testing RBTree visit_inorder(), visit_preorder() and visit_postorder() :");
+  for (int key : {4, 2, 6, 1, 3, 5, 7}) {
+    rbt.insert(key); // perfect tree: 4 / 2 6 / 1 3 5 7
+  }
+  std::vector<int> keys;
+  rbt.visit_inorder([&keys](const int& key) { keys.push_back(key); });
+  BOOST_CHECK_EQUAL(keys==std::vector<int>({1, 2, 3, 4, 5, 6, 7}), true);
+  keys.clear();
+  rbt.visit_preorder([&keys](const int& key) { keys.push_back(key); });
+  BOOST_CHECK_EQUAL(keys==std::vector<int>({4, 2, 1, 3, 6, 5, 7}), true);
+  keys.clear();
+  rbt.visit_postorder([&keys](const int& key) { keys.push_back(key); });
+  BOOST_CHECK_EQUAL(keys==std::vector<int>({1, 3, 2, 5, 7, 6, 4}), true);
+  keys.clear();
+  bool completed{rbt.visit_inorder([&keys](const int& key) { keys.push_back(key); return key<3; })}; // early exit
+  BOOST_CHECK_EQUAL(completed, false);
+  BOOST_CHECK_EQUAL(keys==std::vector<int>({1, 2, 3}), true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(level_and_bounded_visitors) {
+  BOOST_TEST_MESSAGE("Testing RBTree visit_levelorder() and visit_bounded() :");
+  std::vector<int> keys;
+  std::vector<unsigned int> depths;
+  rbt.visit_levelorder([&](const int& key, unsigned int depth) { keys.push_back(key); depths.push_back(depth); });
+  BOOST_CHECK_EQUAL(keys==std::vector<int>({4, 2, 6, 1, 3, 5, 7}), true);
+  BOOST_CHECK_EQUAL(depths==std::vector<unsigned int>({0, 1, 1, 2, 2, 2, 2}), true);
+  keys.clear();
+  rbt.visit_bounded(1, [&keys](const int& key) { keys.push_back(key); });
+  BOOST_CHECK_EQUAL(keys==std::vector<int>({4, 2, 6}), true);
+  RBTree<int> empty{};
+  BOOST_CHECK_EQUAL(empty.visit_levelorder([](const int&) { return false; }), true);
+  BOOST_CHECK_EQUAL(empty.get_height(empty.get_root()), 0);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_export)
+RBTree<int> rbt{};
+
+BOOST_AUTO_TEST_CASE(export_keys_method) {
+  BOOST_TEST_MESSAGE("Testing export_keys() formats and sinks :");
+  for (int key : {30, -7, 12, 5}) {
+    rbt.insert(key);
+  }
+  std::ostringstream lines, csv, binary;
+  BOOST_CHECK_EQUAL(export_keys(rbt, lines), true);
+  BOOST_CHECK_EQUAL(lines.str(), "-7\n5\n12\n30\n");
+  export_keys(rbt, csv, CSV);
+  BOOST_CHECK_EQUAL(csv.str(), "-7,5,12,30\n");
+  export_keys(rbt, binary, BINARY);
+  int keys[4];
+  BOOST_REQUIRE_EQUAL(binary.str().size(), sizeof(keys));
+  std::memcpy(keys, binary.str().data(), sizeof(keys));
+  BOOST_CHECK_EQUAL(keys[0]==-7 and keys[3]==30, true);
+  std::FILE* file{std::tmpfile()}; // file descriptor sink
+  BOOST_CHECK_EQUAL(export_keys(rbt, fileno(file), CSV), true);
+  char text[32]{};
+  std::rewind(file);
+  std::fread(text, 1, sizeof(text)-1, file);
+  std::fclose(file);
+  BOOST_CHECK_EQUAL(std::string(text), "-7,5,12,30\n");
+  static_assert(std::is_nothrow_default_constructible<KeyExporter>::value, "a KeyExporter allocates on first use");
+  std::ostringstream none;
+  BOOST_CHECK_EQUAL(export_keys(RBTree<int>{}, none), true); // empty tree: an empty buffer, nothing written
+  BOOST_CHECK_EQUAL(none.str().empty(), true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(export_parallel_method) {
+  BOOST_TEST_MESSAGE("Testing KeyExporter export_parallel() keeps the keys in order :");
+  RBTree<double> big{};
+  for (int i{0}; i<5000; ++i) {
+    big.insert(((i*7919)%5000)/4.0);
+  }
+  ThreadPool pool{3};
+  KeyExporter exporter{256}; // small blocks: many writes
+  for (ExportFormat format : {NEWLINE, CSV, BINARY}) {
+    std::ostringstream sequential, parallel;
+    BOOST_CHECK_EQUAL(exporter.export_keys(big, StreamSink{sequential}, format), true);
+    BOOST_CHECK_EQUAL(exporter.export_parallel(big, StreamSink{parallel}, format, 64, pool), true);
+    BOOST_CHECK_EQUAL(sequential.str()==parallel.str(), true);
+  }
+  std::ostringstream text;
+  exporter.export_keys(big, StreamSink{text}, CSV);
+  BOOST_CHECK_EQUAL(text.str().substr(0, 15), "0,0.25,0.5,0.75");
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_arithmetic_keys)
+
+BOOST_AUTO_TEST_CASE(ordered_key_encoding) {
+  BOOST_TEST_MESSAGE("Testing _OrderedKey encoding and _radix_sort() :");
+  std::vector<double> reals{3.5, -0.0, -2.25, 1e300, -1e-300, 0.0, -7.0, 42.0};
+  for (std::size_t i{0}; i+1<reals.size(); ++i) {
+    for (std::size_t j{0}; j<reals.size(); ++j) { // integer order agrees with std::less
+      BOOST_CHECK_EQUAL(reals[i]<reals[j], _OrderedKey<double>::encode(reals[i])<_OrderedKey<double>::encode(reals[j]));
+    }
+    BOOST_CHECK_EQUAL(_OrderedKey<double>::decode(_OrderedKey<double>::encode(reals[i]))==reals[i], true);
+  }
+  std::vector<int> keys;
+  for (int i{0}; i<3000; ++i) {
+    keys.push_back((i*7919)%4001-2000);
+  }
+  std::vector<int> expected{keys};
+  std::sort(expected.begin(), expected.end());
+  _radix_sort(keys);
+  BOOST_CHECK_EQUAL(keys==expected, true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(arithmetic_search) {
+  BOOST_TEST_MESSAGE("Testing RBTree branch free search on int and double keys :");
+  RBTree<double> reals{};
+  for (double key : {0.5, -3.0, 12.25, -0.0, 7.0}) {
+    reals.insert(key);
+  }
+  reals.insert(0.0); // equivalent to -0.0 for std::less
+  BOOST_CHECK_EQUAL(reals.contains(0.0), true);
+  BOOST_CHECK_EQUAL(reals.contains(-3.0), true);
+  BOOST_CHECK_EQUAL(reals.contains(-3.5), false);
+  BOOST_CHECK_EQUAL(reals.contains(100.0), false);
+  reals.delete_(12.25);
+  BOOST_CHECK_EQUAL(reals.contains(12.25), false);
+  BOOST_CHECK_EQUAL(reals.get_height(reals.get_root()), 3);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(bulk_load_method) {
+  BOOST_TEST_MESSAGE("Testing RBTree bulk_load() :");
+  RBTree<int, std::less<int>, SumAugmentation<int>> rbt{};
+  rbt.insert(5);
+  std::vector<int> keys;
+  int sum{5};
+  for (int i{1}; i<=1000; ++i) {
+    keys.push_back(i);
+    keys.push_back(i); // duplicates are dropped
+    sum += i;
+  }
+  std::reverse(keys.begin(), keys.end());
+  rbt.bulk_load(keys.begin(), keys.end());
+  BOOST_CHECK_EQUAL(rbt.aggregate(), sum-5);      // 5 was already there
+  BOOST_CHECK_EQUAL(rbt.get_height(rbt.get_root()), 10); // perfectly balanced
+  BOOST_CHECK_EQUAL(rbt.layout_stats().adjacent_ratio, 1); // laid out in order
+  unsigned int black_height{0}; // every path from the root to a leaf has the same black nodes
+  bool valid{true};
+  rbt.visit_preorder([&](const int& key) {
+    auto node{rbt.get_root()};
+    while (node->data!=key) {
+      node = key<node->data ? node->left : node->right;
+    }
+    valid = valid and !(node->color==RED and node->parent->color==RED); // no red node has a red child
+    if (node->left==rbt.get_nil() or node->right==rbt.get_nil()) {
+      unsigned int blacks{0};
+      for (auto up{node}; up!=nullptr; up = up->parent) {
+        blacks += up->color==BLACK;
+      }
+      black_height = black_height==0 ? blacks : black_height;
+      valid = valid and blacks==black_height;
+    }
+  });
+  BOOST_CHECK_EQUAL(valid, true);
+  rbt.insert(2000); // the tree keeps working
+  rbt.delete_(500);
+  BOOST_CHECK_EQUAL(rbt.aggregate(), sum-5+2000-500);
+  RBTree<int, std::greater<int>> reversed{}; // generic path
+  reversed.bulk_load(keys.begin(), keys.end());
+  BOOST_CHECK_EQUAL(*reversed.begin(), 1000);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(String_tree)
+StringTree strings{};
+
+BOOST_AUTO_TEST_CASE(inline_prefix_comparisons) {
+  BOOST_TEST_MESSAGE("Testing ArenaStringLess against std::string order :");
+  std::vector<std::string> texts{"", "a", "ab", std::string("ab\0", 3), "abcdefgh", "abcdefgh\xff", "abcdefghi",
+                                 "abcdefghij", "b", "https://example.com/a", "https://example.com/b"};
+  for (const std::string& a : texts) {
+    for (const std::string& b : texts) {
+      BOOST_CHECK_EQUAL(ArenaStringLess{}(ArenaString::view(a), ArenaString::view(b)), a<b);
+    }
+  }
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(string_tree_methods) {
+  BOOST_TEST_MESSAGE("Testing StringTree insert(), contains(), delete_() and for_each() :");
+  std::set<std::string> expected;
+  for (int i{0}; i<1000; ++i) {
+    std::string url{"https://example.com/index/" + std::to_string((i*7919)%1000)}; // shuffled 0..999
+    strings.insert(url);
+    expected.insert(url);
+  }
+  strings.insert("short"); // fully inline
+  expected.insert("short");
+  std::size_t capacity{strings.arena_capacity()};
+  strings.insert("https://example.com/index/" + std::string(1<<15, 'x')); // tail in a block of its own
+  strings.insert("https://example.com/index/" + std::string(1<<15, 'x')); // its copy is given back
+  strings.insert("https://example.com/index/42"); // duplicate, its copy is given back too
+  BOOST_CHECK_GT(strings.arena_capacity(), capacity);
+  BOOST_CHECK_EQUAL(strings.arena_garbage(), 0); // no duplicate left bytes behind
+  strings.delete_("https://example.com/index/" + std::string(1<<15, 'x'));
+  strings.compact_arena();
+  BOOST_CHECK_EQUAL(strings.arena_garbage(), 0);
+  BOOST_CHECK_EQUAL(strings.size(), expected.size());
+  BOOST_CHECK_EQUAL(strings.contains("short"), true);
+  BOOST_CHECK_EQUAL(strings.contains("https://example.com/index/1000"), false);
+  BOOST_CHECK_EQUAL(strings.contains("https://example.com/index/919"), true);
+  std::vector<std::string> visited;
+  strings.for_each([&visited](std::string_view text) { visited.emplace_back(text); });
+  BOOST_CHECK_EQUAL(visited==std::vector<std::string>(expected.begin(), expected.end()), true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(compact_arena_method) {
+  BOOST_TEST_MESSAGE("Testing StringTree compact_arena() :");
+  BOOST_CHECK_EQUAL(strings.arena_garbage(), 0);
+  for (int i{0}; i<1000; i += 2) {
+    strings.delete_("https://example.com/index/" + std::to_string(i));
+  }
+  BOOST_CHECK_GT(strings.arena_garbage(), 0);
+  std::size_t size{strings.size()};
+  strings.compact_arena();
+  BOOST_CHECK_EQUAL(strings.arena_garbage(), 0);
+  BOOST_CHECK_EQUAL(strings.size(), size);
+  BOOST_CHECK_EQUAL(strings.contains("https://example.com/index/1"), true);
+  BOOST_CHECK_EQUAL(strings.contains("https://example.com/index/2"), false);
+  BOOST_CHECK_EQUAL(strings.contains("short"), true);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_allocators)
+
+///\brief memory resource counting the bytes it hands out, on top of another one.
+class counting_resource : public std::pmr::memory_resource {
+  std::pmr::memory_resource* upstream;
+public:
+  std::size_t allocated{0};
+  explicit counting_resource(std::pmr::memory_resource* source=std::pmr::new_delete_resource()) : upstream{source} {}
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    allocated += bytes;
+    return upstream->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+    allocated -= bytes;
+    upstream->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this==&other;}
+};
+
+///\brief owners of the blocks handed out by tagged_allocator's, and frees by an allocator of another tag.
+struct tagged_ledger {
+  static inline std::map<void*, int> owners{};
+  static inline int mismatches{0};
+};
+
+///\brief stateful allocator propagating on copy and move assignment, equal only to allocators of the same tag.
+template <class U>
+struct tagged_allocator {
+  typedef U value_type;
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  int tag;
+  explicit tagged_allocator(int id) noexcept : tag{id} {}
+  template <class V>
+  tagged_allocator(const tagged_allocator<V>& other) noexcept : tag{other.tag} {}
+  U* allocate(std::size_t n) {
+    U* block{std::allocator<U>{}.allocate(n)};
+    tagged_ledger::owners[block] = tag;
+    return block;
+  }
+  void deallocate(U* block, std::size_t n) noexcept {
+    tagged_ledger::mismatches += tagged_ledger::owners[block]!=tag;
+    tagged_ledger::owners.erase(block);
+    std::allocator<U>{}.deallocate(block, n);
+  }
+  template <class V>
+  bool operator==(const tagged_allocator<V>& other) const noexcept {return tag==other.tag;}
+  template <class V>
+  bool operator!=(const tagged_allocator<V>& other) const noexcept {return tag!=other.tag;}
+};
+
+BOOST_AUTO_TEST_CASE(pmr_resource_ownership) {
+  BOOST_TEST_MESSAGE("Testing pmr::RBTree allocations, copies and moves :");
+  counting_resource first, second;
+  {
+    pmr::RBTree<int> rbt{&first};
+    for (int i{1}; i<=1000; ++i) {
+      rbt.insert(i);
+    }
+    BOOST_CHECK_GT(first.allocated, 1000*sizeof(int)); // nodes and NIL come from the resource
+    BOOST_CHECK_EQUAL(rbt.get_allocator().resource()==&first, true);
+
+    pmr::RBTree<int> copied{rbt}; // select_on_container_copy_construction: default resource
+    BOOST_CHECK_EQUAL(copied.get_allocator().resource()==std::pmr::get_default_resource(), true);
+    pmr::RBTree<int> target{&second};
+    target = rbt; // copy assignment keeps the target's resource
+    BOOST_CHECK_EQUAL(target.get_allocator().resource()==&second, true);
+    BOOST_CHECK_EQUAL(target.contains(1000), true);
+    std::size_t before{second.allocated};
+
+    pmr::RBTree<int> other{&second};
+    other.insert(5);
+    target = std::move(other); // equal resources: nodes change owner
+    BOOST_CHECK_EQUAL(target.contains(5), true);
+    BOOST_CHECK_EQUAL(target.contains(1000), false);
+    target = std::move(rbt); // different resources: keys are copied into the target's resource
+    BOOST_CHECK_EQUAL(target.get_allocator().resource()==&second, true);
+    BOOST_CHECK_EQUAL(target.contains(1000), true);
+    BOOST_CHECK_GE(second.allocated, before);
+
+    pmr::RBTree<int> moved{std::move(target)};
+    BOOST_CHECK_EQUAL(moved.get_allocator().resource()==&second, true);
+    BOOST_CHECK_EQUAL(target.get_nil()!=nullptr, true); // moved-from tree is usable
+    target.insert(7);
+    BOOST_CHECK_EQUAL(target.contains(7), true);
+    moved.compact();
+    BOOST_CHECK_EQUAL(moved.contains(500), true);
+  }
+  BOOST_CHECK_EQUAL(first.allocated, 0);
+  BOOST_CHECK_EQUAL(second.allocated, 0);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(pmr_monotonic_teardown) {
+  BOOST_TEST_MESSAGE("Testing pmr::RBTree on a monotonic buffer :");
+  std::vector<char> buffer(1<<16);
+  counting_resource upstream{std::pmr::null_memory_resource()}; // nothing beyond the buffer
+  std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(), &upstream};
+  pmr::RBTree<int> rbt{&arena};
+  std::vector<int> keys{4, 2, 6, 1, 3, 5, 7};
+  rbt.bulk_load(keys.begin(), keys.end());
+  rbt.delete_(4);
+  int sum{0};
+  rbt.visit_inorder([&sum](int key) { sum += key; });
+  BOOST_CHECK_EQUAL(sum, 24);
+  BOOST_CHECK_EQUAL(upstream.allocated, 0);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(propagating_copy_assignment) {
+  BOOST_TEST_MESSAGE("Testing RBTree copy assignment with a stateful allocator propagating on copy :");
+  typedef RBTree<int, std::less<int>, NoAugmentation, tagged_allocator<int>> TaggedTree;
+  {
+    TaggedTree source{tagged_allocator<int>{1}}, target{tagged_allocator<int>{2}};
+    for (int i{0}; i<200; ++i) {
+      source.insert(i);
+      target.insert(-i);
+    }
+    target = source; // the copy's nodes come from allocator 1, which target takes
+    BOOST_CHECK_EQUAL(target.get_allocator().tag, 1);
+    BOOST_CHECK_EQUAL(source.get_allocator().tag, 1);
+    BOOST_CHECK_EQUAL(target.contains(199), true);
+    BOOST_CHECK_EQUAL(target.contains(-199), false);
+    for (int i{200}; i<400; ++i) {
+      target.insert(i);
+    }
+    BOOST_CHECK_EQUAL(target.max(), 399);
+  }
+  BOOST_CHECK_EQUAL(tagged_ledger::mismatches, 0); // every block freed by the allocator which gave it
+  BOOST_CHECK_EQUAL(tagged_ledger::owners.empty(), true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(propagating_move_assignment) {
+  BOOST_TEST_MESSAGE("Testing RBTree move assignment with a stateful allocator propagating on move :");
+  typedef RBTree<int, std::less<int>, NoAugmentation, tagged_allocator<int>> TaggedTree;
+  {
+    TaggedTree source{tagged_allocator<int>{1}}, target{tagged_allocator<int>{2}};
+    for (int i{0}; i<200; ++i) {
+      source.insert(i);
+      target.insert(-i);
+    }
+    BOOST_CHECK_EQUAL(noexcept(target = std::move(source)), true);
+    const std::size_t blocks{tagged_ledger::owners.size()};
+    target = std::move(source); // nodes and allocator 1 change owner, target's previous nodes are freed
+    BOOST_CHECK_LT(tagged_ledger::owners.size(), blocks); // nothing allocated, not even a NIL
+    BOOST_CHECK_EQUAL(target.get_allocator().tag, 1);
+    BOOST_CHECK_EQUAL(source.get_allocator().tag, 2); // with the NIL it made
+    BOOST_CHECK_EQUAL(target.contains(199), true);
+    BOOST_CHECK_EQUAL(target.contains(-199), false);
+    BOOST_CHECK_EQUAL(source.get_root()==source.get_nil(), true);
+    source.insert(5); // the moved-from tree is usable
+    BOOST_CHECK_EQUAL(source.contains(5), true);
+  }
+  BOOST_CHECK_EQUAL(tagged_ledger::mismatches, 0);
+  BOOST_CHECK_EQUAL(tagged_ledger::owners.empty(), true);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(TopDownRBTree_engine)
+
+///\brief key whose copy throws for one chosen value, to interrupt an insert() at the leaf's creation.
+struct Fragile {
+  int value;
+  static inline int throw_on{-1};
+  explicit Fragile(int v) noexcept : value{v} {}
+  Fragile(const Fragile& other) : value{other.value} {
+    if (value==throw_on) {
+      throw std::runtime_error("copy failed");
+    }
+  }
+  bool operator<(const Fragile& other) const noexcept {return value<other.value;}
+};
+
+BOOST_AUTO_TEST_CASE(top_down_insert_delete) {
+  BOOST_TEST_MESSAGE("Testing TopDownRBTree insert() and delete_() against std::set :");
+  TopDownRBTree<int> rbt;
+  std::set<int> expected;
+  unsigned int state{12345};
+  bool valid{true}, agree{true};
+  for (int i{0}; i<20000; ++i) {
+    state = state*1103515245u+12345u; // small LCG, reproducible
+    int key{int(state>>16)%500};
+    if ((state>>8) & 1) {
+      agree = agree and rbt.insert(key)==expected.insert(key).second;
+    } else {
+      agree = agree and rbt.delete_(key)==(expected.erase(key)==1);
+    }
+    if (i%1000==0) {
+      valid = valid and rbt.is_valid();
+    }
+  }
+  BOOST_CHECK_EQUAL(agree, true);
+  BOOST_CHECK_EQUAL(valid and rbt.is_valid(), true);
+  BOOST_CHECK_EQUAL(rbt.size(), expected.size());
+  BOOST_CHECK_EQUAL(std::vector<int>(rbt.begin(), rbt.end())==std::vector<int>(expected.begin(), expected.end()), true);
+  BOOST_CHECK_EQUAL(TopDownRBTree<int>::node_size<sizeof(_Node<int>), true); // no parent pointer
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(top_down_iterators_and_copies) {
+  BOOST_TEST_MESSAGE("Testing TopDownRBTree find(), path iterators and copies :");
+  TopDownRBTree<std::string> rbt;
+  for (int i{0}; i<100; ++i) {
+    rbt.insert(std::to_string(i));
+  }
+  auto it{rbt.find("42")};
+  BOOST_CHECK_EQUAL(*it, "42");
+  BOOST_CHECK_EQUAL(*++it, "43"); // the path stack resumes from the found node
+  BOOST_CHECK_EQUAL(rbt.find("100")==rbt.end(), true);
+  TopDownRBTree<std::string> copied{rbt};
+  rbt.delete_("42");
+  BOOST_CHECK_EQUAL(copied.contains("42"), true);
+  BOOST_CHECK_EQUAL(rbt.contains("42"), false);
+  BOOST_CHECK_EQUAL(copied.is_valid(), true);
+  TopDownRBTree<std::string> moved{std::move(copied)};
+  BOOST_CHECK_EQUAL(moved.size(), 100);
+  BOOST_CHECK_EQUAL(copied.empty(), true);
+  BOOST_CHECK_LE(moved.get_height(), 2*7); // 2*log2(n+1)
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(top_down_allocators) {
+  BOOST_TEST_MESSAGE("Testing TopDownRBTree copy and move assignment across pmr resources :");
+  typedef TopDownRBTree<int, std::less<int>, std::pmr::polymorphic_allocator<int>> PmrTree;
+  RBTree_allocators::counting_resource first, second;
+  {
+    PmrTree source{std::less<int>{}, &first}, target{std::less<int>{}, &second};
+    for (int i{0}; i<500; ++i) {
+      source.insert(i);
+      target.insert(-i);
+    }
+    target = source; // the copy is made from the target's resource
+    BOOST_CHECK_EQUAL(target.get_allocator().resource()==&second, true);
+    BOOST_CHECK_EQUAL(target.contains(499), true);
+    BOOST_CHECK_EQUAL(target.contains(-499), false);
+    PmrTree moved{std::less<int>{}, &second};
+    moved = std::move(source); // different resources: the keys are copied
+    BOOST_CHECK_EQUAL(moved.get_allocator().resource()==&second, true);
+    BOOST_CHECK_EQUAL(moved.size(), 500);
+    BOOST_CHECK_EQUAL(moved.is_valid(), true);
+  }
+  BOOST_CHECK_EQUAL(first.allocated, 0);
+  BOOST_CHECK_EQUAL(second.allocated, 0);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(top_down_insert_throwing) {
+  BOOST_TEST_MESSAGE("Testing TopDownRBTree after an insert() whose key copy throws :");
+  bool whole{true};
+  for (int n{1}; n<300; ++n) { // every shape of the right spine, with rotations at the top or not
+    TopDownRBTree<Fragile> rbt;
+    for (int i{0}; i<n; ++i) {
+      rbt.insert(Fragile{i});
+    }
+    Fragile::throw_on = n;
+    BOOST_CHECK_THROW(rbt.insert(Fragile{n}), std::runtime_error);
+    Fragile::throw_on = -1;
+    whole = whole and rbt.is_valid() and rbt.size()==std::size_t(n) and rbt.contains(Fragile{0}) and rbt.contains(Fragile{n-1});
+    rbt.insert(Fragile{n}); // the slot went back to the pool
+    whole = whole and rbt.is_valid() and rbt.contains(Fragile{n});
+  }
+  BOOST_CHECK_EQUAL(whole, true);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Counted_multiset)
+CountedMultiset<int> events{};
+
+BOOST_AUTO_TEST_CASE(counted_insert_erase) {
+  BOOST_TEST_MESSAGE("Testing CountedMultiset insert(), erase_one(), erase_all() and count() :");
+  for (int i{0}; i<100000; ++i) {
+    events.insert(i%10); // many repeats over few distinct keys
+  }
+  events.insert(42, 5);
+  BOOST_CHECK_EQUAL(events.distinct_size(), 11);
+  BOOST_CHECK_EQUAL(events.size(), 100005);
+  BOOST_CHECK_EQUAL(events.count(3), 10000);
+  BOOST_CHECK_EQUAL(events.count(11), 0);
+  BOOST_CHECK_EQUAL(events.erase_one(3), true);
+  BOOST_CHECK_EQUAL(events.count(3), 9999);
+  BOOST_CHECK_EQUAL(events.erase_one(11), false);
+  BOOST_CHECK_EQUAL(events.erase_all(42), 5);
+  BOOST_CHECK_EQUAL(events.contains(42), false);
+  events.insert(7, 0);
+  BOOST_CHECK_EQUAL(events.count(7), 10000);
+  for (int i{0}; i<10000; ++i) {
+    events.erase_one(9);
+  }
+  BOOST_CHECK_EQUAL(events.contains(9), false); // last occurrence removes the node
+  BOOST_CHECK_EQUAL(events.distinct_size(), 9);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(counted_rank_and_visits) {
+  BOOST_TEST_MESSAGE("Testing CountedMultiset rank(), for_each() and for_each_distinct() :");
+  BOOST_CHECK_EQUAL(events.rank(0), 0);
+  BOOST_CHECK_EQUAL(events.rank(4), 39999); // 0, 1, 2 ten thousand times, 3 once less
+  BOOST_CHECK_EQUAL(events.rank(100), events.size());
+  CountedMultiset<int> small;
+  for (int key : {5, 1, 5, 3, 5, 1}) {
+    small.insert(key);
+  }
+  std::vector<int> expanded, distinct, counts;
+  small.for_each([&expanded](int key) { expanded.push_back(key); });
+  small.for_each_distinct([&](int key, std::size_t count) {
+    distinct.push_back(key);
+    counts.push_back(int(count));
+    return key<3; // stops after 3
+  });
+  BOOST_CHECK_EQUAL(expanded==std::vector<int>({1, 1, 3, 5, 5, 5}), true);
+  BOOST_CHECK_EQUAL(distinct==std::vector<int>({1, 3}), true);
+  BOOST_CHECK_EQUAL(counts==std::vector<int>({2, 1}), true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(counted_stale_compaction) {
+  BOOST_TEST_MESSAGE("Testing that a count changed in place makes a prepared compaction stale :");
+  RBTree<Counted<int>, CountedOrder<int, std::less<int>>, OccurrenceAugmentation<int>> counted;
+  for (int key{0}; key<10; ++key) {
+    counted.insert(Counted<int>{key, 1});
+  }
+  auto prepared{counted.prepare_compaction()};
+  counted.modify(Counted<int>{3}, [](Counted<int>& entry) { entry.count = 101; });
+  BOOST_CHECK_EQUAL(counted.commit_compaction(std::move(prepared)), false); // the layout holds count 1
+  BOOST_CHECK_EQUAL(counted.find(Counted<int>{3}).count, 101);
+  BOOST_CHECK_EQUAL(counted.aggregate(), 110);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_extremes)
+RBTree<int> queue{};
+
+BOOST_AUTO_TEST_CASE(extremes_insert_pop) {
+  BOOST_TEST_MESSAGE("Testing RBTree min(), max(), pop_min() and pop_max() against std::set :");
+  BOOST_CHECK_EQUAL(queue.empty(), true);
+  BOOST_CHECK(queue.begin()==queue.end());
+  std::set<int> reference;
+  unsigned state{12345};
+  for (int i{0}; i<20000; ++i) {
+    state = state*1103515245u+12345u;
+    const int key{int((state>>8)%5000)};
+    if (state%4!=0 or reference.empty()) {
+      if (reference.insert(key).second) {
+        queue.insert(key);
+      }
+    } else if (state%8==0) {
+      BOOST_REQUIRE_EQUAL(queue.pop_min(), *reference.begin());
+      reference.erase(reference.begin());
+    } else if (reference.count(key)==1) { // deletes in the middle move the extremes too
+      queue.delete_(key);
+      reference.erase(key);
+    } else {
+      BOOST_REQUIRE_EQUAL(queue.pop_max(), *reference.rbegin());
+      reference.erase(std::prev(reference.end()));
+    }
+    if (!reference.empty()) {
+      BOOST_REQUIRE_EQUAL(queue.min(), *reference.begin());
+      BOOST_REQUIRE_EQUAL(queue.max(), *reference.rbegin());
+    }
+  }
+  BOOST_CHECK(std::equal(queue.begin(), queue.end(), reference.begin(), reference.end()));
+  while (!reference.empty()) {
+    BOOST_REQUIRE_EQUAL(queue.pop_max(), *reference.rbegin());
+    reference.erase(std::prev(reference.end()));
+  }
+  BOOST_CHECK_EQUAL(queue.empty(), true);
+  BOOST_CHECK(queue.begin()==queue.end());
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(extremes_bulk_changes) {
+  BOOST_TEST_MESSAGE("Testing RBTree extremes after bulk_load(), compact(), copies and moves :");
+  std::vector<int> keys{4, -3, 0, 9, 2};
+  queue.bulk_load(keys.begin(), keys.end());
+  BOOST_CHECK_EQUAL(queue.min(), -3);
+  BOOST_CHECK_EQUAL(queue.max(), 9);
+  queue.compact();
+  BOOST_CHECK_EQUAL(queue.pop_min(), -3);
+  RBTree<int> copied{queue};
+  BOOST_CHECK_EQUAL(copied.min(), 0);
+  BOOST_CHECK_EQUAL(copied.max(), 9);
+  RBTree<int> moved{std::move(copied)};
+  BOOST_CHECK_EQUAL(moved.pop_max(), 9);
+  BOOST_CHECK_EQUAL(copied.empty(), true);
+  std::vector<int> forward(moved.begin(), moved.end()), backward;
+  for (auto it{moved.rbegin()}; it!=moved.rend(); --it) { // key 0 is a key like any other
+    backward.push_back(*it);
+  }
+  BOOST_CHECK((forward==std::vector<int>{0, 2, 4}));
+  BOOST_CHECK((backward==std::vector<int>{4, 2, 0}));
+  BOOST_CHECK_EQUAL(*std::prev(moved.end()), 4); // end() steps back to the largest key
+  BOOST_CHECK_EQUAL(*std::prev(moved.end(), 3), 0);
+  BOOST_CHECK((std::vector<int>(std::make_reverse_iterator(moved.end()), std::make_reverse_iterator(moved.begin()))==std::vector<int>{4, 2, 0}));
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_diff)
+typedef RBTree<int, std::less<int>, DigestAugmentation<int>> DigestTree;
+
+///\brief Builds a version of [0, n) with a few changes: every step-th key removed, keys from n on added.
+template <class Tree>
+void fill_version(Tree& tree, const int n, const int step, const int extra) {
+  for (int i{0}; i<n; ++i) {
+    if (step==0 or i%step!=0) {
+      tree.insert(i);
+    }
+  }
+  for (int i{n}; i<n+extra; ++i) {
+    tree.insert(i);
+  }
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(diff_digest_and_merge) {
+  BOOST_TEST_MESSAGE("Testing diff() with subtree digests and by merge walk :");
+  DigestTree older, newer;
+  RBTree<int> plain_older, plain_newer;
+  fill_version(older, 10000, 0, 0);
+  fill_version(newer, 10000, 1000, 3); // 10 removed, 3 added
+  fill_version(plain_older, 10000, 0, 0);
+  fill_version(plain_newer, 10000, 1000, 3);
+  Delta<int> digested{diff(older, newer)}, merged{diff(plain_older, plain_newer)};
+  BOOST_CHECK((digested.removed==std::vector<int>{0, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000}));
+  BOOST_CHECK((digested.added==std::vector<int>{10000, 10001, 10002}));
+  BOOST_CHECK(digested.removed==merged.removed);
+  BOOST_CHECK(digested.added==merged.added);
+  BOOST_CHECK_EQUAL(diff(older, older).empty(), true);
+  DigestTree empty;
+  BOOST_CHECK_EQUAL(diff(empty, newer).added.size(), newer.aggregate().count);
+  BOOST_CHECK_EQUAL(diff(newer, empty).removed.size(), newer.aggregate().count);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(apply_delta_sync) {
+  BOOST_TEST_MESSAGE("Testing apply_delta() on a replica, by inserts and by bulk_load :");
+  DigestTree primary, replica;
+  fill_version(primary, 5000, 0, 0);
+  fill_version(replica, 5000, 0, 0);
+  primary.delete_(42);
+  primary.insert(-7);
+  Delta<int> small{diff(replica, primary)};
+  BOOST_CHECK_EQUAL(small.size(), 2);
+  replica.apply_delta(small);
+  BOOST_CHECK_EQUAL(diff(replica, primary).empty(), true);
+  BOOST_CHECK(std::equal(replica.begin(), replica.end(), primary.begin(), primary.end()));
+  for (int i{5000}; i<9000; ++i) { // many additions: merged by bulk_load
+    primary.insert(i);
+  }
+  replica.apply_delta(diff(replica, primary));
+  BOOST_CHECK_EQUAL(diff(replica, primary).empty(), true);
+  BOOST_CHECK_EQUAL(replica.aggregate().count, primary.aggregate().count);
+  BOOST_CHECK_EQUAL(replica.min(), -7);
+  BOOST_CHECK_EQUAL(replica.max(), 8999);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Static_set)
+constexpr auto codes{make_static_set<int>({503, 200, 404, 0, 301, 200, 500, -1})};
+static_assert(codes.size()==7, "duplicates are dropped at compile time");
+static_assert(codes.contains(404) and !codes.contains(403), "queries are constant expressions");
+static_assert(*codes.lower_bound(402)==404 and codes.lower_bound(600)==codes.end(), "lower_bound at compile time");
+static_assert(codes.min()==-1 and codes.max()==503, "extremes at compile time");
+
+BOOST_AUTO_TEST_CASE(static_set_queries) {
+  BOOST_TEST_MESSAGE("Testing StaticSet contains(), find(), lower_bound() and iteration against RBTree :");
+  RBTree<int> loaded;
+  for (int code : {503, 200, 404, 0, 301, 200, 500, -1}) {
+    loaded.insert(code);
+  }
+  BOOST_CHECK(std::equal(codes.begin(), codes.end(), loaded.begin(), loaded.end()));
+  for (int probe{-3}; probe<510; ++probe) {
+    BOOST_REQUIRE_EQUAL(codes.contains(probe), loaded.contains(probe));
+    BOOST_REQUIRE_EQUAL(codes.find(probe), loaded.find(probe));
+    BOOST_REQUIRE_EQUAL(codes.lower_bound(probe)==codes.end(), loaded.lower_bound(probe)==loaded.end());
+    if (codes.lower_bound(probe)!=codes.end()) {
+      BOOST_REQUIRE_EQUAL(*codes.lower_bound(probe), *loaded.lower_bound(probe));
+    }
+  }
+  constexpr auto keywords{make_static_set<std::string_view>({"while", "for", "if", "else", "do"})};
+  BOOST_CHECK_EQUAL(keywords.contains("if"), true);
+  BOOST_CHECK_EQUAL(keywords.contains("iff"), false);
+  BOOST_CHECK_EQUAL(*keywords.begin(), "do");
+  constexpr auto descending{make_static_set<int>({1, 3, 2}, std::greater<int>{})};
+  BOOST_CHECK((std::vector<int>(descending.begin(), descending.end())==std::vector<int>{3, 2, 1}));
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Merged_view)
+
+BOOST_AUTO_TEST_CASE(merged_view_streams) {
+  BOOST_TEST_MESSAGE("Testing merged_view() with and without duplicates, and from a lower_bound :");
+  RBTree<int> even, odd, thirds, empty;
+  std::vector<int> expected;
+  for (int i{0}; i<300; ++i) {
+    (i%2==0 ? even : odd).insert(i);
+    expected.push_back(i);
+    if (i%3==0) {
+      thirds.insert(i);
+      expected.push_back(i);
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+  std::vector<int> merged;
+  for (int key : merged_view(even, empty, odd, thirds)) {
+    merged.push_back(key);
+  }
+  BOOST_CHECK(merged==expected);
+  auto distinct{merged_view(SKIP_DUPLICATES, thirds, odd, even)};
+  std::vector<int> unique(distinct.begin(), distinct.end());
+  expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+  BOOST_CHECK(unique==expected);
+  BOOST_CHECK_EQUAL(distinct.done(), true);
+  BOOST_CHECK_EQUAL(*distinct.lower_bound(100), 100); // restarts the walk
+  distinct.advance();
+  BOOST_CHECK_EQUAL(distinct.front(), 101);
+  BOOST_CHECK(distinct.lower_bound(300)==distinct.end());
+  MergedView<RBTree<int>> none{std::vector<const RBTree<int>*>{}};
+  BOOST_CHECK(none.begin()==none.end());
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Bloom_filter)
+FilteredTree<int> filtered{};
+
+BOOST_AUTO_TEST_CASE(bloom_filter_no_false_negatives) {
+  BOOST_TEST_MESSAGE("Testing BlockedBloomFilter may_contain() and its false positive rate :");
+  BlockedBloomFilter<int> bloom{10000};
+  for (int i{0}; i<10000; ++i) {
+    bloom.add(2*i);
+  }
+  int missing{0}, positives{0};
+  for (int i{0}; i<10000; ++i) {
+    missing += !bloom.may_contain(2*i);
+    positives += bloom.may_contain(2*i+1);
+  }
+  BOOST_CHECK_EQUAL(missing, 0);
+  BOOST_CHECK_LT(positives, 200); // about 0.5% expected at 16 bits per key
+  BOOST_CHECK_EQUAL(bloom.memory(), bloom.capacity()*BlockedBloomFilter<int>::bits_per_key/8);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(filtered_tree_churn) {
+  BOOST_TEST_MESSAGE("Testing FilteredTree insert(), delete_(), contains() and rebuilds against std::set :");
+  std::set<int> reference;
+  unsigned state{777};
+  bool agree{true};
+  for (int i{0}; i<50000; ++i) {
+    state = state*1103515245u+12345u;
+    const int key{int((state>>8)%20000)};
+    if (state%3!=0) {
+      filtered.insert(key);
+      reference.insert(key);
+    } else if (reference.erase(key)==1) {
+      filtered.delete_(key);
+    }
+    agree = agree and filtered.contains(key)==(reference.count(key)==1);
+  }
+  BOOST_CHECK_EQUAL(agree, true);
+  BOOST_CHECK_EQUAL(filtered.size(), reference.size());
+  BOOST_CHECK(std::equal(filtered.get_tree().begin(), filtered.get_tree().end(), reference.begin(), reference.end()));
+  for (int key{0}; key<20000; ++key) {
+    agree = agree and filtered.contains(key)==(reference.count(key)==1);
+  }
+  BOOST_CHECK_EQUAL(agree, true);
+  BOOST_CHECK_EQUAL(filtered.find(20001), 0); // definite miss: NIL's key
+  BOOST_CHECK_GE(filtered.filter_memory()*8, filtered.size()*BlockedBloomFilter<int>::bits_per_key);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Hashed_tree)
+HashedTree<int> hashed{};
+
+BOOST_AUTO_TEST_CASE(hashed_tree_churn) {
+  BOOST_TEST_MESSAGE("Testing HashedTree insert(), delete_(), contains() and find() against std::set :");
+  std::set<int> reference;
+  unsigned state{4242};
+  bool agree{true};
+  for (int i{0}; i<60000; ++i) {
+    state = state*1103515245u+12345u;
+    const int key{int((state>>8)%30000)};
+    if (state%3!=0) {
+      hashed.insert(key);
+      reference.insert(key);
+    } else if (reference.erase(key)==1) {
+      hashed.delete_(key);
+    }
+    agree = agree and hashed.contains(key)==(reference.count(key)==1);
+  }
+  for (int key{0}; key<30000; ++key) {
+    agree = agree and hashed.contains(key)==(reference.count(key)==1);
+    agree = agree and (reference.count(key)==0 or hashed.find(key)==key);
+  }
+  BOOST_CHECK_EQUAL(agree, true);
+  BOOST_CHECK_EQUAL(hashed.size(), reference.size());
+  BOOST_CHECK(std::equal(hashed.get_tree().begin(), hashed.get_tree().end(), reference.begin(), reference.end()));
+  BOOST_CHECK_EQUAL(*hashed.lower_bound(15000), *reference.lower_bound(15000));
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(hashed_tree_relocation) {
+  BOOST_TEST_MESSAGE("Testing HashedTree consistency after compact() and bulk_load() :");
+  hashed.compact(VAN_EMDE_BOAS); // every node moves
+  bool agree{true};
+  hashed.get_tree().visit_inorder([&agree](const int& key) { agree = agree and &hashed.find(key)==&key; });
+  BOOST_CHECK_EQUAL(agree, true);
+  std::vector<int> more{-1, -2, -3};
+  const std::size_t before{hashed.size()};
+  hashed.bulk_load(more.begin(), more.end());
+  BOOST_CHECK_EQUAL(hashed.size(), before+3);
+  hashed.get_tree().visit_inorder([&agree](const int& key) { agree = agree and &hashed.find(key)==&key; });
+  BOOST_CHECK_EQUAL(agree, true);
+  hashed.delete_(-2);
+  BOOST_CHECK_EQUAL(hashed.contains(-2), false);
+  BOOST_CHECK_EQUAL(hashed.contains(-3), true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(hashed_tree_copies) {
+  BOOST_TEST_MESSAGE("Testing HashedTree copies and moves: each index points to its own nodes :");
+  HashedTree<int> source;
+  for (int key{0}; key<100; ++key) {
+    source.insert(key);
+  }
+  HashedTree<int> copied{source};
+  source.delete_(5);
+  BOOST_CHECK_EQUAL(copied.contains(5), true);
+  BOOST_CHECK_EQUAL(copied.get_tree().contains(5), true);
+  bool agree{true};
+  copied.get_tree().visit_inorder([&](const int& key) { agree = agree and &copied.find(key)==&key; });
+  BOOST_CHECK_EQUAL(agree, true);
+  HashedTree<int> assigned;
+  assigned.insert(-1);
+  assigned = copied;
+  copied.delete_(7);
+  {
+    HashedTree<int> dropped{source};
+    assigned = dropped; // the copy outlives the source
+  }
+  BOOST_CHECK_EQUAL(assigned.contains(5), false);
+  BOOST_CHECK_EQUAL(assigned.contains(7), true);
+  BOOST_CHECK_EQUAL(assigned.contains(-1), false);
+  assigned.get_tree().visit_inorder([&](const int& key) { agree = agree and &assigned.find(key)==&key; });
+  BOOST_CHECK_EQUAL(agree, true);
+  HashedTree<int> moved{std::move(assigned)};
+  BOOST_CHECK_EQUAL(moved.size(), 99);
+  BOOST_CHECK_EQUAL(moved.contains(42), true);
+  BOOST_CHECK_EQUAL(assigned.size(), 0);
+  BOOST_CHECK_EQUAL(assigned.contains(42), false); // the moved tree is left empty
+  assigned.insert(42);                             // and usable
+  BOOST_CHECK_EQUAL(assigned.contains(42), true);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_compress)
+
+BOOST_AUTO_TEST_CASE(compressed_snapshot_queries) {
+  BOOST_TEST_MESSAGE("Testing RBTree compress(): contains(), lower_bound() and iteration of the snapshot :");
+  RBTree<long long> cold;
+  std::set<long long> reference;
+  unsigned state{99};
+  for (int i{0}; i<5000; ++i) {
+    state = state*1103515245u+12345u;
+    long long key{(state%8==0) ? (long long)(state)<<30 : (long long)(state%100000)-50000}; // dense and huge gaps
+    cold.insert(key);
+    reference.insert(key);
+  }
+  cold.insert(std::numeric_limits<long long>::min());
+  reference.insert(std::numeric_limits<long long>::min());
+  CompressedSnapshot<long long> snapshot{cold.compress()};
+  BOOST_CHECK_EQUAL(snapshot.size(), reference.size());
+  BOOST_CHECK(std::equal(snapshot.begin(), snapshot.end(), reference.begin(), reference.end()));
+  bool agree{true};
+  for (long long probe{-50010}; probe<50010; ++probe) {
+    auto bound{reference.lower_bound(probe)};
+    auto found{snapshot.lower_bound(probe)};
+    agree = agree and snapshot.contains(probe)==(reference.count(probe)==1);
+    agree = agree and ((bound==reference.end())==(found==snapshot.end())) and (found==snapshot.end() or *found==*bound);
+  }
+  BOOST_CHECK_EQUAL(agree, true);
+  BOOST_CHECK_EQUAL(snapshot.contains(std::numeric_limits<long long>::min()), true);
+  BOOST_CHECK_LT(snapshot.memory(), reference.size()*sizeof(long long)); // below even a flat array
+  RBTree<unsigned> empty;
+  BOOST_CHECK_EQUAL(empty.compress().empty(), true);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_mapped)
+BOOST_AUTO_TEST_CASE(persistence) {
+  BOOST_TEST_MESSAGE("Testing MappedRBTree insert(), delete_() and reopening against std::set :");
+  const std::string path{(std::filesystem::temp_directory_path()/"rbt_mapped_test.rbt").string()};
+  MappedRBTree<int>::remove(path);
+  std::set<int> reference;
+  std::size_t grown{0};
+  {
+    MappedRBTree<int> rbt{path};
+    BOOST_CHECK_EQUAL(rbt.empty(), true);
+    for (int i{0}; i<20000; ++i) {
+      const int key{int((i*7919L)%10007)};
+      BOOST_CHECK_EQUAL(rbt.insert(key), reference.insert(key).second);
+    }
+    grown = rbt.memory();
+    BOOST_CHECK_GT(grown, MappedRBTree<int>::initial_bytes); // the file doubled on the way
+    rbt.sync();
+  }
+  MappedRBTree<int> reopened{path}; // no rebuild: the nodes are where they were left
+  BOOST_CHECK_EQUAL(reopened.size(), reference.size());
+  BOOST_CHECK_EQUAL(reopened.is_valid(), true);
+  BOOST_CHECK_EQUAL(std::equal(reopened.begin(), reopened.end(), reference.begin(), reference.end()), true);
+  for (int key{0}; key<10007; key+=2) {
+    BOOST_CHECK_EQUAL(reopened.delete_(key), reference.erase(key)==1);
+  }
+  BOOST_CHECK_EQUAL(reopened.delete_(-1), false);
+  for (int key{0}; key<10007; key+=4) { // freed slots are reused: the file does not grow
+    reopened.insert(key);
+    reference.insert(key);
+  }
+  BOOST_CHECK_EQUAL(reopened.memory(), grown);
+  BOOST_CHECK_EQUAL(reopened.is_valid(), true);
+  BOOST_CHECK_EQUAL(std::equal(reopened.begin(), reopened.end(), reference.begin(), reference.end()), true);
+  BOOST_CHECK_EQUAL(*reopened.find(4), 4);
+  BOOST_CHECK_EQUAL(reopened.find(6)==reopened.end(), true);
+  BOOST_CHECK_THROW(MappedRBTree<double>{path}, std::runtime_error); // nodes of another size
+  BOOST_CHECK_EQUAL(MappedRBTree<int>::remove(path), true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(shared_memory) {
+  BOOST_TEST_MESSAGE("Testing MappedRBTree in a shared memory segment, mapped twice :");
+  const std::string name{"/rbt_mapped_test"};
+  MappedRBTree<long>::remove(name, SHARED_MEMORY);
+  MappedRBTree<long> writer{name, SHARED_MEMORY};
+  MappedRBTree<long> reader{name, SHARED_MEMORY}; // another mapping, as another process would have
+  writer.insert(42);
+  BOOST_CHECK_EQUAL(reader.contains(42), true);
+  for (long key{0}; key<10000; ++key) { // the writer grows the segment: the reader follows
+    writer.insert(key*3);
+  }
+  BOOST_CHECK_EQUAL(reader.size(), 10000);
+  BOOST_CHECK_EQUAL(reader.contains(29997), true);
+  BOOST_CHECK_EQUAL(reader.contains(29998), false);
+  BOOST_CHECK_EQUAL(reader.is_valid(), true);
+  BOOST_CHECK_EQUAL(MappedRBTree<long>::remove(name, SHARED_MEMORY), true);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Adaptive_tree)
+BOOST_AUTO_TEST_CASE(lookups_and_updates) {
+  BOOST_TEST_MESSAGE("Testing AdaptiveTree lookups across updates and automatic rebuilds against std::set :");
+  AdaptiveTree<int> rbt{64}; // rebuilt every max(64, n) lookups
+  std::set<int> reference;
+  bool agree{true};
+  for (int i{0}; i<3000; ++i) {
+    const int key{int((i*7919L)%1009)};
+    if (i%3==2) {
+      if (reference.erase(key)==1) {
+        rbt.delete_(key);
+      }
+    } else {
+      rbt.insert(key);
+      reference.insert(key);
+    }
+    const int probe{int((i*104729L)%1013)};
+    agree = agree and rbt.contains(probe)==(reference.count(probe)==1);
+    agree = agree and (reference.count(probe)==0 or rbt.find(probe)==probe);
+  }
+  BOOST_CHECK_EQUAL(agree, true);
+  BOOST_CHECK_EQUAL(rbt.size(), reference.size());
+  BOOST_CHECK_EQUAL(rbt.is_adapted(), false); // an update came after the last rebuild
+  for (std::size_t i{0}; i<reference.size(); ++i) {
+    rbt.contains(-1);
+  }
+  BOOST_CHECK_EQUAL(rbt.is_adapted(), true);
+  for (int probe{-5}; probe<1015; ++probe) {
+    agree = agree and rbt.contains(probe)==(reference.count(probe)==1);
+  }
+  BOOST_CHECK_EQUAL(agree, true);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(depths) {
+  BOOST_TEST_MESSAGE("Testing AdaptiveTree rebuild(): hot keys rise, the height stays bounded :");
+  AdaptiveTree<int> rbt{1<<30}; // rebuilt on demand only
+  for (int key{0}; key<1023; ++key) {
+    rbt.insert(key);
+  }
+  rbt.rebuild(); // no access yet: balanced
+  BOOST_CHECK_EQUAL(rbt.depth(511), 0);
+  const std::size_t balanced{rbt.depth(7)};
+  for (int i{0}; i<1000000; ++i) {
+    rbt.contains(i%10==0 ? 7 : 900);
+  }
+  rbt.rebuild();
+  BOOST_CHECK_EQUAL(rbt.depth(900), 0);
+  BOOST_CHECK_LT(rbt.depth(7), balanced);
+  BOOST_CHECK_LE(rbt.depth(7), 4); // 10% of the accesses: log2(1/0.1)+1 levels at most
+  std::size_t height{0};
+  for (int key{0}; key<1023; ++key) {
+    height = std::max(height, rbt.depth(key));
+  }
+  BOOST_CHECK_LE(height, 11); // ceil(log2(n))+1
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Small_tree)
+BOOST_AUTO_TEST_CASE(promotion_and_demotion) {
+  BOOST_TEST_MESSAGE("Testing SmallTree against std::set, across promotions and demotions :");
+  SmallTree<int, 8> rbt;
+  std::set<int> reference;
+  bool agree{true}, promoted{false}, demoted{false};
+  for (int i{0}; i<2000; ++i) {
+    const int key{int((i*7919L)%23)};
+    if (i%400<200) { // grows past 8 keys, then shrinks below 4
+      rbt.insert(key);
+      reference.insert(key);
+    } else if (reference.erase(key)==1) {
+      rbt.delete_(key);
+    }
+    promoted = promoted or !rbt.is_small();
+    demoted = demoted or (promoted and rbt.is_small());
+    agree = agree and rbt.size()==reference.size() and (rbt.size()<=8 or !rbt.is_small());
+    agree = agree and std::equal(rbt.begin(), rbt.end(), reference.begin(), reference.end());
+    const int probe{int((i*104729L)%25)};
+    const auto bound = reference.lower_bound(probe);
+    const auto found = rbt.lower_bound(probe);
+    agree = agree and rbt.contains(probe)==(reference.count(probe)==1);
+    agree = agree and ((bound==reference.end())==(found==rbt.end())) and (found==rbt.end() or *found==*bound);
+  }
+  BOOST_CHECK_EQUAL(agree, true);
+  BOOST_CHECK_EQUAL(promoted, true);
+  BOOST_CHECK_EQUAL(demoted, true);
+  for (int key{100}; key<120; ++key) {
+    rbt.insert(key);
+  }
+  BOOST_CHECK_EQUAL(rbt.is_small(), false);
+  BOOST_CHECK_EQUAL(*std::prev(rbt.end()), 119); // promoted: end() steps back as in the array
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(small_mode) {
+  BOOST_TEST_MESSAGE("Testing SmallTree find(), min(), max(), iterators and copies while small :");
+  SmallTree<std::string> rbt;
+  for (const char* word : {"pear", "apple", "fig", "plum", "apple"}) {
+    rbt.insert(word);
+  }
+  BOOST_CHECK_EQUAL(rbt.size(), 4);
+  BOOST_CHECK_EQUAL(rbt.is_small(), true);
+  BOOST_CHECK_EQUAL(rbt.min(), "apple");
+  BOOST_CHECK_EQUAL(rbt.max(), "plum");
+  BOOST_CHECK_EQUAL(rbt.find("fig"), "fig");
+  BOOST_CHECK_EQUAL(rbt.find("kiwi"), "");
+  BOOST_CHECK_EQUAL(*--rbt.end(), "plum");
+  SmallTree<std::string> copied{rbt};
+  copied.delete_("apple");
+  BOOST_CHECK_EQUAL(rbt.contains("apple"), true);
+  BOOST_CHECK_EQUAL(copied.contains("apple"), false);
+  SmallTree<std::string> moved{std::move(copied)};
+  BOOST_CHECK_EQUAL(moved.size(), 3);
+  BOOST_CHECK_EQUAL(copied.empty(), true);
+  BOOST_CHECK_LE(sizeof(SmallTree<int>), 16*sizeof(int)+2*sizeof(void*)+sizeof(std::size_t)); // no allocation while small
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(RBTree_key_of)
+struct Account {
+  int id;
+  std::string owner;
+  static inline int built{0}; ///< accounts built by default or copy, lookups must add none.
+  Account(): id{0} {++built;}
+  Account(int number, std::string name): id{number}, owner{std::move(name)} {}
+  Account(const Account& other): id{other.id}, owner{other.owner} {++built;}
+  Account& operator=(const Account&) = default;
+};
+
+BOOST_AUTO_TEST_CASE(records_by_key) {
+  BOOST_TEST_MESSAGE("Testing KeyedRBTree: records ordered and searched by a field :");
+  KeyedRBTree<Account, KeyMember<&Account::id>> accounts;
+  for (int id : {42, 7, 19, 3, 88}) {
+    accounts.insert(Account{id, "owner" + std::to_string(id)});
+  }
+  accounts.insert(Account{7, "someone else"}); // same key: not stored
+  const int built{Account::built};
+  BOOST_CHECK_EQUAL(accounts.contains(19), true);
+  BOOST_CHECK_EQUAL(accounts.contains(20), false);
+  BOOST_CHECK_EQUAL(accounts.find(7).owner, "owner7");
+  BOOST_CHECK_EQUAL(accounts.lower_bound(20)->id, 42);
+  BOOST_CHECK_EQUAL(accounts.lower_bound(89)==accounts.end(), true);
+  accounts.delete_(42);
+  accounts.delete_(43); // absent, and an int is printed
+  BOOST_CHECK_EQUAL(Account::built, built); // no record built by the lookups
+  std::vector<int> ids;
+  for (const Account& account : accounts) {
+    ids.push_back(account.id);
+  }
+  BOOST_CHECK_EQUAL(ids==std::vector<int>({3, 7, 19, 88}), true);
+  accounts.delete_(accounts.find(3)); // by record as well
+  BOOST_CHECK_EQUAL(accounts.min().id, 7);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(transparent_comparators) {
+  BOOST_TEST_MESSAGE("Testing heterogeneous lookups with std::less<> and std::greater<> :");
+  RBTree<std::string, std::less<>> words;
+  for (const char* word : {"pear", "apple", "fig"}) {
+    words.insert(word);
+  }
+  BOOST_CHECK_EQUAL(words.contains("fig"), true); // compared as a const char*, no std::string built
+  BOOST_CHECK_EQUAL(words.find(std::string_view{"pear"}), "pear");
+  BOOST_CHECK_EQUAL(*words.lower_bound("b"), "fig");
+  KeyedRBTree<Account, KeyMember<&Account::id>, std::greater<>> descending;
+  for (int id : {1, 2, 3}) {
+    descending.insert(Account{id, ""});
+  }
+  BOOST_CHECK_EQUAL(descending.begin()->id, 3);
+  BOOST_CHECK_EQUAL(descending.lower_bound(2)->id, 2);
+}
+//--------------------------------------
+BOOST_AUTO_TEST_CASE(wrappers_of_records) {
+  BOOST_TEST_MESSAGE("Testing the wrappers' delete_ on records without operator<< :");
+  struct ById {
+    bool operator()(const Account& a, const Account& b) const noexcept {return a.id<b.id;}
+  };
+  struct HashId {
+    std::size_t operator()(const Account& account) const noexcept {return std::hash<int>{}(account.id);}
+  };
+  FilteredTree<Account, ById, HashId> filtered;
+  HashedTree<Account, ById, HashId> hashed;
+  AdaptiveTree<Account, ById> adaptive;
+  SmallTree<Account, 4, ById> small;
+  for (int id : {5, 1, 3}) {
+    filtered.insert(Account{id, ""});
+    hashed.insert(Account{id, ""});
+    adaptive.insert(Account{id, ""});
+    small.insert(Account{id, ""});
+  }
+  const Account absent{2, ""};
+  filtered.delete_(absent); // absent, nothing printed
+  hashed.delete_(absent);
+  adaptive.delete_(absent);
+  small.delete_(absent);
+  BOOST_CHECK_EQUAL(hashed.size(), 3);
+  BOOST_CHECK_EQUAL(small.contains(Account{3, ""}), true);
+  filtered.delete_(Account{3, ""});
+  BOOST_CHECK_EQUAL(filtered.contains(Account{3, ""}), false);
+}
+//--------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+//----------------------------------------------------------------
+
 
 
 /*/ ----------------------------------------boost assertions list: